@@ -0,0 +1,63 @@
+// MAC verifications per second for signers answering one round after
+// another, as the merger sees them: an HmacContext kept per signer against
+// Hmac::verifyHMAC(), which derives the key for every message.
+//
+//   hmac_verify [num_signers] [num_rounds] [msg_size]
+
+#include "../src/utils/hmac.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+int main(int argc, char *argv[]) {
+  const size_t num_signers =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+  const size_t num_rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 500;
+  const size_t msg_size = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 256;
+
+  std::vector<std::vector<uint8_t>> keys;
+  std::vector<std::unique_ptr<HmacContext>> hmac_contexts;
+  std::vector<std::string> msgs;
+  std::vector<std::vector<uint8_t>> hmacs;
+  for (size_t i = 0; i < num_signers; ++i) {
+    keys.emplace_back(32, static_cast<uint8_t>(i));
+    hmac_contexts.emplace_back(new HmacContext(keys.back()));
+    msgs.emplace_back(msg_size, static_cast<char>('a' + i % 26));
+    hmacs.emplace_back(Hmac::generateHMAC(msgs.back(), keys.back()));
+  }
+
+  auto perSecond = [](size_t num_verified, std::chrono::microseconds us) {
+    return us.count() > 0 ? num_verified * 1000000 / us.count() : num_verified;
+  };
+  const size_t num_total = num_signers * num_rounds;
+
+  size_t num_valid = 0;
+  auto start_time = std::chrono::steady_clock::now();
+  for (size_t round = 0; round < num_rounds; ++round) {
+    for (size_t i = 0; i < num_signers; ++i)
+      num_valid += hmac_contexts[i]->verify(
+          reinterpret_cast<const uint8_t *>(msgs[i].data()), msgs[i].size(),
+          hmacs[i]);
+  }
+  auto context_us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start_time);
+
+  start_time = std::chrono::steady_clock::now();
+  for (size_t round = 0; round < num_rounds; ++round) {
+    for (size_t i = 0; i < num_signers; ++i)
+      num_valid += Hmac::verifyHMAC(msgs[i], hmacs[i], keys[i]);
+  }
+  auto derive_us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start_time);
+
+  std::cout << num_total << " MACs of " << msg_size << " bytes from "
+            << num_signers << " signers: HmacContext "
+            << perSecond(num_total, context_us) << " /s, verifyHMAC "
+            << perSecond(num_total, derive_us) << " /s" << std::endl;
+
+  return num_valid == 2 * num_total ? 0 : 1;
+}
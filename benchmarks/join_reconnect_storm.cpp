@@ -0,0 +1,195 @@
+// A crowd of signers rejoining a SignerPoolManager at once, as after a
+// merger restart. Every signer sends MSG_JOIN, answers its challenge with a
+// signed MSG_RESPONSE_1 and, once the merger's MSG_RESPONSE_2 is back,
+// MSG_SUCCESS. The responses all go to the join workers together; a join
+// counts as finished when its MSG_ACCEPT comes within JOIN_TIMEOUT_SEC of
+// its MSG_JOIN. The merger signs with the key of the setting file.
+//
+//   join_reconnect_storm [num_signers] [setting_file]
+
+#include "../src/config/config.hpp"
+#include "../src/services/output_queue.hpp"
+#include "../src/services/setting.hpp"
+#include "../src/services/signer_pool.hpp"
+#include "../src/services/signer_pool_manager.hpp"
+#include "../src/utils/bytes_builder.hpp"
+#include "../src/utils/ecdsa.hpp"
+#include "../src/utils/file_io.hpp"
+#include "../src/utils/hmac_key_maker.hpp"
+#include "../src/utils/random_number_generator.hpp"
+#include "../src/utils/time.hpp"
+#include "../src/utils/type_converter.hpp"
+
+#include <botan-2/botan/auto_rng.h>
+#include <botan-2/botan/ec_group.h>
+#include <botan-2/botan/ecdsa.h>
+#include <botan-2/botan/x509self.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace gruut;
+
+namespace {
+struct StormSigner {
+  signer_id_type id;
+  std::string id_b64;
+  HmacKeyMaker key_maker;
+  std::chrono::steady_clock::time_point join_time;
+};
+
+bool loadSetting(const std::string &setting_file) {
+  std::string setting_json_str = FileIo::file2str(setting_file);
+  if (setting_json_str.empty())
+    return false;
+
+  try {
+    json setting_json = json::parse(setting_json_str);
+    setting_json["pass"] = "";
+    return Setting::getInstance()->setJson(setting_json);
+  } catch (json::exception &e) {
+    return false;
+  }
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const size_t num_signers =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : config::MAX_SIGNER_NUM;
+  const std::string setting_file = argc > 2 ? argv[2] : "./setting.json";
+
+  if (!loadSetting(setting_file)) {
+    std::cerr << "Failed to load setting file " << setting_file << std::endl;
+    return 1;
+  }
+
+  // the signers share one certificate; the merger only checks that each
+  // response is signed by the key of the certificate that comes with it
+  Botan::AutoSeeded_RNG rng;
+  Botan::ECDSA_PrivateKey signer_sk(rng, Botan::EC_Group("secp256r1"));
+  std::string signer_cert = Botan::X509::create_self_signed_cert(
+                                Botan::X509_Cert_Options("storm_signer"),
+                                signer_sk, "SHA-256", rng)
+                                .PEM_encode();
+
+  std::vector<StormSigner> signers(num_signers);
+  std::unordered_map<std::string, size_t> signer_index;
+  for (size_t i = 0; i < num_signers; ++i) {
+    signers[i].id = TypeConverter::integerToBytes<uint64_t>(i + 1);
+    signers[i].id_b64 = TypeConverter::encodeBase64(signers[i].id);
+    signers[i].key_maker.genRandomSecretKey();
+    signer_index[signers[i].id_b64] = i;
+  }
+
+  SignerPoolManager signer_pool_manager;
+  auto output_queue = OutputQueueAlt::getInstance();
+  output_queue->clearOutputQueue();
+
+  for (auto &signer : signers) {
+    InputMsgEntry join_msg;
+    join_msg.type = MessageType::MSG_JOIN;
+    join_msg.body["sID"] = signer.id_b64;
+    join_msg.body["time"] = Time::now();
+    signer.join_time = std::chrono::steady_clock::now();
+    signer_pool_manager.handleMessage(join_msg);
+  }
+
+  // what the signers work out on their own hosts before they answer
+  std::vector<InputMsgEntry> response_msgs;
+  while (!output_queue->empty()) {
+    OutputMsgEntry challenge_msg = output_queue->fetch();
+    if (challenge_msg.type != MessageType::MSG_CHALLENGE)
+      continue;
+
+    auto &signer = signers[signer_index[TypeConverter::encodeBase64(
+        challenge_msg.receivers[0])]];
+    auto signer_pk = signer.key_maker.getPublicKey();
+    std::string signer_nonce = PRNG::toString(PRNG::randomize(32));
+    std::string response_time = Time::now();
+
+    BytesBuilder msg_builder;
+    msg_builder.appendB64(challenge_msg.body["mN"].get<std::string>());
+    msg_builder.appendB64(signer_nonce);
+    msg_builder.appendHex(signer_pk.first);
+    msg_builder.appendHex(signer_pk.second);
+    msg_builder.appendDec(response_time);
+
+    InputMsgEntry response_msg;
+    response_msg.type = MessageType::MSG_RESPONSE_1;
+    response_msg.body["sID"] = signer.id_b64;
+    response_msg.body["time"] = response_time;
+    response_msg.body["cert"] = signer_cert;
+    response_msg.body["sN"] = signer_nonce;
+    response_msg.body["dhx"] = signer_pk.first;
+    response_msg.body["dhy"] = signer_pk.second;
+    response_msg.body["sig"] = TypeConverter::encodeBase64(
+        ECDSA::doSign(signer_sk, msg_builder.getBytes()));
+    response_msgs.emplace_back(std::move(response_msg));
+  }
+
+  auto storm_time = std::chrono::steady_clock::now();
+  for (auto &response_msg : response_msgs)
+    signer_pool_manager.handleMessage(response_msg);
+
+  // every join ends in MSG_ACCEPT or MSG_ERROR, or expires past the timeout
+  const auto deadline =
+      storm_time + std::chrono::seconds(2 * config::JOIN_TIMEOUT_SEC);
+  size_t num_ended = num_signers - response_msgs.size();
+  size_t num_finished = 0;
+  size_t num_late = 0;
+  std::chrono::milliseconds last_accept_ms{0};
+  while (num_ended < num_signers &&
+         std::chrono::steady_clock::now() < deadline) {
+    OutputMsgEntry output_msg = output_queue->fetch();
+    if (output_msg.type == MessageType::MSG_NULL) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+
+    auto &signer = signers[signer_index[TypeConverter::encodeBase64(
+        output_msg.receivers[0])]];
+    switch (output_msg.type) {
+    case MessageType::MSG_RESPONSE_2: {
+      InputMsgEntry success_msg;
+      success_msg.type = MessageType::MSG_SUCCESS;
+      success_msg.body["sID"] = signer.id_b64;
+      success_msg.body["time"] = Time::now();
+      success_msg.body["val"] = true;
+      signer_pool_manager.handleMessage(success_msg);
+    } break;
+    case MessageType::MSG_ACCEPT: {
+      auto now = std::chrono::steady_clock::now();
+      if (now - signer.join_time <=
+          std::chrono::seconds(config::JOIN_TIMEOUT_SEC)) {
+        ++num_finished;
+      } else {
+        ++num_late;
+      }
+      last_accept_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+          now - storm_time);
+      ++num_ended;
+    } break;
+    case MessageType::MSG_ERROR: {
+      ++num_ended;
+    } break;
+    default:
+      break;
+    }
+  }
+
+  std::cout << num_signers << " signers, " << config::NUM_JOIN_WORKERS
+            << " join workers: " << num_finished << " joins finished within "
+            << config::JOIN_TIMEOUT_SEC << " s, " << num_late << " late, "
+            << num_signers - num_finished - num_late
+            << " failed; last MSG_ACCEPT " << last_accept_ms.count()
+            << " ms after the responses, "
+            << SignerPool::getInstance()->getNumSignerBy(SignerStatus::GOOD)
+            << " signers GOOD" << std::endl;
+
+  return 0;
+}
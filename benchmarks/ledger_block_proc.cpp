@@ -0,0 +1,79 @@
+// Ledger processing of one full block of MAX_COLLECT_TRANSACTION_SIZE
+// transactions, a quarter of each type. "before" is every ledger in turn
+// picking its transactions out of the block's JSON; "after" is
+// CustomLedgerManager::procLedgerBlock(), which parses and partitions the
+// block once and runs the ledgers concurrently.
+//
+//   ledger_block_proc [num_rounds]
+
+#include "../src/chain/transaction.hpp"
+#include "../src/config/config.hpp"
+#include "../src/ledger/certificate_ledger.hpp"
+#include "../src/ledger/digest_ledger.hpp"
+#include "../src/ledger/sms_ledger.hpp"
+#include "../src/services/custom_ledger_manager.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace gruut;
+
+namespace {
+json makeBlockTxs() {
+  const std::vector<TransactionType> tx_types = {
+      TransactionType::CERTIFICATES, TransactionType::DIGESTS,
+      TransactionType::IMMORTALSMS, TransactionType::UNKNOWN};
+
+  json txs_json = json::array();
+  for (size_t i = 0; i < config::MAX_COLLECT_TRANSACTION_SIZE; ++i) {
+    Transaction tx;
+    tx.setTransactionType(tx_types[i % tx_types.size()]);
+    tx.setContents(
+        std::vector<content_type>({"user_" + std::to_string(i), "pem"}));
+    tx.genNewTxId();
+    txs_json.push_back(tx.getJson());
+  }
+
+  return txs_json;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const size_t num_rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10;
+
+  json txs_json = makeBlockTxs();
+
+  CertificateLedger certificate_ledger;
+  DigestLedger digest_ledger;
+  SmsLedger sms_ledger;
+  std::vector<Ledger *> ledgers = {&certificate_ledger, &digest_ledger,
+                                   &sms_ledger};
+  CustomLedgerManager ledger_manager;
+
+  std::chrono::microseconds before_us{0};
+  std::chrono::microseconds after_us{0};
+  for (size_t i = 0; i < num_rounds; ++i) {
+    std::string block_id_b64 = "before_" + std::to_string(i);
+    auto start_time = std::chrono::steady_clock::now();
+    for (auto ledger : ledgers)
+      ledger->procBlock(txs_json, block_id_b64, {});
+    before_us += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_time);
+
+    block_id_b64 = "after_" + std::to_string(i);
+    start_time = std::chrono::steady_clock::now();
+    ledger_manager.procLedgerBlock(txs_json, block_id_b64, {});
+    after_us += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_time);
+  }
+
+  std::cout << txs_json.size() << "-tx block, " << num_rounds
+            << " rounds: before " << before_us.count() / num_rounds
+            << " us, after " << after_us.count() / num_rounds
+            << " us per block" << std::endl;
+
+  return 0;
+}
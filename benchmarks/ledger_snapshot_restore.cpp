@@ -0,0 +1,59 @@
+// Ledger snapshot save and restore on a throwaway DB holding num_records
+// ledger records, as recoverLedger() does when the ledger tip does not match
+// the chain.
+//
+//   ledger_snapshot_restore [num_records]
+
+#include "../src/services/storage.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace gruut;
+
+int main(int argc, char *argv[]) {
+  const size_t num_records =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+
+  auto db_path = boost::filesystem::temp_directory_path() /
+                 boost::filesystem::unique_path("ledger_bench_%%%%%%%%");
+  std::unique_ptr<Storage> storage(new Storage(db_path.string()));
+
+  for (size_t i = 0; i < num_records; ++i)
+    storage->saveLedger("Cbench_" + std::to_string(i), std::to_string(i));
+  storage->saveLedgerTip(7, "bench_block_7");
+  storage->flushLedger();
+
+  auto start_time = std::chrono::steady_clock::now();
+  bool is_saved = storage->saveLedgerSnapshot();
+  auto save_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start_time);
+
+  // moves the ledger on, so the restore has records to throw away
+  storage->saveLedger("Cbench_0", "changed");
+  storage->saveLedgerTip(8, "bench_block_8");
+  storage->flushLedger();
+
+  start_time = std::chrono::steady_clock::now();
+  ledger_tip_type ledger_tip;
+  bool is_restored = storage->restoreLedgerSnapshot(ledger_tip);
+  auto restore_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start_time);
+
+  bool is_ok = is_saved && is_restored && ledger_tip.height == 7 &&
+               storage->readLedgerByKey("Cbench_0") == "0";
+
+  std::cout << num_records << " ledger records: snapshot saved in "
+            << save_ms.count() << " ms, restored in " << restore_ms.count()
+            << " ms" << (is_ok ? "" : " (FAILED)") << std::endl;
+
+  storage.reset();
+  boost::filesystem::remove_all(db_path);
+
+  return is_ok ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+// Ledger::procBlock() of every ledger on one full block of
+// MAX_COLLECT_TRANSACTION_SIZE transactions, a quarter of each type: from
+// the block's JSON, which each ledger parses and filters itself, against
+// the typed transaction views of its own type, partitioned beforehand.
+//
+//   ledger_tx_views [num_rounds]
+
+#include "../src/chain/transaction.hpp"
+#include "../src/config/config.hpp"
+#include "../src/ledger/certificate_ledger.hpp"
+#include "../src/ledger/digest_ledger.hpp"
+#include "../src/ledger/sms_ledger.hpp"
+#include "../src/services/custom_ledger_manager.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace gruut;
+
+namespace {
+json makeBlockTxs() {
+  const std::vector<TransactionType> tx_types = {
+      TransactionType::CERTIFICATES, TransactionType::DIGESTS,
+      TransactionType::IMMORTALSMS, TransactionType::UNKNOWN};
+
+  json txs_json = json::array();
+  for (size_t i = 0; i < config::MAX_COLLECT_TRANSACTION_SIZE; ++i) {
+    Transaction tx;
+    tx.setTransactionType(tx_types[i % tx_types.size()]);
+    tx.setContents(
+        std::vector<content_type>({"user_" + std::to_string(i), "pem"}));
+    tx.genNewTxId();
+    txs_json.push_back(tx.getJson());
+  }
+
+  return txs_json;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const size_t num_rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10;
+
+  json txs_json = makeBlockTxs();
+
+  // the views point into txs, which outlives them
+  std::vector<Transaction> txs = CustomLedgerManager::parseTxs(txs_json);
+  tx_partition_t tx_partition = CustomLedgerManager::partitionTxs(txs);
+
+  CertificateLedger certificate_ledger;
+  DigestLedger digest_ledger;
+  SmsLedger sms_ledger;
+  std::vector<std::pair<std::string, Ledger *>> ledgers = {
+      {"certificate", &certificate_ledger},
+      {"digest", &digest_ledger},
+      {"sms", &sms_ledger}};
+
+  for (auto &each_ledger : ledgers) {
+    Ledger *ledger = each_ledger.second;
+    const tx_views_t &tx_views = tx_partition[ledger->getTxTypes()[0]];
+
+    std::chrono::microseconds json_us{0};
+    std::chrono::microseconds view_us{0};
+    for (size_t i = 0; i < num_rounds; ++i) {
+      std::string block_id_b64 = "json_" + std::to_string(i);
+      auto start_time = std::chrono::steady_clock::now();
+      ledger->procBlock(txs_json, block_id_b64, {});
+      json_us += std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start_time);
+
+      block_id_b64 = "view_" + std::to_string(i);
+      start_time = std::chrono::steady_clock::now();
+      ledger->procBlock(tx_views, block_id_b64, {});
+      view_us += std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start_time);
+    }
+
+    std::cout << each_ledger.first << " ledger, " << tx_views.size() << " of "
+              << txs_json.size() << " txs: json "
+              << json_us.count() / num_rounds << " us, views "
+              << view_us.count() / num_rounds << " us per block" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+// Messages per second and latency of MSG_TX sent to a MergerServer on this
+// host, from the send until the message is taken off the server's input
+// queue. "before" opens a channel and a stub for every message and waits on
+// a blocking pushData, as MergerClient did; "after" goes through
+// MergerChannelPool, keeping at most half a send queue of messages
+// unanswered.
+//
+//   merger_channel_latency [num_msgs] [port]
+
+#include "../src/config/config.hpp"
+#include "../src/modules/communication/merger_channel_pool.hpp"
+#include "../src/modules/communication/merger_server.hpp"
+#include "../src/utils/type_converter.hpp"
+#include "merger_peer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gruut;
+
+namespace {
+struct RunResult {
+  size_t num_delivered;
+  long msgs_per_sec;
+  long p50_us;
+  long p99_us;
+};
+
+RunResult summarize(TxSink &tx_sink, size_t first_seq,
+                    const std::vector<std::chrono::steady_clock::time_point>
+                        &send_times) {
+  std::vector<long> latencies_us;
+  std::chrono::steady_clock::time_point last_arrival = send_times.front();
+  for (size_t i = 0; i < send_times.size(); ++i) {
+    auto arrival_time = tx_sink.arrivalTime(first_seq + i);
+    if (arrival_time.time_since_epoch().count() == 0)
+      continue;
+
+    latencies_us.push_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(arrival_time -
+                                                              send_times[i])
+            .count());
+    last_arrival = std::max(last_arrival, arrival_time);
+  }
+  std::sort(latencies_us.begin(), latencies_us.end());
+
+  auto percentile = [&latencies_us](double p) {
+    if (latencies_us.empty())
+      return 0L;
+    return latencies_us[static_cast<size_t>(p * (latencies_us.size() - 1))];
+  };
+  long elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        last_arrival - send_times.front())
+                        .count();
+
+  RunResult result;
+  result.num_delivered = latencies_us.size();
+  result.msgs_per_sec = elapsed_ms > 0 ? result.num_delivered * 1000 / elapsed_ms
+                                       : result.num_delivered;
+  result.p50_us = percentile(0.5);
+  result.p99_us = percentile(0.99);
+  return result;
+}
+
+void print(const std::string &name, const RunResult &result, size_t num_msgs) {
+  std::cout << name << ": " << result.num_delivered << " of " << num_msgs
+            << " came in, " << result.msgs_per_sec << " msgs/s; latency p50 "
+            << result.p50_us << " us, p99 " << result.p99_us << " us"
+            << std::endl;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const size_t num_msgs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+  const std::string port = argc > 2 ? argv[2] : "50097";
+  const size_t max_unanswered = config::MAX_MERGER_SEND_QUEUE / 2;
+  const auto wait_timeout =
+      std::chrono::milliseconds(2 * config::MERGER_SEND_TIMEOUT);
+
+  // before's messages are numbered from 0, after's from num_msgs
+  std::vector<std::shared_ptr<std::string>> packed_txs;
+  for (size_t i = 0; i < 2 * num_msgs; ++i)
+    packed_txs.emplace_back(std::make_shared<std::string>(packTx(i)));
+
+  MergerServer merger_server;
+  merger_server.runServer(port);
+  TxSink tx_sink(2 * num_msgs);
+  InputQueueDrain input_queue_drain(
+      [&tx_sink](size_t seq) { tx_sink.record(seq); });
+
+  MergerInfo peer_info;
+  peer_info.id = TypeConverter::integerToBytes<uint64_t>(2);
+  peer_info.address = "127.0.0.1";
+  peer_info.port = port;
+  const std::string address = peer_info.address + ":" + peer_info.port;
+
+  std::vector<std::chrono::steady_clock::time_point> send_times(num_msgs);
+  for (size_t i = 0; i < num_msgs; ++i) {
+    send_times[i] = std::chrono::steady_clock::now();
+    auto channel = CreateChannel(address, InsecureChannelCredentials());
+    auto stub = MergerCommunication::NewStub(channel);
+
+    MergerDataRequest request;
+    request.set_data(*packed_txs[i]);
+    MergerDataReply reply;
+    ClientContext context;
+    context.set_deadline(
+        std::chrono::system_clock::now() +
+        std::chrono::milliseconds(config::MERGER_SEND_TIMEOUT));
+    stub->pushData(&context, request, &reply);
+  }
+  tx_sink.waitFor(num_msgs, wait_timeout);
+  RunResult before = summarize(tx_sink, 0, send_times);
+
+  auto channel_pool = MergerChannelPool::getInstance();
+  while (!channel_pool->isConnected(peer_info))
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  const size_t num_delivered_before = tx_sink.numDelivered();
+  for (size_t i = 0; i < num_msgs; ++i) {
+    auto wait_start = std::chrono::steady_clock::now();
+    while (num_delivered_before + i >=
+               tx_sink.numDelivered() + max_unanswered &&
+           std::chrono::steady_clock::now() - wait_start < wait_timeout)
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+    send_times[i] = std::chrono::steady_clock::now();
+    // MergerClient sends MSG_TX as low priority
+    channel_pool->send(peer_info, packed_txs[num_msgs + i], true);
+  }
+  tx_sink.waitFor(2 * num_msgs, wait_timeout);
+  RunResult after = summarize(tx_sink, num_msgs, send_times);
+
+  print("before (channel per message)", before, num_msgs);
+  print("after (MergerChannelPool)", after, num_msgs);
+
+  return before.num_delivered == num_msgs && after.num_delivered == num_msgs
+             ? 0
+             : 1;
+}
@@ -0,0 +1,188 @@
+// Forwarded transactions between two mergers on this host. This process
+// sends MSG_TX through its MergerChannelPool, as MergerClient forwards them;
+// the receiving merger is a second process running a MergerServer, which
+// writes the txid of every MSG_TX it takes back through a pipe. Once a third
+// of the messages are in, the receiver is killed with SIGKILL and started
+// again on the same port after down_ms.
+//
+// The sender keeps at most half a send queue of messages unanswered, unless
+// none has come in for MERGER_SEND_TIMEOUT. Reports the throughput before
+// the kill, and how many messages came in, came in twice or were lost.
+//
+//   merger_forward [num_msgs] [down_ms] [port]
+
+#include "../src/config/config.hpp"
+#include "../src/modules/communication/merger_channel_pool.hpp"
+#include "../src/modules/communication/merger_server.hpp"
+#include "../src/utils/type_converter.hpp"
+#include "merger_peer.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gruut;
+
+namespace {
+// the receiving merger; txids go out on fd 3
+int runPeer(const std::string &port) {
+  MergerServer merger_server;
+  merger_server.runServer(port);
+  InputQueueDrain input_queue_drain([](size_t seq) {
+    std::string line = std::to_string(seq) + "\n";
+    if (write(3, line.data(), line.size()) < 0)
+      std::exit(0);
+  });
+
+  while (true)
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+}
+
+struct PeerProcess {
+  pid_t pid;
+  std::thread reader;
+};
+
+// starts the receiving merger and records what it takes in tx_sink
+PeerProcess startPeer(const char *self_path, const std::string &port,
+                      TxSink &tx_sink) {
+  int txid_pipe[2];
+  if (pipe(txid_pipe) != 0) {
+    std::perror("pipe");
+    std::exit(1);
+  }
+
+  PeerProcess peer;
+  peer.pid = fork();
+  if (peer.pid == 0) {
+    dup2(txid_pipe[1], 3);
+    dup2(open("/dev/null", O_WRONLY), 1);
+    execl(self_path, self_path, "--peer", port.c_str(),
+          static_cast<char *>(nullptr));
+    _exit(1);
+  }
+  close(txid_pipe[1]);
+
+  peer.reader = std::thread([txid_pipe, &tx_sink]() {
+    std::string pending;
+    char buf[4096];
+    ssize_t num_read;
+    while ((num_read = read(txid_pipe[0], buf, sizeof(buf))) > 0) {
+      pending.append(buf, num_read);
+      size_t line_start = 0;
+      size_t line_end;
+      while ((line_end = pending.find('\n', line_start)) !=
+             std::string::npos) {
+        tx_sink.record(std::strtoul(pending.c_str() + line_start, nullptr, 10));
+        line_start = line_end + 1;
+      }
+      pending.erase(0, line_start);
+    }
+    close(txid_pipe[0]);
+  });
+
+  return peer;
+}
+
+void killPeer(PeerProcess &peer) {
+  kill(peer.pid, SIGKILL);
+  waitpid(peer.pid, nullptr, 0);
+  peer.reader.join();
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc > 2 && std::strcmp(argv[1], "--peer") == 0)
+    return runPeer(argv[2]);
+
+  const size_t num_msgs =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  const size_t down_ms = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+  const std::string port = argc > 3 ? argv[3] : "50098";
+  const size_t max_unanswered = config::MAX_MERGER_SEND_QUEUE / 2;
+  const auto stall_timeout =
+      std::chrono::milliseconds(config::MERGER_SEND_TIMEOUT);
+
+  std::vector<std::shared_ptr<std::string>> packed_txs;
+  for (size_t i = 0; i < num_msgs; ++i)
+    packed_txs.emplace_back(std::make_shared<std::string>(packTx(i)));
+
+  TxSink tx_sink(num_msgs);
+  PeerProcess peer = startPeer(argv[0], port, tx_sink);
+
+  MergerInfo peer_info;
+  peer_info.id = TypeConverter::integerToBytes<uint64_t>(2);
+  peer_info.address = "127.0.0.1";
+  peer_info.port = port;
+  auto channel_pool = MergerChannelPool::getInstance();
+  while (!channel_pool->isConnected(peer_info))
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  const size_t num_before_kill = num_msgs / 3;
+  auto start_time = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point kill_time;
+  std::chrono::steady_clock::time_point restart_time;
+  std::thread killer([&]() {
+    tx_sink.waitFor(num_before_kill, std::chrono::hours(1));
+    kill_time = std::chrono::steady_clock::now();
+    killPeer(peer);
+    std::this_thread::sleep_for(std::chrono::milliseconds(down_ms));
+    restart_time = std::chrono::steady_clock::now();
+    peer = startPeer(argv[0], port, tx_sink);
+  });
+
+  size_t last_delivered = 0;
+  auto last_progress = std::chrono::steady_clock::now();
+  for (size_t seq = 0; seq < num_msgs; ++seq) {
+    while (seq >= tx_sink.numDelivered() + max_unanswered) {
+      auto now = std::chrono::steady_clock::now();
+      if (tx_sink.numDelivered() != last_delivered) {
+        last_delivered = tx_sink.numDelivered();
+        last_progress = now;
+      } else if (now - last_progress >= stall_timeout) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // MergerClient sends MSG_TX as low priority
+    channel_pool->send(peer_info, packed_txs[seq], true);
+  }
+
+  killer.join();
+  tx_sink.waitFor(num_msgs, 2 * stall_timeout);
+  killPeer(peer);
+
+  std::chrono::steady_clock::time_point last_arrival;
+  for (size_t seq = 0; seq < num_msgs; ++seq)
+    last_arrival = std::max(last_arrival, tx_sink.arrivalTime(seq));
+
+  auto toMs = [](std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(duration)
+        .count();
+  };
+  long before_kill_ms = toMs(kill_time - start_time);
+
+  size_t num_delivered = tx_sink.numDelivered();
+  std::cout << num_msgs << " forwarded MSG_TX: "
+            << (before_kill_ms > 0 ? num_before_kill * 1000 / before_kill_ms
+                                   : num_before_kill)
+            << " msgs/s before the kill; " << num_delivered << " came in ("
+            << tx_sink.numDuplicated() << " twice), "
+            << num_msgs - num_delivered << " lost; the last "
+            << toMs(last_arrival - restart_time)
+            << " ms after the restart" << std::endl;
+
+  return 0;
+}
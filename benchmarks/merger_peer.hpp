@@ -0,0 +1,119 @@
+#ifndef GRUUT_ENTERPRISE_MERGER_BENCHMARK_MERGER_PEER_HPP
+#define GRUUT_ENTERPRISE_MERGER_BENCHMARK_MERGER_PEER_HPP
+
+#include "../src/chain/message.hpp"
+#include "../src/modules/communication/grpc_util.hpp"
+#include "../src/services/input_queue.hpp"
+#include "../src/utils/time.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gruut {
+
+// a packed MSG_TX whose txid is seq
+inline std::string packTx(size_t seq) {
+  json body = {{"txid", std::to_string(seq)},
+               {"time", std::to_string(Time::now_int())},
+               {"rID", "benchmark"},
+               {"type", "digests"},
+               {"rSig", "benchmark"},
+               {"content", {"a1", "b2"}}};
+
+  std::string packed_msg(HEADER_LENGTH, '\0');
+  packed_msg.append(body.dump());
+  HeaderController::writeHeader(packed_msg, MessageType::MSG_TX,
+                                CompressionAlgorithmType::NONE);
+  return packed_msg;
+}
+
+// Empties the input queue in place of the message fetcher of the receiving
+// merger, and hands on the txid of every MSG_TX packed by packTx().
+class InputQueueDrain {
+public:
+  explicit InputQueueDrain(std::function<void(size_t seq)> on_tx)
+      : m_on_tx(std::move(on_tx)) {
+    m_drain_thread = std::thread([this]() { drain(); });
+  }
+
+  ~InputQueueDrain() {
+    m_is_done = true;
+    m_drain_thread.join();
+  }
+
+private:
+  void drain() {
+    auto input_queue = InputQueueAlt::getInstance();
+    while (!m_is_done) {
+      auto input_msgs = input_queue->fetchBulk(256);
+      if (input_msgs.empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        continue;
+      }
+
+      for (auto &input_msg : input_msgs) {
+        if (input_msg.type == MessageType::MSG_TX)
+          m_on_tx(std::strtoul(
+              input_msg.body["txid"].get<std::string>().c_str(), nullptr, 10));
+      }
+    }
+  }
+
+  std::function<void(size_t seq)> m_on_tx;
+  std::atomic<bool> m_is_done{false};
+  std::thread m_drain_thread;
+};
+
+// when each of num_msgs messages, numbered from 0, first came in
+class TxSink {
+public:
+  explicit TxSink(size_t num_msgs) : m_arrival_times(num_msgs) {}
+
+  void record(size_t seq) {
+    if (seq >= m_arrival_times.size())
+      return;
+
+    std::lock_guard<std::mutex> lock(m_arrival_mutex);
+    if (m_arrival_times[seq].time_since_epoch().count() != 0) {
+      ++m_num_duplicated;
+    } else {
+      m_arrival_times[seq] = std::chrono::steady_clock::now();
+      ++m_num_delivered;
+    }
+  }
+
+  size_t numDelivered() { return m_num_delivered; }
+  size_t numDuplicated() { return m_num_duplicated; }
+
+  // false if fewer than num_msgs came in before timeout
+  bool waitFor(size_t num_msgs, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (m_num_delivered < num_msgs) {
+      if (std::chrono::steady_clock::now() >= deadline)
+        return false;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+  }
+
+  // the time point is zero for a message that never came in
+  std::chrono::steady_clock::time_point arrivalTime(size_t seq) {
+    std::lock_guard<std::mutex> lock(m_arrival_mutex);
+    return m_arrival_times[seq];
+  }
+
+private:
+  std::vector<std::chrono::steady_clock::time_point> m_arrival_times;
+  std::mutex m_arrival_mutex;
+  std::atomic<size_t> m_num_delivered{0};
+  std::atomic<size_t> m_num_duplicated{0};
+};
+} // namespace gruut
+
+#endif
@@ -0,0 +1,93 @@
+// Load run of many concurrent SE clients against a MergerServer on this
+// host. Each client thread has its own channel and sends MSG_TX requests one
+// after another; the input queue is emptied in place of the message
+// fetcher.
+//
+//   merger_server_load [num_clients] [requests_per_client] [port]
+
+#include "../src/config/config.hpp"
+#include "../src/modules/communication/grpc_util.hpp"
+#include "../src/modules/communication/merger_server.hpp"
+#include "merger_peer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gruut;
+
+int main(int argc, char *argv[]) {
+  const size_t num_clients = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+  const size_t num_requests =
+      argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+  const std::string port = argc > 3 ? argv[3] : "50099";
+
+  MergerServer merger_server;
+  merger_server.runServer(port);
+
+  InputQueueDrain input_queue_drain([](size_t) {});
+
+  std::atomic<size_t> num_ok{0};
+  std::vector<std::vector<long>> latencies_us(num_clients);
+
+  auto start_time = std::chrono::steady_clock::now();
+  std::vector<std::thread> clients;
+  for (size_t i = 0; i < num_clients; ++i) {
+    clients.emplace_back([&, i]() {
+      auto channel = grpc::CreateChannel("127.0.0.1:" + port,
+                                         grpc::InsecureChannelCredentials());
+      auto stub = GruutSeService::NewStub(channel);
+      auto &latencies = latencies_us[i];
+      latencies.reserve(num_requests);
+
+      for (size_t j = 0; j < num_requests; ++j) {
+        Request request;
+        request.set_message(packTx(i * num_requests + j));
+        Reply reply;
+        ClientContext context;
+        context.set_deadline(std::chrono::system_clock::now() +
+                             std::chrono::milliseconds(config::MERGER_SEND_TIMEOUT));
+
+        auto sent_time = std::chrono::steady_clock::now();
+        Status status = stub->seService(&context, request, &reply);
+        latencies.push_back(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - sent_time)
+                .count());
+
+        if (status.ok() && reply.status() == Reply_Status_SUCCESS)
+          ++num_ok;
+      }
+    });
+  }
+  for (auto &client : clients)
+    client.join();
+  auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start_time);
+
+  std::vector<long> all_latencies;
+  for (auto &latencies : latencies_us)
+    all_latencies.insert(all_latencies.end(), latencies.begin(),
+                         latencies.end());
+  std::sort(all_latencies.begin(), all_latencies.end());
+  auto percentile = [&all_latencies](double p) {
+    if (all_latencies.empty())
+      return 0L;
+    return all_latencies[static_cast<size_t>(p * (all_latencies.size() - 1))];
+  };
+
+  size_t num_total = num_clients * num_requests;
+  std::cout << num_total << " requests from " << num_clients << " clients ("
+            << num_ok << " ok) in " << elapsed_ms.count() << " ms, "
+            << (elapsed_ms.count() > 0 ? num_total * 1000 / elapsed_ms.count()
+                                       : num_total)
+            << " req/s; latency p50 " << percentile(0.5) << " us, p99 "
+            << percentile(0.99) << " us" << std::endl;
+
+  return num_ok == num_total ? 0 : 1;
+}
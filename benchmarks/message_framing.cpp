@@ -0,0 +1,71 @@
+// Framing of one message, send and receive side, without the JSON parsing
+// both paths share. "in place" is the body behind room for the header and
+// the body read where it lies; "copy" is header + body and then a copy of
+// the request and a substr of the body, as messages were framed before.
+//
+//   message_framing [num_msgs] [body_size]
+
+#include "../src/chain/message.hpp"
+#include "../src/modules/communication/grpc_util.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace gruut;
+
+int main(int argc, char *argv[]) {
+  const size_t num_msgs =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  const size_t body_size = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4096;
+
+  const std::string body(body_size, 'a');
+  size_t checksum = 0;
+
+  auto start_time = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_msgs; ++i) {
+    std::string packed_msg;
+    packed_msg.reserve(HEADER_LENGTH + body.size());
+    packed_msg.resize(HEADER_LENGTH);
+    packed_msg.append(body);
+    HeaderController::writeHeader(packed_msg, MessageType::MSG_TX,
+                                  CompressionAlgorithmType::NONE);
+
+    const char *recv_msg = packed_msg.data();
+    MessageHeader header = HeaderController::parseHeader(recv_msg);
+    const char *msg_body = recv_msg + HEADER_LENGTH;
+    size_t msg_body_size =
+        HeaderController::convertU8ToU32BE(header.total_length) -
+        HEADER_LENGTH;
+    checksum += msg_body[msg_body_size - 1];
+  }
+  auto in_place_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start_time);
+
+  start_time = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_msgs; ++i) {
+    std::string header(HEADER_LENGTH, '\0');
+    std::string body_copy = body;
+    std::string packed_msg = header + body_copy;
+    HeaderController::writeHeader(packed_msg, MessageType::MSG_TX,
+                                  CompressionAlgorithmType::NONE);
+
+    std::string recv_msg = packed_msg;
+    MessageHeader header_read = HeaderController::parseHeader(recv_msg);
+    size_t msg_body_size =
+        HeaderController::convertU8ToU32BE(header_read.total_length) -
+        HEADER_LENGTH;
+    std::string msg_body = recv_msg.substr(HEADER_LENGTH, msg_body_size);
+    checksum += msg_body.back();
+  }
+  auto copy_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start_time);
+
+  std::cout << num_msgs << " messages of " << body_size
+            << " bytes: in place " << in_place_ns.count() / num_msgs
+            << " ns, copy " << copy_ns.count() / num_msgs
+            << " ns per message" << std::endl;
+
+  return checksum == 2 * num_msgs * 'a' ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+// Fork-heavy run of the unresolved block pool. Every height gets num_forks
+// competing blocks. Fork 0 always extends fork 0 below with 3 support
+// signatures, so it wins; every other fork extends either itself or fork 0
+// with 1 or 2. Resolution runs after every push as it does in the block
+// processor, and the pool backs up to a throwaway DB.
+//
+//   unresolved_pool_forks [num_heights] [num_forks]
+
+#include "../src/modules/block_processor/unresolved_block_pool.hpp"
+#include "../tests/modules/fixture.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace gruut;
+
+int main(int argc, char *argv[]) {
+  const size_t num_heights =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+  const size_t num_forks = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8;
+
+  // built up front, so only the pool is timed
+  std::mt19937 rng(7);
+  std::vector<std::vector<TestBlock>> blocks(num_heights);
+  for (size_t i = 0; i < num_heights; ++i) {
+    for (size_t j = 0; j < num_forks; ++j) {
+      std::string branch = "f" + std::to_string(i) + "_" + std::to_string(j);
+      size_t num_ssigs = (j == 0) ? 3 : 1 + rng() % 2;
+      if (i == 0) {
+        blocks[i].emplace_back(makeFirstTestBlock(branch, num_ssigs));
+      } else {
+        auto &parent = blocks[i - 1][(rng() % 2 == 0) ? j : 0];
+        blocks[i].emplace_back(
+            makeTestBlock(i + 1, *parent.block, branch, num_ssigs));
+      }
+    }
+  }
+
+  TempStorageFixture temp_storage;
+  UnresolvedBlockPool pool(temp_storage.storage.get(),
+                           [](const Block &, const block_layer_t &) {});
+  pool.setPool(TypeConverter::decodeBase64(config::GENESIS_BLOCK_PREV_ID_B64),
+               {},
+               TypeConverter::decodeBase64(config::GENESIS_BLOCK_PREV_HASH_B64),
+               {}, 0, 0);
+
+  size_t num_resolved = 0;
+  size_t num_dropped = 0;
+  std::chrono::microseconds push_us{0};
+  std::chrono::microseconds resolve_us{0};
+  std::vector<UnresolvedBlock> resolved_blocks;
+  std::vector<std::string> drop_blocks;
+
+  for (auto &each_height : blocks) {
+    for (auto &each_block : each_height) {
+      auto start_time = std::chrono::steady_clock::now();
+      pool.push(each_block.block);
+      auto pushed_time = std::chrono::steady_clock::now();
+      pool.getResolvedBlocks(resolved_blocks, drop_blocks);
+      auto resolved_time = std::chrono::steady_clock::now();
+
+      push_us += std::chrono::duration_cast<std::chrono::microseconds>(
+          pushed_time - start_time);
+      resolve_us += std::chrono::duration_cast<std::chrono::microseconds>(
+          resolved_time - pushed_time);
+      num_resolved += resolved_blocks.size();
+      num_dropped += drop_blocks.size();
+    }
+  }
+
+  size_t num_pushes = num_heights * num_forks;
+  std::cout << num_pushes << " pushes over " << num_heights << " heights x "
+            << num_forks << " forks: push " << push_us.count() / num_pushes
+            << " us, resolve " << resolve_us.count() / num_pushes
+            << " us on average; " << num_resolved << " resolved, "
+            << num_dropped << " dropped, tip at "
+            << pool.getMostPossibleLink().height << std::endl;
+
+  return 0;
+}
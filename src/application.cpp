@@ -22,6 +22,8 @@ SignaturePool &Application::getSignaturePool() { return *m_signature_pool; }
 
 BlockProcessor &Application::getBlockProcessor() { return *m_block_processor; }
 
+BlockScrubber &Application::getBlockScrubber() { return *m_block_scrubber; }
+
 CustomLedgerManager &Application::getCustomLedgerManager() {
   return *m_custom_ledger_manager;
 }
@@ -101,6 +103,7 @@ void Application::setup() {
   m_block_processor = make_shared<BlockProcessor>();
   m_bootstraper = make_shared<Bootstrapper>();
   m_block_health_checker = make_shared<BlockHealthChecker>();
+  m_block_scrubber = make_shared<BlockScrubber>();
   m_communication = make_shared<Communication>();
   m_out_message_fetcher = make_shared<OutMessageFetcher>();
   m_message_fetcher = make_shared<MessageFetcher>();
@@ -117,6 +120,7 @@ void Application::setup() {
 
   registerModule(m_message_fetcher, 3);
   registerModule(m_bp_scheduler, 3);
+  registerModule(m_block_scrubber, 3);
 
   // setp 3 - link services
 
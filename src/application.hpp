@@ -5,6 +5,7 @@
 #include "modules/bp_scheduler/bp_scheduler.hpp"
 #include "modules/communication/communication.hpp"
 #include "modules/health_checker/block_health_checker.hpp"
+#include "modules/health_checker/block_scrubber.hpp"
 #include "modules/message_fetcher/message_fetcher.hpp"
 #include "modules/message_fetcher/out_message_fetcher.hpp"
 #include "modules/module.hpp"
@@ -60,6 +61,8 @@ public:
 
   BlockProcessor &getBlockProcessor();
 
+  BlockScrubber &getBlockScrubber();
+
   BpScheduler &getBpScheduler();
 
   CustomLedgerManager &getCustomLedgerManager();
@@ -90,6 +93,7 @@ private:
   shared_ptr<OutMessageFetcher> m_out_message_fetcher;
   shared_ptr<Bootstrapper> m_bootstraper;
   shared_ptr<BlockHealthChecker> m_block_health_checker;
+  shared_ptr<BlockScrubber> m_block_scrubber;
   shared_ptr<MessageFetcher> m_message_fetcher;
 
   shared_ptr<CustomLedgerManager> m_custom_ledger_manager;
@@ -52,7 +52,7 @@ private:
 public:
   Block() { el::Loggers::getLogger("BLOC"); };
 
-  bool operator==(Block &other) const {
+  bool operator==(const Block &other) const {
     return (m_height == other.getHeight() && m_block_hash == other.getHash());
   }
 
@@ -86,6 +86,21 @@ public:
 
   bool initialize(bytes &block_raw_bytes, json &block_txs) {
 
+    if (!initializeHeader(block_raw_bytes))
+      return false;
+
+    if (!setTransactions(block_txs))
+      return false;
+
+    m_merkle_tree_node = calcMerkleTreeNode();
+    m_user_certs = extractUserCertsIf();
+
+    return true;
+  }
+
+  // header part only (no transactions), e.g., for header-first sync
+  bool initializeHeader(bytes &block_raw_bytes) {
+
     if (block_raw_bytes.empty())
       return false;
 
@@ -111,12 +126,6 @@ public:
     if (!setSupportSignaturesFromJson(block_header_json["SSig"]))
       return false;
 
-    if (!setTransactions(block_txs))
-      return false;
-
-    m_merkle_tree_node = calcMerkleTreeNode();
-    m_user_certs = extractUserCertsIf();
-
     m_block_raw = block_raw_bytes;
     m_block_hash = Sha256::hash(block_raw_bytes);
     m_signature = getBlockSignature(block_raw_bytes);
@@ -198,9 +207,9 @@ public:
     m_block_hash = Sha256::hash(m_block_raw);
   }
 
-  bytes getBlockRaw() { return m_block_raw; }
+  const bytes &getBlockRaw() const { return m_block_raw; }
 
-  std::vector<tx_id_type> getTxIds() {
+  std::vector<tx_id_type> getTxIds() const {
     std::vector<tx_id_type> ret_txids;
     for (auto &each_tx : m_transactions) {
       ret_txids.emplace_back(each_tx.getId());
@@ -208,7 +217,7 @@ public:
     return ret_txids;
   }
 
-  json getBlockHeaderJson() {
+  json getBlockHeaderJson() const {
 
     json block_header;
 
@@ -237,7 +246,7 @@ public:
     return block_header;
   }
 
-  json getBlockBodyJson() {
+  json getBlockBodyJson() const {
 
     std::vector<std::string> mtree_node_b64;
     for (size_t i = 0; i < m_transactions.size(); ++i) {
@@ -250,7 +259,7 @@ public:
                  {"tx", getBlockTXsAsJson()}});
   }
 
-  json getBlockTXsAsJson() {
+  json getBlockTXsAsJson() const {
     json txs = json::array();
     for (auto &each_tx : m_transactions) {
       txs.push_back(each_tx.getJson());
@@ -259,27 +268,33 @@ public:
     return txs;
   }
 
-  block_height_type getHeight() { return m_height; }
+  const std::vector<Transaction> &getTransactions() const {
+    return m_transactions;
+  }
+
+  block_height_type getHeight() const { return m_height; }
 
-  size_t getNumTransactions() { return m_transactions.size(); }
+  size_t getNumTransactions() const { return m_transactions.size(); }
 
-  size_t getNumSSigs() { return m_ssigs.size(); }
+  size_t getNumSSigs() const { return m_ssigs.size(); }
 
-  timestamp_t getTime() { return m_time; }
+  timestamp_t getTime() const { return m_time; }
 
-  hash_t getHash() { return m_block_hash; }
-  hash_t getPrevHash() { return m_prev_block_hash; }
-  block_id_type getBlockId() { return m_block_id; }
-  block_id_type getPrevBlockId() { return m_prev_block_id; }
+  hash_t getHash() const { return m_block_hash; }
+  hash_t getPrevHash() const { return m_prev_block_hash; }
+  block_id_type getBlockId() const { return m_block_id; }
+  block_id_type getPrevBlockId() const { return m_prev_block_id; }
 
-  std::string getHashB64() { return TypeConverter::encodeBase64(m_block_hash); }
-  std::string getPrevHashB64() {
+  std::string getHashB64() const {
+    return TypeConverter::encodeBase64(m_block_hash);
+  }
+  std::string getPrevHashB64() const {
     return TypeConverter::encodeBase64(m_prev_block_hash);
   }
-  std::string getBlockIdB64() {
+  std::string getBlockIdB64() const {
     return TypeConverter::encodeBase64(m_block_id);
   }
-  std::string getPrevBlockIdB64() {
+  std::string getPrevBlockIdB64() const {
     return TypeConverter::encodeBase64(m_prev_block_id);
   }
 
@@ -287,7 +302,8 @@ public:
   // suitable certificates Therefore, the verification of support signatures
   // should be delayed until the previous block has been saved.
   bool isValidLate(
-      std::function<std::string(std::string &, timestamp_t)> &get_user_cert) {
+      std::function<std::string(std::string &, timestamp_t)> &get_user_cert)
+      const {
     // step - check support signatures
     bytes ssig_msg_after_sid = getSupportSigMessageCommon();
 
@@ -331,7 +347,7 @@ public:
     }
 
     // step - check merkle tree
-    if (m_tx_root != m_merkle_tree_node.back()) {
+    if (!hasValidTxRoot()) {
       CLOG(ERROR, "BLOC") << "Invalid Merkle-tree root";
       return false;
     }
@@ -348,6 +364,21 @@ public:
     }
 
     // step - check merger's signature
+    return isValidHeader(get_cert);
+  }
+
+  bool hasValidTxRoot() const {
+    return !m_merkle_tree_node.empty() &&
+           m_tx_root == m_merkle_tree_node.back();
+  }
+
+  // merger's signature over the header; the body is bound to it by m_tx_root
+  bool isValidHeader(std::function<std::string(id_type &)> &get_cert) {
+
+    if (m_block_raw.empty() || m_signature.empty()) {
+      CLOG(ERROR, "BLOC") << "Empty blockraw or signature";
+      return false;
+    }
 
     std::string merger_pk_cert = get_cert(m_merger_id);
 
@@ -366,7 +397,7 @@ public:
     return true;
   }
 
-  std::string serialize() {
+  std::string serialize() const {
     json block_body = getBlockBodyJson();
     block_body["blockraw"] = TypeConverter::encodeBase64(m_block_raw);
     return TypeConverter::bytesToString(json::to_cbor(block_body));
@@ -421,7 +452,7 @@ private:
     return block_raw_builder.getBytes();
   }
 
-  bytes getSupportSigMessageCommon() {
+  bytes getSupportSigMessageCommon() const {
     BytesBuilder ssig_msg_common_builder;
     ssig_msg_common_builder.append(m_time);
     ssig_msg_common_builder.append(m_merger_id);
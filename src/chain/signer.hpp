@@ -2,8 +2,10 @@
 #define GRUUT_ENTERPRISE_MERGER_SIGNER_HPP
 
 #include <botan-2/botan/secmem.h>
+#include <memory>
 #include <string>
 
+#include "../utils/hmac.hpp"
 #include "types.hpp"
 
 namespace gruut {
@@ -11,9 +13,12 @@ struct Signer {
   signer_id_type user_id;
   std::string pk_cert;
   hmac_key_type hmac_key;
+  std::shared_ptr<const HmacContext> hmac_context; // made from hmac_key
   timestamp_t last_update{0};
   SignerStatus status{SignerStatus::UNKNOWN};
 };
 
+using SignerHandle = std::shared_ptr<const Signer>;
+
 } // namespace gruut
 #endif
@@ -17,6 +17,20 @@
 #include <iostream>
 
 namespace gruut {
+
+// non-owning view of a parsed transaction for ledgers; valid as long as the
+// viewed Transaction is alive and unchanged
+struct TransactionView {
+  TransactionType type;
+  timestamp_t time;
+  const std::vector<content_type> *contents;
+  TransactionView(TransactionType type_, timestamp_t time_,
+                  const std::vector<content_type> *contents_)
+      : type(type_), time(time_), contents(contents_) {}
+};
+
+using tx_views_t = std::vector<TransactionView>;
+
 class Transaction {
 private:
   tx_id_type m_transaction_id;
@@ -62,7 +76,7 @@ public:
     return true;
   }
 
-  json getJson() {
+  json getJson() const {
     return json({{"txid", TypeConverter::encodeBase64(m_transaction_id)},
                  {"time", to_string(m_sent_time)},
                  {"rID", TypeConverter::encodeBase64(m_requestor_id)},
@@ -75,9 +89,9 @@ public:
     m_transaction_id = transaction_id;
   }
 
-  tx_id_type getId() { return m_transaction_id; }
+  tx_id_type getId() const { return m_transaction_id; }
 
-  std::string getIdB64() {
+  std::string getIdB64() const {
     return TypeConverter::encodeBase64(m_transaction_id);
   }
 
@@ -99,7 +113,15 @@ public:
     m_transaction_type = transaction_type;
   }
 
-  TransactionType getTransactionType() { return m_transaction_type; }
+  TransactionType getTransactionType() const { return m_transaction_type; }
+
+  const std::vector<content_type> &getContents() const {
+    return m_content_list;
+  }
+
+  TransactionView getView() const {
+    return TransactionView(m_transaction_type, m_sent_time, &m_content_list);
+  }
 
   template <typename T = signature_type> void setSignature(T &&signature) {
     m_signature = signature;
@@ -159,7 +181,7 @@ public:
   }
 
 private:
-  std::string txTypeToStr(TransactionType transaction_type) {
+  std::string txTypeToStr(TransactionType transaction_type) const {
 
     std::string ret_str = "UNKNOWN";
 
@@ -39,6 +39,7 @@ enum class MessageType : uint8_t {
   MSG_UP = 0x30,
   MSG_PING = 0x31,
   MSG_REQ_BLOCK = 0x32,
+  MSG_REQ_BLOCK_RANGE = 0x36,
   MSG_WELCOME = 0x35,
   MSG_REQ_STATUS = 0x33,
   MSG_RES_STATUS = 0x34,
@@ -59,6 +60,7 @@ enum class MessageType : uint8_t {
   MSG_SSIG = 0xB3,
   MSG_BLOCK = 0xB4,
   MSG_HEADER = 0xB5,
+  MSG_BLOCK_RANGE = 0xB6,
   MSG_ERROR = 0xFF,
   MSG_REQ_CHECK = 0xC0,
   MSG_REQ_HEADER = 0xE0,
@@ -96,7 +98,10 @@ enum class CompressionAlgorithmType : uint8_t {
   NONE = 0xFF
 };
 
+// GOOD stays last; SignerPool keeps one index per value up to it
 enum class SignerStatus { UNKNOWN, TEMPORARY, ERROR, GOOD };
+constexpr size_t NUM_SIGNER_STATUS =
+    static_cast<size_t>(SignerStatus::GOOD) + 1;
 
 // DB
 enum class DBType : int {
@@ -181,6 +186,11 @@ using nth_link_type = struct _nth_link_type {
   timestamp_t time;
 };
 
+using ledger_tip_type = struct _ledger_tip_type {
+  block_height_type height{0};
+  std::string block_id_b64;
+};
+
 using unblk_push_result_type = struct _unblk_push_result_type {
   bool linked;
   bool duplicated;
@@ -21,6 +21,12 @@ constexpr block_version_type DEFAULT_VERSION = 0x01;
 // SETTING
 
 constexpr size_t MAX_THREAD = 40;
+constexpr size_t NUM_SERVER_CQ = 4;
+constexpr size_t NUM_RPC_WORKERS = 8;
+constexpr size_t NUM_JOIN_WORKERS = 4;
+constexpr size_t MAX_HTTP_CONN_PER_HOST = 4;
+constexpr bool HTTP_RAW_BODY = false;
+constexpr bool HEADER_FIRST_SYNC = true;
 constexpr auto DEFAULT_COMPRESSION_TYPE = CompressionAlgorithmType::LZ4;
 constexpr auto DEFAULT_BLOCKRAW_COMP_ALGO = CompressionAlgorithmType::LZ4;
 constexpr size_t MAX_SIGNER_NUM = 200;
@@ -31,16 +37,48 @@ constexpr size_t BLOCK_CONFIRM_LEVEL = 3;
 constexpr size_t MIN_SIGNATURE_COLLECT_SIZE = 1;
 constexpr size_t MAX_SIGNATURE_COLLECT_SIZE = 20;
 constexpr size_t MAX_UNICAST_MISSING_BLOCK = 4;
+constexpr size_t LEDGER_SNAPSHOT_INTERVAL = 1000;    // in blocks
+constexpr size_t MIN_BACKUP_LOG_COMPACTION = 256;    // in log entries
+constexpr size_t BLOCK_PIPELINE_QUEUE_SIZE = 64;     // in blocks
+constexpr size_t BLOCK_PIPELINE_MAX_IN_FLIGHT = 128; // in blocks
+constexpr size_t MAX_BLOCK_VERIFIER = 4;             // in threads
+constexpr size_t BLOCK_PIPELINE_STAT_INTERVAL = 100; // in blocks
+constexpr size_t MAX_BLOCK_RANGE_SIZE = 256;         // in blocks
+constexpr size_t MAX_HEADER_RANGE_SIZE = 2048;       // in blocks
+constexpr size_t MAX_BLOCK_RANGE_BYTES = 1048576;    // in bytes
+constexpr size_t MAX_OUTSTANDING_BLOCK_RANGE = 4;    // in requests, per peer
+constexpr size_t MAX_SYNC_PEER_FAIL = 3;             // in timeouts
+constexpr size_t HEALTH_CHECK_BATCH_SIZE = 256;      // in blocks
+constexpr size_t MAX_SCRUB_BLOCKS_PER_TICK = 8;      // in blocks, 0 = off
+constexpr size_t MAX_SCRUB_BYTES_PER_TICK = 262144;  // in bytes
+constexpr size_t GAP_FILL_STAT_WINDOW = 128;         // in samples
+constexpr size_t MAX_MERGER_SEND_QUEUE = 256;        // in messages, per merger
+constexpr size_t MAX_MERGER_FRAME_BYTES = 65536;     // in bytes
+constexpr size_t MAX_MERGER_UNACKED_FRAMES = 8;      // in frames, per merger
 
 // TIMING
 
 constexpr size_t SYNC_CONTROL_INTERVAL = 1000;
 constexpr size_t BP_INTERVAL = 10;
 constexpr size_t BP_PING_PERIOD = 4;
-constexpr size_t BROC_PROC_REQUEST_MISSING_INTERVAL = 500;
-constexpr size_t BROC_PROCESSOR_REQ_WAIT = 3;
+constexpr size_t BLOCK_REQ_INIT_TIMEOUT_MS = 1000;
+constexpr size_t MIN_BLOCK_REQ_TIMEOUT_MS = 100;
+constexpr size_t MAX_BLOCK_REQ_TIMEOUT_MS = 8000;
+constexpr size_t CHAIN_INFO_INTERVAL = 1000;
+constexpr int MERGER_CONNECT_TIMEOUT = 500;
+constexpr int MERGER_KEEPALIVE_INTERVAL = 10000;
+constexpr int MIN_MERGER_RECONNECT_BACKOFF = 1000;
+constexpr int MAX_MERGER_RECONNECT_BACKOFF = 30000;
+constexpr int MERGER_SEND_TIMEOUT = 3000;
+constexpr int MERGER_STREAM_RETRY_INTERVAL = 30000;
+constexpr long HTTP_POST_TIMEOUT = 2;
+constexpr long HTTP_REPLY_TIMEOUT = 5;
+constexpr long HTTP_CHECK_TIMEOUT = 2;
+constexpr size_t BLOCK_RANGE_REQ_TIMEOUT = 5;
+constexpr size_t BLOCK_SCRUB_INTERVAL = 1000;
 constexpr size_t STATUS_COLLECTING_TIMEOUT = 4000;
 constexpr size_t JOIN_TIMEOUT_SEC = 10;
+constexpr size_t JOIN_EXPIRY_CHECK_INTERVAL = 1000;
 constexpr size_t INQUEUE_MSG_FETCHER_INTERVAL = 5;
 constexpr size_t OUTQUEUE_MSG_FETCHER_INTERVAL = 100;
 constexpr size_t SIGNATURE_COLLECTION_TIMEOUT = 3000;
@@ -63,6 +101,7 @@ const std::string DB_SUB_DIR_TRANSACTION = "transaction";
 const std::string DB_SUB_DIR_IDHEIGHT = "blockid_height";
 const std::string DB_SUB_DIR_LEDGER = "ledger";
 const std::string DB_SUB_DIR_BACKUP = "backup";
+const std::string DB_SUB_DIR_LEDGER_SNAPSHOT = "ledger_snapshot";
 const std::string DB_SUB_DIR_MERGER_INFO = "merger_info";
 
 // clang-format on
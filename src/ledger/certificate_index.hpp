@@ -0,0 +1,150 @@
+#ifndef GRUUT_ENTERPRISE_MERGER_CERTIFICATE_INDEX_HPP
+#define GRUUT_ENTERPRISE_MERGER_CERTIFICATE_INDEX_HPP
+
+#include "../chain/types.hpp"
+#include "../utils/template_singleton.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gruut {
+
+struct CertificateRecord {
+  timestamp_t valid_begin{0};
+  timestamp_t valid_end{0};
+  std::string pem;
+  CertificateRecord() = default;
+  CertificateRecord(timestamp_t valid_begin_, timestamp_t valid_end_,
+                    std::string pem_)
+      : valid_begin(valid_begin_), valid_end(valid_end_),
+        pem(std::move(pem_)) {}
+};
+
+// Validity timeline of one user's certificates.
+// The timeline is cut into segments where the answer of getCertificate() does
+// not change, so a time-point lookup is a single binary search.
+class CertificateHistory {
+private:
+  std::vector<CertificateRecord> m_records;
+  std::string m_latest_pem;
+  std::vector<timestamp_t> m_seg_begin;
+  std::vector<int> m_seg_record; // -1 = no valid certificate
+
+public:
+  CertificateHistory() = default;
+
+  // records must be in ledger order (0-th, 1-st, ...)
+  void build(std::vector<CertificateRecord> &&records,
+             std::string &&latest_pem) {
+    m_records = std::move(records);
+    m_latest_pem = std::move(latest_pem);
+    m_seg_begin.clear();
+    m_seg_record.clear();
+
+    // valid_begin < t < valid_end  <=>  t in [valid_begin + 1, valid_end)
+    std::vector<timestamp_t> cuts;
+    for (auto &each_record : m_records) {
+      if (each_record.valid_begin + 1 >= each_record.valid_end)
+        continue;
+      cuts.emplace_back(each_record.valid_begin + 1);
+      cuts.emplace_back(each_record.valid_end);
+    }
+
+    std::sort(cuts.begin(), cuts.end());
+    cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+
+    for (auto &each_cut : cuts) {
+      int record_idx = scan(each_cut);
+      if (!m_seg_record.empty() && m_seg_record.back() == record_idx)
+        continue;
+      m_seg_begin.emplace_back(each_cut);
+      m_seg_record.emplace_back(record_idx);
+    }
+  }
+
+  std::string find(timestamp_t at_this_time) const {
+    if (at_this_time == 0)
+      return m_latest_pem;
+
+    auto it = std::upper_bound(m_seg_begin.begin(), m_seg_begin.end(),
+                               at_this_time);
+    if (it == m_seg_begin.begin())
+      return "";
+
+    int record_idx = m_seg_record[std::distance(m_seg_begin.begin(), it) - 1];
+    return (record_idx < 0) ? "" : m_records[record_idx].pem;
+  }
+
+private:
+  // the rule of the former linear lookup: the earliest record having the
+  // latest valid_begin among the records valid at that time
+  int scan(timestamp_t at_this_time) const {
+    timestamp_t latest_valid_begin = 0;
+    int ret_idx = -1;
+    for (size_t i = 0; i < m_records.size(); ++i) {
+      auto &each_record = m_records[i];
+      if (each_record.valid_begin < at_this_time &&
+          at_this_time < each_record.valid_end &&
+          latest_valid_begin < each_record.valid_begin) {
+        latest_valid_begin = each_record.valid_begin;
+        ret_idx = static_cast<int>(i);
+      }
+    }
+    return ret_idx;
+  }
+};
+
+// In-memory cache of certificate histories shared by all CertificateLedger
+// instances. Entries are loaded lazily and dropped whenever the ledger view
+// of that user may have changed.
+class CertificateIndex : public TemplateSingleton<CertificateIndex> {
+private:
+  std::unordered_map<std::string, CertificateHistory> m_histories;
+  std::mutex m_index_mutex;
+  uint64_t m_version{0};
+
+public:
+  bool find(const std::string &user_id_b64, timestamp_t at_this_time,
+            std::string &ret_cert) {
+    std::lock_guard<std::mutex> lock(m_index_mutex);
+    auto it_map = m_histories.find(user_id_b64);
+    if (it_map == m_histories.end())
+      return false;
+
+    ret_cert = it_map->second.find(at_this_time);
+    return true;
+  }
+
+  uint64_t getVersion() {
+    std::lock_guard<std::mutex> lock(m_index_mutex);
+    return m_version;
+  }
+
+  // a history loaded before any invalidation since `version` is discarded
+  void insert(const std::string &user_id_b64, CertificateHistory &&history,
+              uint64_t version) {
+    std::lock_guard<std::mutex> lock(m_index_mutex);
+    if (version != m_version)
+      return;
+    m_histories[user_id_b64] = std::move(history);
+  }
+
+  void invalidate(const std::string &user_id_b64) {
+    std::lock_guard<std::mutex> lock(m_index_mutex);
+    ++m_version;
+    m_histories.erase(user_id_b64);
+  }
+
+  void invalidateAll() {
+    std::lock_guard<std::mutex> lock(m_index_mutex);
+    ++m_version;
+    m_histories.clear();
+  }
+};
+
+} // namespace gruut
+
+#endif // GRUUT_ENTERPRISE_MERGER_CERTIFICATE_INDEX_HPP
@@ -4,6 +4,7 @@
 #include "../services/setting.hpp"
 #include "../services/storage.hpp"
 #include "../utils/safe.hpp"
+#include "certificate_index.hpp"
 #include "ledger.hpp"
 
 #include "easy_logging.hpp"
@@ -26,6 +27,7 @@
 
 #include <chrono>
 #include <iostream>
+#include <mutex>
 #include <vector>
 
 namespace gruut {
@@ -39,56 +41,38 @@ public:
     setPrefix("C");
     el::Loggers::getLogger("CERT");
     loadCACert();
+    watchLedger();
   }
 
   bool isValidTx(const Transaction &tx) override { return true; }
 
-  bool procBlock(const json &txs_json, const std::string &block_id_b64,
-                 const block_layer_t &block_layer) override {
-    if (!txs_json.is_array())
-      return false;
+  std::vector<TransactionType> getTxTypes() const override {
+    return {TransactionType::CERTIFICATES};
+  }
 
-    blockToLedger(txs_json, block_id_b64, block_layer);
+  using Ledger::procBlock;
+
+  bool procBlock(const tx_views_t &tx_views, const std::string &block_id_b64,
+                 const block_layer_t &block_layer) override {
+    blockToLedger(tx_views, block_id_b64, block_layer);
 
     return true;
   }
 
   std::string getCertificate(const std::string &user_id_b64,
                              const timestamp_t &at_this_time = 0) {
+    auto cert_index = CertificateIndex::getInstance();
+
     std::string ret_cert;
-    std::string cert_size = readLedgerByKey(user_id_b64);
+    if (cert_index->find(user_id_b64, at_this_time, ret_cert))
+      return ret_cert;
 
-    if (!cert_size.empty()) {
-      int num_certs = stoi(cert_size);
-      if (at_this_time == 0) {
-        std::string latest_cert =
-            readLedgerByKey(user_id_b64 + "_" + to_string(num_certs - 1));
-
-        json latest_cert_json = Safe::parseJsonAsArray(latest_cert);
-        if (!latest_cert_json.empty())
-          ret_cert = Safe::getString(latest_cert_json, 2);
-      } else {
-
-        timestamp_t lastest_valid_begin = 0;
-        for (int i = 0; i < num_certs; ++i) {
-          std::string nth_cert =
-              readLedgerByKey(user_id_b64 + "_" + to_string(i));
-
-          json cert_json = Safe::parseJson(nth_cert);
-          if (cert_json.empty())
-            break;
-
-          auto valid_begin = Safe::getTime(Safe::getString(cert_json, 0));
-          auto valid_end = Safe::getTime(Safe::getString(cert_json, 1));
-          if (valid_begin < at_this_time && at_this_time < valid_end) {
-            if (lastest_valid_begin < valid_begin) {
-              lastest_valid_begin = valid_begin;
-              ret_cert = Safe::getString(cert_json, 2);
-            }
-          }
-        }
-      }
-    }
+    uint64_t index_version = cert_index->getVersion();
+
+    CertificateHistory cert_history = loadCertHistory(user_id_b64);
+    ret_cert = cert_history.find(at_this_time);
+
+    cert_index->insert(user_id_b64, std::move(cert_history), index_version);
 
     return ret_cert;
   }
@@ -100,38 +84,100 @@ public:
   }
 
 private:
-  void blockToLedger(const json &txs_json, const std::string &block_id_b64,
+  CertificateHistory loadCertHistory(const std::string &user_id_b64) {
+    CertificateHistory cert_history;
+    std::string cert_size = readLedgerByKey(user_id_b64);
+
+    if (cert_size.empty())
+      return cert_history;
+
+    int num_certs = stoi(cert_size);
+    std::vector<CertificateRecord> cert_records;
+    std::string latest_pem;
+
+    for (int i = 0; i < num_certs; ++i) {
+      std::string nth_cert = readLedgerByKey(user_id_b64 + "_" + to_string(i));
+
+      json cert_json = Safe::parseJson(nth_cert);
+      if (cert_json.empty())
+        break;
+
+      cert_records.emplace_back(Safe::getTime(Safe::getString(cert_json, 0)),
+                                Safe::getTime(Safe::getString(cert_json, 1)),
+                                Safe::getString(cert_json, 2));
+    }
+
+    if (cert_records.size() == static_cast<size_t>(num_certs)) {
+      latest_pem = cert_records.back().pem;
+    } else {
+      json latest_cert_json = Safe::parseJsonAsArray(
+          readLedgerByKey(user_id_b64 + "_" + to_string(num_certs - 1)));
+      if (!latest_cert_json.empty())
+        latest_pem = Safe::getString(latest_cert_json, 2);
+    }
+
+    cert_history.build(std::move(cert_records), std::move(latest_pem));
+    return cert_history;
+  }
+
+  // keeps the shared certificate index in line with the visible ledger
+  void watchLedger() {
+    static std::once_flag watch_flag;
+    std::string prefix = m_prefix;
+    std::call_once(watch_flag, [this, prefix]() {
+      m_layered_storage->addListener(
+          [prefix](const std::vector<std::string> &keys, bool is_all) {
+            auto cert_index = CertificateIndex::getInstance();
+            if (is_all) {
+              cert_index->invalidateAll();
+              return;
+            }
+
+            for (auto &each_key : keys) {
+              if (each_key.compare(0, prefix.size(), prefix) != 0)
+                continue;
+              // key = prefix + user_id_b64 [+ "_" + cert_idx]
+              cert_index->invalidate(
+                  each_key.substr(prefix.size(),
+                                  each_key.find('_') - prefix.size()));
+            }
+          });
+    });
+  }
+
+  void blockToLedger(const tx_views_t &tx_views,
+                     const std::string &block_id_b64,
                      const block_layer_t &block_layer) {
 
-    if (txs_json.is_array()) {
+    std::string key, value;
 
-      std::string key, value;
+    for (auto &tx_view : tx_views) {
+      if (tx_view.type != TransactionType::CERTIFICATES)
+        continue;
 
-      for (auto &tx_json : txs_json) {
-        if (Safe::getString(tx_json, "type") != TXTYPE_CERTIFICATES)
-          continue;
+      auto &content = *tx_view.contents;
 
-        auto &content = tx_json["content"];
-        if (!content.is_array())
-          continue;
+      for (size_t c_idx = 0; c_idx < content.size(); c_idx += 2) {
+        const string &user_id_b64 = content[c_idx];
+        string cert_idx = readLedgerByKeyOnLayer(user_id_b64, block_layer);
+
+        CertificateIndex::getInstance()->invalidate(user_id_b64);
 
-        for (size_t c_idx = 0; c_idx < content.size(); c_idx += 2) {
-          string user_id_b64 = Safe::getString(content, c_idx);
-          string cert_idx = readLedgerByKeyOnLayer(user_id_b64, block_layer);
+        key = user_id_b64;
+        value = (cert_idx.empty()) ? "1" : to_string(stoi(cert_idx) + 1);
 
-          key = user_id_b64;
-          value = (cert_idx.empty()) ? "1" : to_string(stoi(cert_idx) + 1);
+        saveLedger(key, value, block_id_b64);
 
-          saveLedger(key, value, block_id_b64);
+        key += (cert_idx.empty()) ? "_0" : "_" + cert_idx;
+        if (c_idx + 1 == content.size())
+          continue;
 
-          key += (cert_idx.empty()) ? "_0" : "_" + cert_idx;
-          value = parseCert(Safe::getString(content, c_idx + 1));
+        value = parseCert(content[c_idx + 1]);
 
-          if (value.empty())
-            continue;
+        if (value.empty())
+          continue;
 
-          saveLedger(key, value, block_id_b64);
-        }
+        saveLedger(key, value, block_id_b64);
       }
     }
   }
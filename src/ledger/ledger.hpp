@@ -5,10 +5,13 @@
 #include "nlohmann/json.hpp"
 
 #include "../chain/mem_ledger.hpp"
+#include "../chain/transaction.hpp"
 #include "../chain/types.hpp"
 #include "../services/layered_storage.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 namespace gruut {
 
@@ -24,9 +27,45 @@ public:
   };
 
   virtual bool isValidTx(const Transaction &tx) = 0;
-  virtual bool procBlock(const json &txs_json, const std::string &block_id_b64,
+
+  // tx_views holds only the transactions of the types in getTxTypes()
+  virtual bool procBlock(const tx_views_t &tx_views,
+                         const std::string &block_id_b64,
                          const block_layer_t &block_layer) = 0;
 
+  virtual std::vector<TransactionType> getTxTypes() const = 0;
+
+  // adapter for callers holding transactions in JSON
+  bool procBlock(const json &txs_json, const std::string &block_id_b64,
+                 const block_layer_t &block_layer) {
+    if (!txs_json.is_array())
+      return false;
+
+    std::vector<TransactionType> tx_types = getTxTypes();
+    std::vector<Transaction> txs;
+    txs.reserve(txs_json.size());
+    for (auto &each_tx_json : txs_json) {
+      Transaction each_tx;
+      json tx_json = each_tx_json;
+      if (!each_tx.setJson(tx_json))
+        continue;
+      if (std::find(tx_types.begin(), tx_types.end(),
+                    each_tx.getTransactionType()) == tx_types.end())
+        continue;
+      txs.emplace_back(std::move(each_tx));
+    }
+
+    tx_views_t tx_views;
+    tx_views.reserve(txs.size());
+    for (auto &each_tx : txs)
+      tx_views.emplace_back(each_tx.getView());
+
+    return procBlock(tx_views, block_id_b64, block_layer);
+  }
+
+  // every key written by this ledger starts with this prefix
+  const std::string &getPrefix() const { return m_prefix; }
+
 protected:
   void setPrefix(std::string prefix) { m_prefix = std::move(prefix); }
 
@@ -11,7 +11,13 @@ public:
 
   bool isValidTx(const Transaction &tx) override { return true; }
 
-  bool procBlock(const json &txs_json, const std::string &block_id_b64,
+  std::vector<TransactionType> getTxTypes() const override {
+    return {TransactionType::IMMORTALSMS};
+  }
+
+  using Ledger::procBlock;
+
+  bool procBlock(const tx_views_t &tx_views, const std::string &block_id_b64,
                  const block_layer_t &block_layer) override {
     return true;
   }
@@ -1,10 +1,13 @@
 #include "block_processor.hpp"
 #include "../../application.hpp"
+#include "../communication/manage_connection.hpp"
 #include "easy_logging.hpp"
 
 namespace gruut {
 
-BlockProcessor::BlockProcessor() {
+BlockProcessor::BlockProcessor()
+    : m_verify_queue(config::BLOCK_PIPELINE_QUEUE_SIZE),
+      m_link_buffer(config::BLOCK_PIPELINE_MAX_IN_FLIGHT), m_persist_queue(1) {
   m_storage = Storage::getInstance();
   m_layered_storage = LayeredStorage::getInstance();
 
@@ -13,7 +16,8 @@ BlockProcessor::BlockProcessor() {
   m_my_chain_id_b64 = TypeConverter::encodeBase64(setting->getLocalChainId());
 
   auto &io_service = Application::app().getIoService();
-  m_task_scheduler.setIoService(io_service);
+  m_request_timer.reset(new boost::asio::deadline_timer(io_service));
+  m_chain_info_scheduler.setIoService(io_service);
 
   m_get_cert_func = [this](id_type &id) {
     return CertificatePool::getInstance()->getCert(id);
@@ -28,7 +32,39 @@ BlockProcessor::BlockProcessor() {
   el::Loggers::getLogger("BPRO");
 }
 
+BlockProcessor::BlockProcessor(Storage *storage)
+    : m_storage(storage), m_layered_storage(nullptr),
+      m_unresolved_block_pool(storage,
+                              [](const Block &, const block_layer_t &) {}),
+      m_verify_queue(config::BLOCK_PIPELINE_QUEUE_SIZE),
+      m_link_buffer(config::BLOCK_PIPELINE_MAX_IN_FLIGHT), m_persist_queue(1) {
+  auto setting = Setting::getInstance();
+  m_my_id_b64 = TypeConverter::encodeBase64(setting->getMyId());
+  m_my_chain_id_b64 = TypeConverter::encodeBase64(setting->getLocalChainId());
+
+  m_request_timer.reset(
+      new boost::asio::deadline_timer(Application::app().getIoService()));
+
+  m_get_cert_func = [](id_type &id) {
+    return CertificatePool::getInstance()->getCert(id);
+  };
+
+  el::Loggers::getLogger("BPRO");
+}
+
+BlockProcessor::~BlockProcessor() {
+  {
+    std::lock_guard<std::mutex> guard(m_request_mutex);
+    m_request_timer->cancel();
+  }
+  stopPipeline();
+}
+
 void BlockProcessor::start() {
+  auto start_time = std::chrono::steady_clock::now();
+
+  recoverLedger();
+
   auto last_block_info = m_storage->getNthBlockLinkInfo();
 
   m_unresolved_block_pool.setPool(
@@ -37,23 +73,93 @@ void BlockProcessor::start() {
 
   m_unresolved_block_pool.restorePool();
 
-  m_task_scheduler.setTaskFunction([this]() { requestMissingBlock(); });
-  m_task_scheduler.setInterval(config::BROC_PROC_REQUEST_MISSING_INTERVAL);
-  m_task_scheduler.setStrandMod();
-  m_task_scheduler.runTask();
+  auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start_time);
+  CLOG(INFO, "BPRO") << "Restarted at height " << last_block_info.height
+                     << " (" << elapsed_ms.count() << "ms)";
+
+  startPipeline();
+
+  m_chain_info_scheduler.setInterval(config::CHAIN_INFO_INTERVAL);
+  m_chain_info_scheduler.setTaskFunction([this]() { sendChainInfoIf(); });
+  m_chain_info_scheduler.runTask();
 }
 
-void BlockProcessor::requestMissingBlock() {
-  timestamp_t current_time = Time::now_int();
+void BlockProcessor::endBootstrap() {
+  m_is_bootstrapped = true;
+  m_chain_info_dirty = true;
+}
+
+// the latest tip, if any block has been linked since the last one
+void BlockProcessor::sendChainInfoIf() {
+  if (!m_is_bootstrapped || !m_chain_info_dirty.exchange(false))
+    return;
+
+  auto possible_link = getMostPossibleLink();
+
+  OutputMsgEntry msg_chain_info;
+  msg_chain_info.type = MessageType::MSG_CHAIN_INFO;
+  msg_chain_info.body["msgID"] = to_string((int)MessageType::MSG_CHAIN_INFO);
+  msg_chain_info.body["mID"] = m_my_id_b64;
+  msg_chain_info.body["cID"] = m_my_chain_id_b64;
+  msg_chain_info.body["time"] = to_string(possible_link.time);
+  msg_chain_info.body["hgt"] = to_string(possible_link.height);
+  msg_chain_info.body["bID"] = TypeConverter::encodeBase64(possible_link.id);
+  msg_chain_info.body["prevbID"] =
+      TypeConverter::encodeBase64(possible_link.prev_id);
+  msg_chain_info.body["hash"] = TypeConverter::encodeBase64(possible_link.hash);
+  msg_chain_info.body["prevHash"] =
+      TypeConverter::encodeBase64(possible_link.prev_hash);
+  msg_chain_info.body["mSig"] = "";
+
+  m_msg_proxy.deliverOutputMessage(msg_chain_info);
+}
+
+// a new gap is asked for right away; retries follow the deadline queue
+void BlockProcessor::addBlockRequest(BlockRequest &new_request) {
+  {
+    std::lock_guard<std::mutex> guard(m_request_mutex);
+
+    for (auto &each_request : m_requests) {
+      if (each_request.second.height == new_request.height &&
+          each_request.second.prev_hash_b64 == new_request.prev_hash_b64)
+        return;
+    }
+
+    new_request.found_time = pipeline_clock::now();
+    new_request.deadline = new_request.found_time;
+    new_request.num_retry = 0;
+
+    uint64_t request_seq = m_next_request_seq++;
+    m_requests.emplace(request_seq, new_request);
+    m_request_deadlines.emplace(new_request.deadline, request_seq);
+  }
+
+  sendDueBlockRequests();
+}
+
+void BlockProcessor::sendDueBlockRequests() {
   std::vector<BlockRequest> request_this_time;
+  {
+    std::lock_guard<std::mutex> guard(m_request_mutex);
+    auto current_time = pipeline_clock::now();
+
+    while (!m_request_deadlines.empty() &&
+           m_request_deadlines.begin()->first <= current_time) {
+      auto deadline = m_request_deadlines.begin()->first;
+      uint64_t request_seq = m_request_deadlines.begin()->second;
+      m_request_deadlines.erase(m_request_deadlines.begin());
+
+      auto it_map = m_requests.find(request_seq);
+      if (it_map == m_requests.end() || it_map->second.deadline != deadline)
+        continue; // filled or rescheduled
 
-  std::lock_guard<std::recursive_mutex> guard(m_request_mutex);
+      BlockRequest &each_request = it_map->second;
 
-  for (auto &each_request : m_request_list) {
-    if (current_time > each_request.request_time &&
-        current_time >
-            config::BROC_PROCESSOR_REQ_WAIT + each_request.request_time) {
-      each_request.request_time = current_time;
+      // the last receiver did not answer in time
+      if (each_request.num_retry > 0)
+        ++m_request_rtts[TypeConverter::encodeBase64(each_request.recv_id)]
+              .backoff;
 
       if (each_request.num_retry <= config::MAX_UNICAST_MISSING_BLOCK &&
           each_request.recv_id != m_last_block_sender)
@@ -65,37 +171,142 @@ void BlockProcessor::requestMissingBlock() {
 
       ++each_request.num_retry;
 
+      auto &request_rtt =
+          m_request_rtts[TypeConverter::encodeBase64(each_request.recv_id)];
+      each_request.sent_time = current_time;
+      each_request.deadline =
+          current_time + std::chrono::milliseconds(request_rtt.getTimeoutMs());
+      m_request_deadlines.emplace(each_request.deadline, request_seq);
+
       request_this_time.emplace_back(each_request);
     }
+
+    armRequestTimer();
   }
 
-  m_request_mutex.unlock();
+  for (auto &each_request : request_this_time)
+    sendBlockRequest(each_request);
+}
 
-  for (auto &each_request : request_this_time) {
+// wakes up at the earliest deadline; callers hold m_request_mutex
+void BlockProcessor::armRequestTimer() {
+  if (m_request_deadlines.empty())
+    return;
+
+  auto wait_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     m_request_deadlines.begin()->first - pipeline_clock::now())
+                     .count();
+
+  m_request_timer->expires_from_now(
+      boost::posix_time::milliseconds(std::max<int64_t>(wait_ms, 0)));
+  m_request_timer->async_wait([this](const boost::system::error_code &error) {
+    if (error == boost::asio::error::operation_aborted)
+      return;
+    sendDueBlockRequests();
+  });
+}
 
-    OutputMsgEntry msg_req_block;
+void BlockProcessor::sendBlockRequest(const BlockRequest &request) {
+  OutputMsgEntry msg_req_block;
 
-    msg_req_block.type = MessageType::MSG_REQ_BLOCK;
-    msg_req_block.body["mID"] = m_my_id_b64; // my_id
-    msg_req_block.body["time"] = to_string(current_time);
+  // a range reply is too big to flood, so broadcasts stay single-block
+  if (request.to_height > request.height && !request.recv_id.empty()) {
+    msg_req_block.type = MessageType::MSG_REQ_BLOCK_RANGE;
+    msg_req_block.body["mID"] = m_my_id_b64;
+    msg_req_block.body["time"] = Time::now();
     msg_req_block.body["mCert"] = "";
-    msg_req_block.body["hgt"] = to_string(each_request.height);
-    msg_req_block.body["prevHash"] = each_request.prev_hash_b64;
-    msg_req_block.body["hash"] = each_request.hash_b64;
+    msg_req_block.body["from"] = to_string(request.height);
+    msg_req_block.body["to"] = to_string(request.to_height);
+    msg_req_block.body["maxBytes"] = to_string(config::MAX_BLOCK_RANGE_BYTES);
     msg_req_block.body["mSig"] = "";
+    msg_req_block.receivers = {request.recv_id};
 
-    if (each_request.recv_id.empty())
-      msg_req_block.receivers = {};
-    else
-      msg_req_block.receivers = {each_request.recv_id};
-
-    CLOG(INFO, "BPRO") << "send MSG_REQ_BLOCK (height=" << each_request.height
-                       << ",prevHash=" << each_request.prev_hash_b64 << ")";
+    CLOG(INFO, "BPRO") << "send MSG_REQ_BLOCK_RANGE (" << request.height << "-"
+                       << request.to_height << ",#try=" << request.num_retry
+                       << ")";
 
     m_msg_proxy.deliverOutputMessage(msg_req_block);
+    return;
+  }
+
+  msg_req_block.type = MessageType::MSG_REQ_BLOCK;
+  msg_req_block.body["mID"] = m_my_id_b64; // my_id
+  msg_req_block.body["time"] = Time::now();
+  msg_req_block.body["mCert"] = "";
+  msg_req_block.body["hgt"] = to_string(request.height);
+  msg_req_block.body["prevHash"] = request.prev_hash_b64;
+  msg_req_block.body["hash"] = request.hash_b64;
+  msg_req_block.body["mSig"] = "";
+
+  if (request.recv_id.empty())
+    msg_req_block.receivers = {};
+  else
+    msg_req_block.receivers = {request.recv_id};
+
+  CLOG(INFO, "BPRO") << "send MSG_REQ_BLOCK (height=" << request.height
+                     << ",prevHash=" << request.prev_hash_b64
+                     << ",#try=" << request.num_retry << ")";
+
+  m_msg_proxy.deliverOutputMessage(msg_req_block);
+}
+
+// drops the requests the block answers; a reply to a request sent only once
+// is an unambiguous round-trip sample (Karn's rule)
+void BlockProcessor::completeBlockRequests(const Block &block) {
+  std::lock_guard<std::mutex> guard(m_request_mutex);
+  auto current_time = pipeline_clock::now();
+
+  auto it_map = m_requests.begin();
+  while (it_map != m_requests.end()) {
+    BlockRequest &each_request = it_map->second;
+    if (each_request.height != block.getHeight() ||
+        (!each_request.hash_b64.empty() &&
+         each_request.hash_b64 != block.getHashB64()) ||
+        (!each_request.prev_hash_b64.empty() &&
+         each_request.prev_hash_b64 != block.getPrevHashB64())) {
+      ++it_map;
+      continue;
+    }
+
+    if (each_request.num_retry == 1) {
+      m_request_rtts[TypeConverter::encodeBase64(each_request.recv_id)]
+          .addSample(std::chrono::duration_cast<std::chrono::microseconds>(
+                         current_time - each_request.sent_time)
+                         .count() /
+                     1000.0);
+    }
+
+    uint64_t fill_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           current_time - each_request.found_time)
+                           .count();
+    m_gap_fill_ms.emplace_back(fill_ms);
+    if (m_gap_fill_ms.size() > config::GAP_FILL_STAT_WINDOW)
+      m_gap_fill_ms.pop_front();
+
+    CLOG(INFO, "BPRO") << "Gap at " << each_request.height << " filled in "
+                       << fill_ms << "ms (#try=" << each_request.num_retry
+                       << ")";
+
+    it_map = m_requests.erase(it_map);
   }
 }
 
+// over the last GAP_FILL_STAT_WINDOW filled gaps
+uint64_t BlockProcessor::getMedianGapFillMs() {
+  std::vector<uint64_t> samples;
+  {
+    std::lock_guard<std::mutex> guard(m_request_mutex);
+    samples.assign(m_gap_fill_ms.begin(), m_gap_fill_ms.end());
+  }
+
+  if (samples.empty())
+    return 0;
+
+  auto it_median = samples.begin() + samples.size() / 2;
+  std::nth_element(samples.begin(), it_median, samples.end());
+  return *it_median;
+}
+
 block_layer_t BlockProcessor::getBlockLayer(const std::string &block_id_b64) {
   return m_unresolved_block_pool.getBlockLayer(block_id_b64);
 }
@@ -114,7 +325,13 @@ void BlockProcessor::handleMessage(InputMsgEntry &entry) {
     handleMsgReqBlock(entry);
     break;
   case MessageType::MSG_BLOCK:
-    handleMsgBlock(entry);
+    ingestBlock(entry);
+    break;
+  case MessageType::MSG_REQ_BLOCK_RANGE:
+    handleMsgReqBlockRange(entry);
+    break;
+  case MessageType::MSG_BLOCK_RANGE:
+    handleMsgBlockRange(entry);
     break;
   case MessageType::MSG_REQ_CHECK:
     handleMsgReqCheck(entry);
@@ -173,7 +390,7 @@ void BlockProcessor::handleMsgReqBlock(InputMsgEntry &entry) {
   }
 
   bool found_block = false;
-  Block ret_block;
+  std::shared_ptr<const Block> ret_block;
   if (m_unresolved_block_pool.getBlock(req_block_height, req_prev_hash,
                                        req_hash, ret_block)) {
     found_block = true;
@@ -184,8 +401,10 @@ void BlockProcessor::handleMsgReqBlock(InputMsgEntry &entry) {
     if (saved_block.height > 0 &&
         (req_prev_hash.empty() || saved_block.prev_hash == req_prev_hash) &&
         (req_hash.empty() || saved_block.hash == req_hash)) {
+      auto stored_block = std::make_shared<Block>();
+      stored_block->initialize(saved_block);
+      ret_block = std::move(stored_block);
       found_block = true;
-      ret_block.initialize(saved_block);
     }
 
     if (!found_block) {
@@ -204,16 +423,96 @@ void BlockProcessor::handleMsgReqBlock(InputMsgEntry &entry) {
   msg_block.type = MessageType::MSG_BLOCK;
   msg_block.body["mID"] = m_my_id_b64;
   msg_block.body["blockraw"] =
-      TypeConverter::encodeBase64(ret_block.getBlockRaw());
-  msg_block.body["tx"] = ret_block.getBlockBodyJson()["tx"];
+      TypeConverter::encodeBase64(ret_block->getBlockRaw());
+  msg_block.body["tx"] = ret_block->getBlockBodyJson()["tx"];
   msg_block.receivers = {sender_id};
 
-  CLOG(INFO, "BPRO") << "Send MSG_BLOCK (height=" << ret_block.getHeight()
-                     << ",#tx=" << ret_block.getNumTransactions() << ")";
+  CLOG(INFO, "BPRO") << "Send MSG_BLOCK (height=" << ret_block->getHeight()
+                     << ",#tx=" << ret_block->getNumTransactions() << ")";
 
   m_msg_proxy.deliverOutputMessage(msg_block);
 }
 
+void BlockProcessor::handleMsgReqBlockRange(InputMsgEntry &entry) {
+  id_type sender_id = Safe::getBytesFromB64<id_type>(entry.body, "mID");
+
+  block_height_type from_height = Safe::getInt(entry.body, "from");
+  block_height_type to_height = Safe::getInt(entry.body, "to");
+  bool header_only = (Safe::getString(entry.body, "hdr") == "1");
+  size_t max_bytes = Safe::getSize(entry.body, "maxBytes");
+  if (max_bytes == 0 || max_bytes > config::MAX_BLOCK_RANGE_BYTES)
+    max_bytes = config::MAX_BLOCK_RANGE_BYTES;
+
+  if (from_height == 0 || to_height < from_height) {
+    sendErrorMessage(ErrorMsgType::NO_SUCH_BLOCK, sender_id);
+    return;
+  }
+
+  size_t max_range_size = header_only ? config::MAX_HEADER_RANGE_SIZE
+                                      : config::MAX_BLOCK_RANGE_SIZE;
+  to_height = std::min<block_height_type>(to_height,
+                                          from_height + max_range_size - 1);
+
+  std::vector<storage_block_type> saved_blocks = m_storage->readBlockRange(
+      from_height, to_height, max_bytes, !header_only);
+  if (saved_blocks.empty()) {
+    CLOG(ERROR, "BPRO") << "No such block range (" << from_height << "-"
+                        << to_height << ")";
+    sendErrorMessage(ErrorMsgType::NO_SUCH_BLOCK, sender_id);
+    return;
+  }
+
+  json blocks_json = json::array();
+  for (auto &each_block : saved_blocks) {
+    blocks_json.push_back(
+        json({{"blockraw", TypeConverter::encodeBase64(each_block.block_raw)},
+              {"tx", std::move(each_block.txs)}}));
+  }
+
+  OutputMsgEntry msg_block_range;
+  msg_block_range.type = MessageType::MSG_BLOCK_RANGE;
+  msg_block_range.body["mID"] = m_my_id_b64;
+  msg_block_range.body["time"] = Time::now();
+  msg_block_range.body["from"] = to_string(from_height);
+  msg_block_range.body["to"] = to_string(saved_blocks.back().height);
+  msg_block_range.body["hdr"] = header_only ? "1" : "0";
+  msg_block_range.body["blocks"] = std::move(blocks_json);
+  msg_block_range.receivers = {sender_id};
+
+  CLOG(INFO, "BPRO") << "Send MSG_BLOCK_RANGE (" << from_height << "-"
+                     << saved_blocks.back().height << ")";
+
+  m_msg_proxy.deliverOutputMessage(msg_block_range);
+}
+
+// the blocks of a MSG_BLOCK_RANGE as MSG_BLOCKs, which then take the usual
+// path; none for a range of headers, which are only of use to the block
+// synchronizer
+std::vector<InputMsgEntry>
+BlockProcessor::unpackBlockRange(InputMsgEntry &entry) {
+  std::vector<InputMsgEntry> block_entries;
+  if (Safe::getString(entry.body, "hdr") == "1" ||
+      !entry.body["blocks"].is_array())
+    return block_entries;
+
+  std::string sender_id_b64 = Safe::getString(entry.body, "mID");
+
+  for (auto &each_block : entry.body["blocks"]) {
+    InputMsgEntry block_entry;
+    block_entry.type = MessageType::MSG_BLOCK;
+    block_entry.body = std::move(each_block);
+    block_entry.body["mID"] = sender_id_b64;
+    block_entries.emplace_back(std::move(block_entry));
+  }
+
+  return block_entries;
+}
+
+void BlockProcessor::handleMsgBlockRange(InputMsgEntry &entry) {
+  for (auto &block_entry : unpackBlockRange(entry))
+    ingestBlock(block_entry);
+}
+
 void BlockProcessor::handleMsgRequestHeader(InputMsgEntry &entry) {
   auto sender_id = Safe::getBytesFromB64<id_type>(entry.body, "rID");
 
@@ -226,7 +525,7 @@ void BlockProcessor::handleMsgRequestHeader(InputMsgEntry &entry) {
   block_height_type req_block_height = Safe::getInt(entry.body, "hgt");
 
   bool found_block = false;
-  Block ret_block;
+  std::shared_ptr<const Block> ret_block;
   if (m_unresolved_block_pool.getBlock(req_block_height, ret_block)) {
     found_block = true;
   }
@@ -234,8 +533,10 @@ void BlockProcessor::handleMsgRequestHeader(InputMsgEntry &entry) {
   if (!found_block) { // no block in unresolved block pool, then try storage
     storage_block_type saved_block = m_storage->readBlock(req_block_height);
     if (saved_block.height > 0) {
+      auto stored_block = std::make_shared<Block>();
+      stored_block->initialize(saved_block);
+      ret_block = std::move(stored_block);
       found_block = true;
-      ret_block.initialize(saved_block);
     }
   }
 
@@ -247,35 +548,193 @@ void BlockProcessor::handleMsgRequestHeader(InputMsgEntry &entry) {
 
   OutputMsgEntry msg_header_msg;
   msg_header_msg.type = MessageType::MSG_HEADER;
-  msg_header_msg.body["blockraw"] = ret_block.getBlockHeaderJson();
+  msg_header_msg.body["blockraw"] = ret_block->getBlockHeaderJson();
   msg_header_msg.receivers = std::vector<id_type>{};
 
-  CLOG(INFO, "BPRO") << "Send MSG_HEADER (height=" << ret_block.getHeight()
-                     << ",#tx=" << ret_block.getNumTransactions() << ")";
+  CLOG(INFO, "BPRO") << "Send MSG_HEADER (height=" << ret_block->getHeight()
+                     << ",#tx=" << ret_block->getNumTransactions() << ")";
 
   m_msg_proxy.deliverOutputMessage(msg_header_msg);
 }
 
 unblk_push_result_type BlockProcessor::handleMsgBlock(InputMsgEntry &entry) {
-
   unblk_push_result_type ret_result;
   ret_result.height = 0;
   ret_result.linked = false;
   ret_result.duplicated = false;
   ret_result.block_layer = {};
 
-  Block recv_block;
-  if (!recv_block.initialize(entry.body)) {
-    CLOG(ERROR, "BPRO") << "Block dropped (missing information)";
+  auto recv_block = decodeBlock(entry);
+  if (!recv_block)
     return ret_result;
+
+  std::lock_guard<std::mutex> guard(m_link_mutex);
+  return linkBlock(std::move(recv_block), entry);
+}
+
+void BlockProcessor::startPipeline() {
+  if (m_pipeline_running)
+    return;
+
+  m_pipeline_running = true;
+
+  size_t num_verifiers = std::min<size_t>(
+      config::MAX_BLOCK_VERIFIER,
+      std::max<size_t>(1, std::thread::hardware_concurrency()));
+  for (size_t i = 0; i < num_verifiers; ++i)
+    m_pipeline_threads.emplace_back([this]() { verifyLoop(); });
+
+  m_pipeline_threads.emplace_back([this]() { linkLoop(); });
+  m_pipeline_threads.emplace_back([this]() { persistLoop(); });
+
+  CLOG(INFO, "BPRO") << "Block pipeline started (#verifier=" << num_verifiers
+                     << ")";
+}
+
+void BlockProcessor::stopPipeline() {
+  if (!m_pipeline_running.exchange(false))
+    return;
+
+  m_verify_queue.close();
+  m_link_buffer.close();
+  m_persist_queue.close();
+
+  for (auto &each_thread : m_pipeline_threads) {
+    if (each_thread.joinable())
+      each_thread.join();
+  }
+  m_pipeline_threads.clear();
+}
+
+// called from io_service threads; blocks only while the pipeline already
+// holds BLOCK_PIPELINE_MAX_IN_FLIGHT blocks or the verify queue is full
+void BlockProcessor::ingestBlock(InputMsgEntry &entry) {
+  if (!m_pipeline_running) {
+    handleMsgBlock(entry);
+    return;
+  }
+
+  BlockPipelineJob job;
+  if (!m_link_buffer.acquire(job.seq)) {
+    CLOG(ERROR, "BPRO") << "Block dropped (pipeline stopped)";
+    return;
+  }
+  job.entry = std::move(entry);
+  job.stage_begin = pipeline_clock::now();
+
+  if (!m_verify_queue.push(std::move(job)))
+    CLOG(ERROR, "BPRO") << "Block dropped (pipeline stopped)";
+}
+
+void BlockProcessor::verifyLoop() {
+  BlockPipelineJob job;
+  while (m_verify_queue.pop(job)) {
+    job.block = decodeBlock(job.entry);
+    m_verify_meter.record(job.stage_begin);
+    job.stage_begin = pipeline_clock::now();
+
+    uint64_t seq = job.seq;
+    m_link_buffer.put(seq, std::move(job));
+  }
+}
+
+// links verified blocks strictly in the order they were ingested
+void BlockProcessor::linkLoop() {
+  while (true) {
+    BlockPipelineJob job;
+    if (!m_link_buffer.popNext(job))
+      return;
+
+    if (job.block) {
+      std::lock_guard<std::mutex> guard(m_link_mutex);
+      linkBlock(std::move(job.block), job.entry);
+    }
+    m_link_buffer.release();
+    m_link_meter.record(job.stage_begin);
+
+    if (job.seq % config::BLOCK_PIPELINE_STAT_INTERVAL ==
+        config::BLOCK_PIPELINE_STAT_INTERVAL - 1)
+      logPipelineStats();
+  }
+}
+
+void BlockProcessor::persistLoop() {
+  pipeline_clock::time_point requested_time;
+  while (m_persist_queue.pop(requested_time)) {
+    procResolvedBlocksIf();
+    m_persist_meter.record(requested_time);
+  }
+}
+
+// One pending request covers every block linked before it is taken, so a
+// full queue means the blocks just linked will be persisted anyway.
+void BlockProcessor::requestPersist() {
+  if (!m_pipeline_running) {
+    procResolvedBlocksIf();
+    return;
+  }
+
+  m_persist_queue.tryPush(pipeline_clock::now());
+}
+
+std::vector<PipelineStageStat> BlockProcessor::getPipelineStats() {
+  return {m_verify_meter.getStat("verify", m_verify_queue.size()),
+          m_link_meter.getStat("link", m_link_buffer.size()),
+          m_persist_meter.getStat("persist", m_persist_queue.size())};
+}
+
+void BlockProcessor::logPipelineStats() {
+  for (auto &each_stat : getPipelineStats()) {
+    CLOG(INFO, "BPRO") << "Pipeline [" << each_stat.name
+                       << "] depth=" << each_stat.depth
+                       << ",#done=" << each_stat.num_processed
+                       << ",avg=" << each_stat.avg_latency_us
+                       << "us,max=" << each_stat.max_latency_us << "us";
+  }
+
+  CLOG(INFO, "BPRO") << "Gap fill median=" << getMedianGapFillMs() << "ms";
+  // MSG_CHAIN_INFO adds at most one post per CHAIN_INFO_INTERVAL
+  CLOG(INFO, "BPRO") << "Tracker posts="
+                     << ConnManager::getInstance()->getNumTrackerPosts();
+
+  auto scrub_stat = Application::app().getBlockScrubber().getScrubStat();
+  CLOG(INFO, "BPRO") << "Block scrub height=" << scrub_stat.scrub_height
+                     << ",#pass=" << scrub_stat.num_passes
+                     << ",#block=" << scrub_stat.num_blocks
+                     << ",#bad=" << scrub_stat.num_bad_blocks
+                     << ",last bad=" << scrub_stat.last_bad_height;
+}
+
+// for blocks already checked by decodeBlock(), e.g., by the block synchronizer
+unblk_push_result_type
+BlockProcessor::pushVerifiedBlock(std::shared_ptr<const Block> block,
+                                  InputMsgEntry &entry) {
+  std::lock_guard<std::mutex> guard(m_link_mutex);
+  return linkBlock(std::move(block), entry);
+}
+
+// decode and stateless verification; safe to run concurrently
+std::shared_ptr<const Block> BlockProcessor::decodeBlock(InputMsgEntry &entry) {
+  auto recv_block = std::make_shared<Block>();
+  if (!recv_block->initialize(entry.body)) {
+    CLOG(ERROR, "BPRO") << "Block dropped (missing information)";
+    return nullptr;
   }
 
-  if (!recv_block.isValidEarly(m_get_cert_func)) {
+  if (!recv_block->isValidEarly(m_get_cert_func)) {
     CLOG(ERROR, "BPRO") << "Block dropped (invalid - early stage validation)";
-    return ret_result;
+    return nullptr;
   }
 
-  ret_result = m_unresolved_block_pool.push(recv_block);
+  return recv_block;
+}
+
+// pool push (which forwards the block to the ledgers) and bookkeeping;
+// callers hold m_link_mutex
+unblk_push_result_type
+BlockProcessor::linkBlock(std::shared_ptr<const Block> recv_block,
+                          InputMsgEntry &entry) {
+  unblk_push_result_type ret_result = m_unresolved_block_pool.push(recv_block);
 
   if (ret_result.height == 0) {
     CLOG(ERROR, "BPRO") << "Block dropped (unlinkable)";
@@ -288,51 +747,22 @@ unblk_push_result_type BlockProcessor::handleMsgBlock(InputMsgEntry &entry) {
     return ret_result;
   }
 
-  std::lock_guard<std::recursive_mutex> guard(m_request_mutex);
+  completeBlockRequests(*recv_block);
 
-  auto it = m_request_list.begin();
-  while (it != m_request_list.end()) {
-    if (it->height == recv_block.getHeight() &&
-        (it->hash_b64.empty() || it->hash_b64 == recv_block.getHashB64()) &&
-        (it->prev_hash_b64.empty() ||
-         it->prev_hash_b64 == recv_block.getPrevHashB64())) {
-      m_request_list.erase(it++);
-    } else {
-      it++;
-    }
+  // read by the block request timer under the same lock
+  auto block_sender = Safe::getBytesFromB64<merger_id_type>(entry.body, "mID");
+  {
+    std::lock_guard<std::mutex> guard(m_request_mutex);
+    m_last_block_sender = std::move(block_sender);
   }
 
-  m_request_mutex.unlock();
-
-  m_last_block_sender =
-      Safe::getBytesFromB64<merger_id_type>(entry.body, "mID");
-
   if (ret_result.linked) {
-    auto possible_link = getMostPossibleLink();
-
-    OutputMsgEntry msg_chain_info;
-    msg_chain_info.type = MessageType::MSG_CHAIN_INFO;
-    msg_chain_info.body["msgID"] = to_string((int)MessageType::MSG_CHAIN_INFO);
-    msg_chain_info.body["mID"] = m_my_id_b64;
-    msg_chain_info.body["cID"] = m_my_chain_id_b64;
-    msg_chain_info.body["time"] = to_string(possible_link.time);
-    msg_chain_info.body["hgt"] = to_string(possible_link.height);
-    msg_chain_info.body["bID"] = TypeConverter::encodeBase64(possible_link.id);
-    msg_chain_info.body["prevbID"] =
-        TypeConverter::encodeBase64(possible_link.prev_id);
-    msg_chain_info.body["hash"] =
-        TypeConverter::encodeBase64(possible_link.hash);
-    msg_chain_info.body["prevHash"] =
-        TypeConverter::encodeBase64(possible_link.prev_hash);
-    msg_chain_info.body["mSig"] = "";
-
-    m_msg_proxy.deliverOutputMessage(msg_chain_info);
-
-    procResolvedBlocksIf();
+    m_chain_info_dirty = true;
+    requestPersist();
   }
 
   Application::app().getTransactionPool().removeDuplicatedTransactions(
-      recv_block.getTxIds());
+      recv_block->getTxIds());
 
   tryResolveUnresolvedBlocksIf();
 
@@ -354,27 +784,106 @@ void BlockProcessor::procResolvedBlocksIf() {
 
     for (auto &each_block : resolved_blocks) {
 
-      if (!each_block.block.isValidLate(m_get_user_cert_func)) {
+      if (!each_block.block->isValidLate(m_get_user_cert_func)) {
         CLOG(ERROR, "BPRO")
             << "Block dropped (invalid - late stage validation)";
+        m_layered_storage->dropLedger(each_block.block->getBlockIdB64());
         continue;
       }
 
-      json block_header = each_block.block.getBlockHeaderJson();
-      bytes block_raw = each_block.block.getBlockRaw();
-      json block_body = each_block.block.getBlockBodyJson();
+      json block_header = each_block.block->getBlockHeaderJson();
+      json block_body = each_block.block->getBlockBodyJson();
+
+      m_storage->saveBlock(each_block.block->getBlockRaw(), block_header,
+                           block_body);
+      m_storage->saveLedgerTip(each_block.block->getHeight(),
+                               each_block.block->getBlockIdB64());
+      m_layered_storage->moveToDiskLedger(each_block.block->getBlockIdB64());
 
-      m_storage->saveBlock(block_raw, block_header, block_body);
-      m_layered_storage->moveToDiskLedger(each_block.block.getBlockIdB64());
+      if (each_block.block->getHeight() % config::LEDGER_SNAPSHOT_INTERVAL == 0)
+        m_storage->saveLedgerSnapshotAsync();
 
       CLOG(INFO, "BPRO") << "BLOCK SAVED (height="
-                         << each_block.block.getHeight()
-                         << ",#tx=" << each_block.block.getNumTransactions()
-                         << ",#ssig=" << each_block.block.getNumSSigs() << ")";
+                         << each_block.block->getHeight()
+                         << ",#tx=" << each_block.block->getNumTransactions()
+                         << ",#ssig=" << each_block.block->getNumSSigs() << ")";
     }
   }
 }
 
+// brings the ledger DB up to the latest saved block: from its own tip when it
+// is intact, otherwise from the latest snapshot
+void BlockProcessor::recoverLedger() {
+  nth_link_type last_block_info = m_storage->getNthBlockLinkInfo();
+  block_height_type last_height =
+      m_storage->empty() ? 0 : last_block_info.height;
+
+  ledger_tip_type ledger_tip;
+  bool has_tip = m_storage->getLedgerTip(ledger_tip);
+  bool tip_mismatched = false;
+
+  if (has_tip && ledger_tip.height > 0 &&
+      (ledger_tip.height > last_height ||
+       TypeConverter::encodeBase64(
+           m_storage->getNthBlockLinkInfo(ledger_tip.height).id) !=
+           ledger_tip.block_id_b64)) {
+    CLOG(ERROR, "BPRO") << "Ledger tip (height=" << ledger_tip.height
+                        << ") does not match saved blocks";
+    has_tip = false;
+    tip_mismatched = true;
+  }
+
+  if (!has_tip) {
+    if (m_storage->restoreLedgerSnapshot(ledger_tip)) {
+      has_tip = true;
+      m_layered_storage->clearLedger(); // drops cached ledger views
+    } else if (tip_mismatched) {
+      // known to be wrong and nothing to start from but the first block
+      if (!m_storage->eraseLedger()) {
+        CLOG(ERROR, "BPRO") << "Failed to erase the ledger";
+        return;
+      }
+      m_layered_storage->clearLedger();
+    } else if (!m_storage->isLedgerEmpty()) {
+      // ledger written before tips were recorded; trust it as it is
+      m_storage->saveLedgerTip(last_height, TypeConverter::encodeBase64(
+                                                last_block_info.id));
+      m_storage->flushLedger();
+      return;
+    }
+  }
+
+  block_height_type from_height = has_tip ? ledger_tip.height + 1 : 1;
+  if (from_height > last_height)
+    return;
+
+  CLOG(INFO, "BPRO") << "Replaying ledger from " << from_height << " to "
+                     << last_height;
+
+  replayLedgerFrom(from_height, last_height);
+}
+
+bool BlockProcessor::replayLedgerFrom(block_height_type from_height,
+                                      block_height_type to_height) {
+  auto &ledger_manager = Application::app().getCustomLedgerManager();
+
+  for (block_height_type height = from_height; height <= to_height;
+       ++height) {
+    storage_block_type saved_block = m_storage->readBlock(height);
+    if (saved_block.block_raw.empty()) {
+      CLOG(ERROR, "BPRO") << "Failed to replay ledger at " << height;
+      return false;
+    }
+
+    std::string block_id_b64 = TypeConverter::encodeBase64(saved_block.id);
+    ledger_manager.procLedgerBlock(saved_block.txs, block_id_b64, {});
+    m_storage->saveLedgerTip(height, block_id_b64);
+    m_layered_storage->moveToDiskLedger(block_id_b64);
+  }
+
+  return true;
+}
+
 void BlockProcessor::tryResolveUnresolvedBlocksIf() {
   nth_link_type unresolved_block =
       m_unresolved_block_pool.getUnresolvedLowestLink();
@@ -385,27 +894,19 @@ void BlockProcessor::tryResolveUnresolvedBlocksIf() {
 
     BlockRequest new_request;
     new_request.height = unresolved_block.height;
+    new_request.to_height = unresolved_block.height;
+    block_height_type height_range_max =
+        m_unresolved_block_pool.getHeightRangeMax();
+    if (height_range_max > unresolved_block.height + 1) // a gap, not a tip
+      new_request.to_height = std::min<block_height_type>(
+          height_range_max - 1,
+          unresolved_block.height + config::MAX_BLOCK_RANGE_SIZE - 1);
     new_request.recv_id = id_type();
     new_request.hash_b64 = "";
     new_request.prev_hash_b64 =
         TypeConverter::encodeBase64(unresolved_block.prev_hash);
-    new_request.request_time = 0;
-    new_request.num_retry = 0;
-
-    std::lock_guard<std::recursive_mutex> guard(m_request_mutex);
-    bool is_unique_request = true;
-    for (auto &block_request : m_request_list) {
-      if (block_request.height == new_request.height &&
-          block_request.prev_hash_b64 == new_request.prev_hash_b64) {
-        is_unique_request = false;
-        break;
-      }
-    }
-
-    if (is_unique_request)
-      m_request_list.emplace_back(new_request);
 
-    m_request_mutex.unlock();
+    addBlockRequest(new_request);
   }
 }
 
@@ -4,10 +4,12 @@
 #include "../../chain/merkle_tree.hpp"
 #include "../../chain/transaction.hpp"
 #include "../../chain/types.hpp"
+#include "../../utils/bounded_queue.hpp"
 #include "../../utils/bytes_builder.hpp"
 #include "../../utils/compressor.hpp"
 #include "../../utils/ecdsa.hpp"
 #include "../../utils/periodic_task.hpp"
+#include "../../utils/reorder_buffer.hpp"
 #include "../../utils/sha256.hpp"
 
 #include "../../services/input_queue.hpp"
@@ -20,25 +22,119 @@
 #include "../module.hpp"
 #include "unresolved_block_pool.hpp"
 
+#include <boost/asio.hpp>
 #include <botan-2/botan/base64.h>
 #include <botan-2/botan/buf_comp.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace gruut {
 
+using pipeline_clock = std::chrono::steady_clock;
+
 struct BlockRequest {
   std::string hash_b64;
   std::string prev_hash_b64;
   block_height_type height;
+  block_height_type to_height; // above height: ask for [height, to_height]
   id_type recv_id;
-  timestamp_t request_time;
+  pipeline_clock::time_point found_time; // when the gap was found
+  pipeline_clock::time_point sent_time;
+  pipeline_clock::time_point deadline; // of the next (re)send
   int num_retry;
 };
 
+// smoothed round-trip time of block requests to one merger (or of
+// broadcasts), and the retry timeout derived from it as in TCP (RFC 6298)
+struct BlockRequestRtt {
+  double srtt_ms{0};
+  double rttvar_ms{0};
+  int backoff{0}; // timeouts in a row
+
+  void addSample(double rtt_ms) {
+    if (srtt_ms == 0) {
+      srtt_ms = rtt_ms;
+      rttvar_ms = rtt_ms / 2;
+    } else {
+      rttvar_ms = 0.75 * rttvar_ms + 0.25 * std::abs(srtt_ms - rtt_ms);
+      srtt_ms = 0.875 * srtt_ms + 0.125 * rtt_ms;
+    }
+    backoff = 0;
+  }
+
+  uint64_t getTimeoutMs() const {
+    uint64_t timeout_ms =
+        (srtt_ms == 0) ? config::BLOCK_REQ_INIT_TIMEOUT_MS
+                       : static_cast<uint64_t>(srtt_ms + 4 * rttvar_ms);
+    timeout_ms =
+        std::max<uint64_t>(timeout_ms, config::MIN_BLOCK_REQ_TIMEOUT_MS);
+    timeout_ms <<= std::min(backoff, 8);
+    return std::min<uint64_t>(timeout_ms, config::MAX_BLOCK_REQ_TIMEOUT_MS);
+  }
+};
+
+// a received MSG_BLOCK on its way through the ingestion pipeline
+struct BlockPipelineJob {
+  uint64_t seq{0};
+  InputMsgEntry entry;
+  std::shared_ptr<const Block> block; // empty if dropped by verification
+  pipeline_clock::time_point stage_begin;
+};
+
+struct PipelineStageStat {
+  std::string name;
+  size_t depth{0}; // jobs waiting in front of this stage
+  uint64_t num_processed{0};
+  uint64_t avg_latency_us{0}; // waiting + processing
+  uint64_t max_latency_us{0};
+};
+
+class PipelineStageMeter {
+private:
+  std::atomic<uint64_t> m_num_processed{0};
+  std::atomic<uint64_t> m_total_latency_us{0};
+  std::atomic<uint64_t> m_max_latency_us{0};
+
+public:
+  void record(pipeline_clock::time_point stage_begin) {
+    uint64_t latency_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            pipeline_clock::now() - stage_begin)
+            .count();
+    ++m_num_processed;
+    m_total_latency_us += latency_us;
+
+    uint64_t max_latency_us = m_max_latency_us;
+    while (max_latency_us < latency_us &&
+           !m_max_latency_us.compare_exchange_weak(max_latency_us, latency_us))
+      ;
+  }
+
+  PipelineStageStat getStat(const std::string &name, size_t depth) const {
+    PipelineStageStat stat;
+    stat.name = name;
+    stat.depth = depth;
+    stat.num_processed = m_num_processed;
+    stat.avg_latency_us = (stat.num_processed == 0)
+                              ? 0
+                              : m_total_latency_us / stat.num_processed;
+    stat.max_latency_us = m_max_latency_us;
+    return stat;
+  }
+};
+
 class BlockProcessor : public Module {
 private:
   MessageProxy m_msg_proxy;
@@ -47,36 +143,91 @@ private:
   std::string m_my_id_b64;
   std::string m_my_chain_id_b64;
   UnresolvedBlockPool m_unresolved_block_pool;
-  std::list<BlockRequest> m_request_list;
-  std::recursive_mutex m_request_mutex;
-
-  PeriodicTask m_task_scheduler;
+  // outstanding block requests (by request seq), and a deadline queue of
+  // their next resends; entries left behind by a reschedule or a fill are
+  // skipped when they come up
+  std::map<uint64_t, BlockRequest> m_requests;
+  std::multimap<pipeline_clock::time_point, uint64_t> m_request_deadlines;
+  uint64_t m_next_request_seq{0};
+  std::map<std::string, BlockRequestRtt> m_request_rtts; // "" = broadcast
+  std::deque<uint64_t> m_gap_fill_ms; // recent samples
+  std::unique_ptr<boost::asio::deadline_timer> m_request_timer;
+  std::mutex m_request_mutex;
+
+  // the tip is announced to the tracker at most once per CHAIN_INFO_INTERVAL,
+  // and not at all until bootstrapping is over
+  PeriodicTask m_chain_info_scheduler;
+  std::atomic<bool> m_chain_info_dirty{false};
+  std::atomic<bool> m_is_bootstrapped{false};
 
   std::function<std::string(id_type &)> m_get_cert_func;
   std::function<std::string(std::string &, timestamp_t)> m_get_user_cert_func;
-  merger_id_type m_last_block_sender;
+  merger_id_type m_last_block_sender; // guarded by m_request_mutex
+
+  // ingestion pipeline: verify (concurrent) -> link & ledger -> persist
+  // (both in arrival order)
+  BoundedQueue<BlockPipelineJob> m_verify_queue;
+  ReorderBuffer<BlockPipelineJob> m_link_buffer; // bounds the jobs in flight
+  std::mutex m_link_mutex;
+  BoundedQueue<pipeline_clock::time_point> m_persist_queue;
+  std::vector<std::thread> m_pipeline_threads;
+  std::atomic<bool> m_pipeline_running{false};
+  PipelineStageMeter m_verify_meter;
+  PipelineStageMeter m_link_meter;
+  PipelineStageMeter m_persist_meter;
 
 public:
   BlockProcessor();
-  ~BlockProcessor() = default;
+  // a processor over storage that is never started, for its message
+  // handlers: linked blocks go to no ledger
+  explicit BlockProcessor(Storage *storage);
+  ~BlockProcessor();
 
   void start() override;
 
   void handleMessage(InputMsgEntry &entry);
   unblk_push_result_type handleMsgBlock(InputMsgEntry &entry);
+  std::shared_ptr<const Block> decodeBlock(InputMsgEntry &entry);
+  unblk_push_result_type pushVerifiedBlock(std::shared_ptr<const Block> block,
+                                           InputMsgEntry &entry);
 
   block_layer_t getBlockLayer(const std::string &block_id_b64);
   nth_link_type getMostPossibleLink();
   bool hasUnresolvedBlocks();
+  std::vector<PipelineStageStat> getPipelineStats();
+  uint64_t getMedianGapFillMs();
+  void endBootstrap();
+
+  static std::vector<InputMsgEntry> unpackBlockRange(InputMsgEntry &entry);
 
 private:
-  void requestMissingBlock();
+  void startPipeline();
+  void stopPipeline();
+  void ingestBlock(InputMsgEntry &entry);
+  void verifyLoop();
+  void linkLoop();
+  void persistLoop();
+  void requestPersist();
+  void logPipelineStats();
+  unblk_push_result_type linkBlock(std::shared_ptr<const Block> block,
+                                   InputMsgEntry &entry);
+  void addBlockRequest(BlockRequest &new_request);
+  void sendDueBlockRequests();
+  void armRequestTimer();
+  void sendBlockRequest(const BlockRequest &request);
+  void completeBlockRequests(const Block &block);
+  void sendChainInfoIf();
   void handleMsgReqBlock(InputMsgEntry &entry);
+  void handleMsgReqBlockRange(InputMsgEntry &entry);
+  void handleMsgBlockRange(InputMsgEntry &entry);
   void handleMsgRequestHeader(InputMsgEntry &entry);
   void handleMsgReqCheck(InputMsgEntry &entry);
   void handleMsgReqStatus(InputMsgEntry &entry);
   void sendErrorMessage(ErrorMsgType t_error_typem, id_type &recv_id);
   void procResolvedBlocksIf();
+  void recoverLedger();
+  bool replayLedgerFrom(block_height_type from_height,
+                        block_height_type to_height);
   void tryResolveUnresolvedBlocksIf();
 };
 } // namespace gruut
@@ -2,17 +2,44 @@
 #include "../../application.hpp"
 #include "easy_logging.hpp"
 
+#include <botan-2/botan/hash.h>
+#include <botan-2/botan/hex.h>
+
+#include <map>
+#include <sstream>
+
 namespace gruut {
 
 UnresolvedBlockPool::UnresolvedBlockPool() {
+  m_storage = Storage::getInstance();
   m_layered_storage = LayeredStorage::getInstance();
+  m_ledger_forwarder = [](const Block &block,
+                          const block_layer_t &block_layer) {
+    Application::app().getCustomLedgerManager().procLedgerBlock(
+        block.getTransactions(), block.getBlockIdB64(), block_layer);
+  };
+  el::Loggers::getLogger("URBK");
+}
+
+UnresolvedBlockPool::UnresolvedBlockPool(Storage *storage,
+                                         ledger_forwarder_t ledger_forwarder)
+    : m_storage(storage), m_layered_storage(nullptr),
+      m_ledger_forwarder(std::move(ledger_forwarder)) {
   el::Loggers::getLogger("URBK");
 }
 
 void UnresolvedBlockPool::invalidateCaches() {
   m_has_cache_link = false;
   m_has_cache_block_layer = false;
-  m_has_cache_pos = false;
+}
+
+void UnresolvedBlockPool::clear() {
+  std::lock_guard<std::recursive_mutex> guard(m_push_mutex);
+  m_block_pool.clear();
+  m_id_index.clear();
+  m_hash_index.clear();
+  m_tip_pos = BlockPosOnMap(0, 0);
+  invalidateCaches();
 }
 
 bool UnresolvedBlockPool::hasUnresolvedBlocks() {
@@ -58,8 +85,9 @@ bool UnresolvedBlockPool::prepareBins(block_height_type t_height) {
 }
 
 // we assume this block has valid structure at least
-unblk_push_result_type UnresolvedBlockPool::push(Block &block,
-                                                 bool is_restore) {
+unblk_push_result_type
+UnresolvedBlockPool::push(std::shared_ptr<const Block> block,
+                          bool is_restore) {
   unblk_push_result_type ret_val;
   ret_val.height = 0;
   ret_val.linked = false;
@@ -68,35 +96,34 @@ unblk_push_result_type UnresolvedBlockPool::push(Block &block,
 
   std::lock_guard<std::recursive_mutex> guard(m_push_mutex);
 
-  block_height_type block_height = block.getHeight();
+  block_height_type block_height = block->getHeight();
   int bin_idx =
       static_cast<int>(block_height - m_last_height) - 1; // e.g., 0 = 2 - 1 - 1
   if (!prepareBins(block_height))
     return ret_val;
 
-  for (auto &each_block : m_block_pool[bin_idx]) {
-    if (each_block.block == block) {
-      ret_val.height = block_height;
-      ret_val.duplicated = true;
-      return ret_val;
-    }
+  std::string hash_key = TypeConverter::bytesToString(block->getHash());
+  auto it_hash = m_hash_index.find(hash_key);
+  if (it_hash != m_hash_index.end() && it_hash->second.height == block_height) {
+    ret_val.height = block_height;
+    ret_val.duplicated = true;
+    return ret_val;
   }
 
   int prev_queue_idx = -1; // no previous
 
   if (bin_idx > 0) { // if there is previous bin
-    size_t idx = 0;
-    for (auto &each_block : m_block_pool[bin_idx - 1]) {
-      if (each_block.block.getBlockId() == block.getPrevBlockId() &&
-          each_block.block.getHash() == block.getPrevHash()) {
-        prev_queue_idx = static_cast<int>(idx);
-        break;
-      }
-      ++idx;
+    auto it_prev = m_hash_index.find(
+        TypeConverter::bytesToString(block->getPrevHash()));
+    if (it_prev != m_hash_index.end() &&
+        it_prev->second.height + 1 == block_height &&
+        getBlockAt(it_prev->second)->block->getBlockId() ==
+            block->getPrevBlockId()) {
+      prev_queue_idx = static_cast<int>(it_prev->second.vector_idx);
     }
   } else { // no previous
-    if (block.getPrevBlockId() == m_last_block_id &&
-        block.getPrevHash() == m_last_hash) {
+    if (block->getPrevBlockId() == m_last_block_id &&
+        block->getPrevHash() == m_last_hash) {
       prev_queue_idx = 0;
     } else {
       // drop block -- this is not linkable block!
@@ -106,34 +133,47 @@ unblk_push_result_type UnresolvedBlockPool::push(Block &block,
 
   int queue_idx = m_block_pool[bin_idx].size();
 
-  m_block_pool[bin_idx].emplace_back(block, prev_queue_idx, 0, false);
+  m_block_pool[bin_idx].emplace_back(block, prev_queue_idx,
+                                     block->getNumSSigs(), false);
+
+  BlockPosOnMap block_pos(block_height, queue_idx);
+  m_id_index.emplace(TypeConverter::bytesToString(block->getBlockId()),
+                     block_pos);
+  m_hash_index.emplace(hash_key, block_pos);
+
+  if (bin_idx > 0 && prev_queue_idx >= 0)
+    linkToParent(bin_idx, queue_idx);
 
   block_layer_t block_layer_of_this;
   if (bin_idx > 0)
-    block_layer_of_this = getBlockLayer(block.getBlockIdB64());
+    block_layer_of_this = getBlockLayer(block->getBlockIdB64());
 
   ret_val.height = block_height;
   ret_val.linked = (bin_idx == 0) ? true : !block_layer_of_this.empty();
   ret_val.block_layer = block_layer_of_this;
 
   m_block_pool[bin_idx][queue_idx].block_layer = block_layer_of_this;
-  m_block_pool[bin_idx][queue_idx].linked = ret_val.linked;
 
-  if (!is_restore)
-    backupPool();
+  if (!is_restore) {
+    appendBackupLog('A', block->getBlockIdB64() + " " + block->serialize());
+    backupPoolIf();
+  }
 
   if (bin_idx + 1 < m_block_pool.size()) { // if there is next bin
-    for (auto &each_block : m_block_pool[bin_idx + 1]) {
-      if (each_block.block.getPrevBlockId() == block.getBlockId() &&
-          each_block.block.getPrevHash() == block.getHash()) {
-        if (each_block.prev_vector_idx < 0) {
-          each_block.prev_vector_idx = queue_idx;
-        }
+    auto &next_bin = m_block_pool[bin_idx + 1];
+    for (size_t i = 0; i < next_bin.size(); ++i) {
+      auto &each_block = next_bin[i];
+      if (each_block.prev_vector_idx < 0 &&
+          each_block.block->getPrevBlockId() == block->getBlockId() &&
+          each_block.block->getPrevHash() == block->getHash()) {
+        each_block.prev_vector_idx = queue_idx;
+        linkToParent(bin_idx + 1, i);
       }
     }
   }
 
   if (ret_val.linked) {
+    setLinked(bin_idx, queue_idx, true);
     forwardBlocksToLedgerFrom(bin_idx, queue_idx);
   }
 
@@ -143,9 +183,8 @@ unblk_push_result_type UnresolvedBlockPool::push(Block &block,
 
   invalidateCaches();
 
-  m_layered_storage->setBlockLayer(getMostPossibleBlockLayer());
-
-  m_push_mutex.unlock();
+  if (m_layered_storage != nullptr)
+    m_layered_storage->setBlockLayer(getMostPossibleBlockLayer());
 
   return ret_val;
 }
@@ -157,9 +196,7 @@ block_layer_t UnresolvedBlockPool::forwardBlockToLedgerAt(int bin_idx,
     return {};
 
   auto &t_block = m_block_pool[bin_idx][vector_idx];
-  Application::app().getCustomLedgerManager().procLedgerBlock(
-      t_block.block.getBlockTXsAsJson(), t_block.block.getBlockIdB64(),
-      t_block.block_layer);
+  m_ledger_forwarder(*t_block.block, t_block.block_layer);
 
   return t_block.block_layer;
 }
@@ -178,15 +215,15 @@ void UnresolvedBlockPool::forwardBlocksToLedgerFrom(int bin_idx,
     if (bin_idx < 0 || m_block_pool.size() < bin_idx + 1)
       return;
 
-    for (size_t i = 0; i < m_block_pool[bin_idx].size(); ++i) {
+    auto next_vector_idx =
+        m_block_pool[bin_idx - 1][prev_vector_idx].next_vector_idx;
+    for (auto &i : next_vector_idx) {
       auto &each_block = m_block_pool[bin_idx][i];
-      if (each_block.prev_vector_idx == prev_vector_idx) {
-        each_block.block_layer = block_layer;
-        block_layer.insert(block_layer.begin(),
-                           each_block.block.getBlockIdB64());
-        forwardBlockToLedgerAt(bin_idx, i);
-        recBlockToLedger(bin_idx + 1, i, block_layer);
-      }
+      each_block.block_layer = block_layer;
+      block_layer.insert(block_layer.begin(),
+                         each_block.block->getBlockIdB64());
+      forwardBlockToLedgerAt(bin_idx, i);
+      recBlockToLedger(bin_idx + 1, i, block_layer);
     }
   };
 
@@ -196,7 +233,8 @@ void UnresolvedBlockPool::forwardBlocksToLedgerFrom(int bin_idx,
 
 bool UnresolvedBlockPool::getBlock(block_height_type t_height,
                                    const hash_t &t_prev_hash,
-                                   const hash_t &t_hash, Block &ret_block) {
+                                   const hash_t &t_hash,
+                                   std::shared_ptr<const Block> &ret_block) {
 
   std::lock_guard<std::recursive_mutex> guard(m_push_mutex);
   if (m_block_pool.empty()) {
@@ -225,8 +263,8 @@ bool UnresolvedBlockPool::getBlock(block_height_type t_height,
 
   bool is_some = false;
   for (auto &each_block : m_block_pool[bin_pos]) {
-    if ((prev_hash.empty() || each_block.block.getPrevHash() == prev_hash) &&
-        (block_hash.empty() || each_block.block.getHash() == block_hash)) {
+    if ((prev_hash.empty() || each_block.block->getPrevHash() == prev_hash) &&
+        (block_hash.empty() || each_block.block->getHash() == block_hash)) {
       ret_block = each_block.block;
       is_some = true;
       break;
@@ -237,7 +275,7 @@ bool UnresolvedBlockPool::getBlock(block_height_type t_height,
 }
 
 bool UnresolvedBlockPool::getBlock(block_height_type t_height,
-                                   Block &ret_block) {
+                                   std::shared_ptr<const Block> &ret_block) {
   std::lock_guard<std::recursive_mutex> guard(m_push_mutex);
 
   if (m_block_pool.empty()) {
@@ -262,7 +300,7 @@ bool UnresolvedBlockPool::getBlock(block_height_type t_height,
   auto it =
       std::find_if(m_block_pool[bin_pos].begin(), m_block_pool[bin_pos].end(),
                    [&t_height](UnresolvedBlock &unresolvedBlock) {
-                     return unresolvedBlock.block.getHeight() == t_height;
+                     return unresolvedBlock.block->getHeight() == t_height;
                    });
 
   if (it != m_block_pool[bin_pos].end()) {
@@ -280,16 +318,11 @@ void UnresolvedBlockPool::getResolvedBlocks(
   resolved_blocks.clear();
   drop_blocks.clear();
 
-  auto storage = Storage::getInstance();
   size_t num_resolved_block = 0;
-  json del_id_array = json::array();
-  json new_id_array = json::array();
 
   auto resolveBlocksStepByStep =
       [this](std::vector<UnresolvedBlock> &resolved_blocks,
              std::vector<std::string> &drop_blocks) {
-        updateConfirmLevel();
-
         if (m_block_pool.size() < 2 || m_block_pool[0].empty() ||
             m_block_pool[1].empty())
           return;
@@ -325,40 +358,55 @@ void UnresolvedBlockPool::getResolvedBlocks(
         m_prev_hash = m_last_hash;
 
         m_last_block_id =
-            m_block_pool[0][resolved_block_idx].block.getBlockId();
-        m_last_hash = m_block_pool[0][resolved_block_idx].block.getHash();
-        m_last_height = m_block_pool[0][resolved_block_idx].block.getHeight();
+            m_block_pool[0][resolved_block_idx].block->getBlockId();
+        m_last_hash = m_block_pool[0][resolved_block_idx].block->getHash();
+        m_last_height = m_block_pool[0][resolved_block_idx].block->getHeight();
 
         resolved_blocks.emplace_back(m_block_pool[0][resolved_block_idx]);
 
         // clear this height list
 
-        auto leyered_storage = LayeredStorage::getInstance();
-
         if (m_block_pool[0].size() > 1) {
           for (auto &each_block : m_block_pool[0]) {
-            if (each_block.block.getBlockId() != m_last_block_id) {
-              drop_blocks.emplace_back(each_block.block.getBlockIdB64());
+            if (each_block.block->getBlockId() != m_last_block_id) {
+              drop_blocks.emplace_back(each_block.block->getBlockIdB64());
             }
           }
           CLOG(INFO, "URBK") << "Dropped out " << m_block_pool[0].size() - 1
                              << " unresolved block(s)";
         }
 
-        m_block_pool.pop_front();
+        for (auto &each_block : m_block_pool[0]) {
+          m_id_index.erase(
+              TypeConverter::bytesToString(each_block.block->getBlockId()));
+          m_hash_index.erase(
+              TypeConverter::bytesToString(each_block.block->getHash()));
+        }
 
-        if (m_block_pool.empty())
-          return;
+        m_block_pool.pop_front();
 
-        for (auto &each_block : m_block_pool[0]) {
-          if (each_block.block.getPrevBlockId() == m_last_block_id &&
-              each_block.block.getPrevHash() == m_last_hash) {
-            each_block.prev_vector_idx = 0;
-          } else {
-            // this block is unlinkable => to be deleted
-            each_block.prev_vector_idx = -1;
+        if (!m_block_pool.empty()) {
+          for (size_t i = 0; i < m_block_pool[0].size(); ++i) {
+            auto &each_block = m_block_pool[0][i];
+            if (each_block.block->getPrevBlockId() == m_last_block_id &&
+                each_block.block->getPrevHash() == m_last_hash) {
+              each_block.prev_vector_idx = 0;
+              if (!each_block.linked)
+                setLinked(0, i, true);
+            } else {
+              // this block is unlinkable => to be deleted
+              each_block.prev_vector_idx = -1;
+              if (each_block.linked)
+                setLinked(0, i, false);
+            }
           }
         }
+
+        // survivors keep their relative order, so the tip only moves when
+        // it was cut off
+        UnresolvedBlock *tip_block = getBlockAt(m_tip_pos);
+        if (tip_block == nullptr || !tip_block->linked)
+          rebuildTip();
       };
 
   std::lock_guard<std::recursive_mutex> guard(m_push_mutex);
@@ -368,47 +416,19 @@ void UnresolvedBlockPool::getResolvedBlocks(
     resolveBlocksStepByStep(resolved_blocks, drop_blocks);
   } while (num_resolved_block < resolved_blocks.size());
 
-  json id_array = readBackupIds();
-
-  if (id_array.empty() || !id_array.is_array())
+  if (resolved_blocks.empty() && drop_blocks.empty())
     return;
 
-  for (auto &each_block_id : drop_blocks) {
-    del_id_array.push_back(each_block_id);
-  }
-
-  for (auto &each_id : id_array) {
-    bool is_resolved = false;
-    std::string block_id_b64 = Safe::getString(each_id);
-    if (block_id_b64.empty())
-      continue;
-
-    for (auto &each_block : resolved_blocks) {
-      if (block_id_b64 == each_block.block.getBlockIdB64()) {
-        is_resolved = true;
-        break;
-      }
-    }
-
-    if (is_resolved) {
-      del_id_array.push_back(block_id_b64);
-    } else {
-      new_id_array.push_back(block_id_b64);
-    }
-  }
-
-  storage->saveBackup(
-      UNRESOLVED_BLOCK_IDS_KEY,
-      TypeConverter::bytesToString(json::to_cbor(new_id_array)));
-
-  for (auto &each_id : del_id_array) {
-    std::string block_id_b64 = Safe::getString(each_id);
-    storage->delBackup(block_id_b64);
-  }
+  invalidateCaches();
 
-  storage->flushBackup();
+  std::string gone_ids;
+  for (auto &each_block : resolved_blocks)
+    gone_ids += each_block.block->getBlockIdB64() + " ";
+  for (auto &each_block_id : drop_blocks)
+    gone_ids += each_block_id + " ";
 
-  m_push_mutex.unlock();
+  appendBackupLog('D', gone_ids);
+  backupPoolIf();
 }
 
 nth_link_type UnresolvedBlockPool::getUnresolvedLowestLink() {
@@ -427,9 +447,9 @@ nth_link_type UnresolvedBlockPool::getUnresolvedLowestLink() {
       ret_link.prev_hash = m_last_hash;
     } else if (bin_idx >= 0) {
       ret_link.height =
-          m_block_pool[bin_idx][longest_pos.vector_idx].block.getHeight() + 1;
+          m_block_pool[bin_idx][longest_pos.vector_idx].block->getHeight() + 1;
       ret_link.prev_hash =
-          m_block_pool[bin_idx][longest_pos.vector_idx].block.getHash();
+          m_block_pool[bin_idx][longest_pos.vector_idx].block->getHash();
     }
   }
 
@@ -439,34 +459,28 @@ nth_link_type UnresolvedBlockPool::getUnresolvedLowestLink() {
 block_layer_t
 UnresolvedBlockPool::getBlockLayer(const std::string &block_id_b64) {
   block_layer_t block_layer_of_this;
-  int bin_idx = -1;
-  int queue_idx = -1;
 
-  if (!block_id_b64.empty()) {
-    for (size_t i = 0; i < m_block_pool.size(); ++i) {
-      for (size_t j = 0; j < m_block_pool[i].size(); ++j) {
+  if (block_id_b64.empty())
+    return block_layer_of_this;
 
-        if (block_id_b64 == m_block_pool[i][j].block.getBlockIdB64()) {
-          bin_idx = static_cast<int>(i);
-          queue_idx = static_cast<int>(j);
-          break;
-        }
-      }
-      if (bin_idx >= 0 && queue_idx >= 0)
-        break;
-    }
+  auto it_map = m_id_index.find(
+      TypeConverter::bytesToString(TypeConverter::decodeBase64(block_id_b64)));
+  if (it_map == m_id_index.end())
+    return block_layer_of_this;
 
-    for (int i = bin_idx; i >= 0; --i) {
-      std::string new_block_id_b64 =
-          m_block_pool[i][queue_idx].block.getBlockIdB64();
-      if (block_id_b64 != new_block_id_b64)
-        block_layer_of_this.emplace_back(new_block_id_b64);
+  int bin_idx = getBinIdx(it_map->second.height);
+  int queue_idx = static_cast<int>(it_map->second.vector_idx);
 
-      queue_idx = m_block_pool[i][queue_idx].prev_vector_idx;
-      if (queue_idx < 0) {
-        block_layer_of_this.clear();
-        break;
-      }
+  for (int i = bin_idx; i >= 0; --i) {
+    std::string new_block_id_b64 =
+        m_block_pool[i][queue_idx].block->getBlockIdB64();
+    if (block_id_b64 != new_block_id_b64)
+      block_layer_of_this.emplace_back(new_block_id_b64);
+
+    queue_idx = m_block_pool[i][queue_idx].prev_vector_idx;
+    if (queue_idx < 0) {
+      block_layer_of_this.clear();
+      break;
     }
   }
 
@@ -507,12 +521,12 @@ nth_link_type UnresolvedBlockPool::getMostPossibleLink() {
 
     if (deque_idx >= 0) {
       auto &t_block = m_block_pool[deque_idx][longest_pos.vector_idx];
-      ret_link.height = t_block.block.getHeight();
-      ret_link.id = t_block.block.getBlockId();
-      ret_link.hash = t_block.block.getHash();
-      ret_link.prev_hash = t_block.block.getPrevBlockId();
-      ret_link.prev_id = t_block.block.getPrevHash();
-      ret_link.time = t_block.block.getTime();
+      ret_link.height = t_block.block->getHeight();
+      ret_link.id = t_block.block->getBlockId();
+      ret_link.hash = t_block.block->getHash();
+      ret_link.prev_hash = t_block.block->getPrevBlockId();
+      ret_link.prev_id = t_block.block->getPrevHash();
+      ret_link.time = t_block.block->getTime();
     }
   }
 
@@ -538,7 +552,7 @@ block_layer_t UnresolvedBlockPool::getMostPossibleBlockLayer() {
 
   for (int i = bin_end; i >= 0; --i) {
     ret_block_layer.emplace_back(
-        m_block_pool[i][queue_idx].block.getBlockIdB64());
+        m_block_pool[i][queue_idx].block->getBlockIdB64());
     queue_idx = m_block_pool[i][queue_idx].prev_vector_idx;
   }
 
@@ -549,50 +563,97 @@ block_layer_t UnresolvedBlockPool::getMostPossibleBlockLayer() {
 
 void UnresolvedBlockPool::restorePool() {
 
+  // live block ids in push order; the serialized block is empty when it is
+  // in the full image rather than in the log
+  std::vector<std::string> live_ids;
+  std::map<std::string, std::string> live_blocks;
+
   json id_array = readBackupIds();
-  if (id_array.empty() || !id_array.is_array())
-    return;
+  for (auto &id_each : id_array) {
+    std::string block_id_b64 = Safe::getString(id_each);
+    if (block_id_b64.empty())
+      continue;
+    m_backup_base_ids.insert(block_id_b64);
+    live_ids.emplace_back(block_id_b64);
+    live_blocks[block_id_b64] = "";
+  }
+
+  m_backup_log_head =
+      Safe::getSize(m_storage->readBackup(UNRESOLVED_LOG_HEAD_KEY));
+  m_backup_log_tail =
+      Safe::getSize(m_storage->readBackup(UNRESOLVED_LOG_TAIL_KEY));
+
+  for (uint64_t seq = m_backup_log_head; seq < m_backup_log_tail; ++seq) {
+    char op;
+    std::string payload;
+    if (!readBackupLog(seq, op, payload)) {
+      CLOG(ERROR, "URBK") << "Backup log is broken at " << seq
+                          << ", the rest is ignored";
+      break;
+    }
 
-  auto storage = Storage::getInstance();
+    if (op == 'A') {
+      size_t id_end = payload.find(' ');
+      if (id_end == std::string::npos)
+        continue;
+      std::string block_id_b64 = payload.substr(0, id_end);
+      if (live_blocks.find(block_id_b64) == live_blocks.end())
+        live_ids.emplace_back(block_id_b64);
+      live_blocks[block_id_b64] = payload.substr(id_end + 1);
+    } else if (op == 'D') {
+      std::istringstream id_stream(payload);
+      std::string block_id_b64;
+      while (id_stream >> block_id_b64)
+        live_blocks.erase(block_id_b64);
+    }
+  }
 
   size_t num_pused_block = 0;
 
-  for (auto &id_each : id_array) {
-    std::string block_id_b64 = Safe::getString(id_each);
-    if (!block_id_b64.empty()) {
-      std::string serialized_block = storage->readBackup(block_id_b64);
-      if (serialized_block.empty()) {
-        CLOG(ERROR, "URBK") << "Failed to read block [" << block_id_b64 << "]";
-        continue;
-      }
+  for (auto &block_id_b64 : live_ids) {
+    auto it_map = live_blocks.find(block_id_b64);
+    if (it_map == live_blocks.end())
+      continue;
 
-      Block new_block;
-      if (!new_block.deserialize(serialized_block)) {
-        CLOG(ERROR, "URBK")
-            << "Failed to deserialize block [" << block_id_b64 << "]";
-        continue;
-      }
+    std::string serialized_block = it_map->second.empty()
+                                       ? m_storage->readBackup(block_id_b64)
+                                       : it_map->second;
+    live_blocks.erase(it_map);
 
-      auto push_result = push(new_block, true);
-      if (push_result.height == 0) {
-        CLOG(ERROR, "URBK")
-            << "Failed to restore block [" << block_id_b64 << "]";
-      } else {
-        CLOG(INFO, "URBK") << push_result.height << "-th block was restored.";
-        ++num_pused_block;
-      }
+    if (serialized_block.empty()) {
+      CLOG(ERROR, "URBK") << "Failed to read block [" << block_id_b64 << "]";
+      continue;
+    }
+
+    auto new_block = std::make_shared<Block>();
+    if (!new_block->deserialize(serialized_block)) {
+      CLOG(ERROR, "URBK") << "Failed to deserialize block [" << block_id_b64
+                          << "]";
+      continue;
+    }
+
+    auto push_result = push(std::move(new_block), true);
+    if (push_result.height == 0) {
+      CLOG(ERROR, "URBK") << "Failed to restore block [" << block_id_b64
+                          << "]";
+    } else {
+      CLOG(INFO, "URBK") << push_result.height << "-th block was restored.";
+      ++num_pused_block;
     }
   }
 
   CLOG(INFO, "URBK") << num_pused_block
                      << " unresolved block(s) have been restored.";
+
+  // start over from an image of what was actually restored
+  backupPool();
 }
 
 json UnresolvedBlockPool::readBackupIds() {
   json id_array = json::array();
 
-  auto storage = Storage::getInstance();
-  std::string backup_block_ids = storage->readBackup(UNRESOLVED_BLOCK_IDS_KEY);
+  std::string backup_block_ids =
+      m_storage->readBackup(UNRESOLVED_BLOCK_IDS_KEY);
   if (backup_block_ids.empty())
     return id_array;
 
@@ -606,92 +667,167 @@ json UnresolvedBlockPool::readBackupIds() {
   return id_array;
 }
 
+// compaction: rewrites the full image from the current pool and truncates
+// the delta log
 void UnresolvedBlockPool::backupPool() {
 
   json id_array = json::array();
-  auto storage = Storage::getInstance();
+  std::set<std::string> new_base_ids;
 
   for (auto &each_level : m_block_pool) {
     for (auto &each_block : each_level) {
-      std::string key = each_block.block.getBlockIdB64();
-      storage->saveBackup(key, each_block.block.serialize());
+      std::string key = each_block.block->getBlockIdB64();
+      if (m_backup_base_ids.find(key) == m_backup_base_ids.end())
+        m_storage->saveBackup(key, each_block.block->serialize());
       id_array.push_back(key);
+      new_base_ids.insert(key);
     }
   }
 
-  storage->saveBackup(UNRESOLVED_BLOCK_IDS_KEY,
+  for (auto &each_id : m_backup_base_ids) {
+    if (new_base_ids.find(each_id) == new_base_ids.end())
+      m_storage->delBackup(each_id);
+  }
+
+  m_storage->saveBackup(UNRESOLVED_BLOCK_IDS_KEY,
                       TypeConverter::bytesToString(json::to_cbor(id_array)));
 
-  storage->flushBackup();
+  for (uint64_t seq = m_backup_log_head; seq < m_backup_log_tail; ++seq)
+    m_storage->delBackup(getBackupLogKey(seq));
+
+  m_backup_log_head = m_backup_log_tail;
+  m_storage->saveBackup(UNRESOLVED_LOG_HEAD_KEY, to_string(m_backup_log_head));
+  m_storage->saveBackup(UNRESOLVED_LOG_TAIL_KEY, to_string(m_backup_log_tail));
+
+  m_storage->flushBackup();
+
+  m_backup_base_ids = std::move(new_base_ids);
 }
 
-BlockPosOnMap UnresolvedBlockPool::getLongestBlockPos() {
-  if (m_has_cache_pos)
-    return m_cache_possible_pos;
+void UnresolvedBlockPool::backupPoolIf() {
+  size_t num_blocks = 0;
+  for (auto &each_level : m_block_pool)
+    num_blocks += each_level.size();
 
-  // search prev_level
-  std::function<void(size_t, size_t, BlockPosOnMap &)> recSearchLongestLinkPos;
-  recSearchLongestLinkPos = [this, &recSearchLongestLinkPos](
-                                size_t bin_idx, size_t prev_vector_idx,
-                                BlockPosOnMap &longest_pos) {
-    if (m_block_pool.size() < bin_idx + 1)
-      return;
+  uint64_t log_size = m_backup_log_tail - m_backup_log_head;
+  if (log_size > config::MIN_BACKUP_LOG_COMPACTION && log_size > 2 * num_blocks)
+    backupPool();
+}
 
-    // if this level is empty, it will automatically stop to search
-    for (size_t i = 0; i < m_block_pool[bin_idx].size(); ++i) {
-      auto &each_block = m_block_pool[bin_idx][i];
-      if (each_block.prev_vector_idx == prev_vector_idx) {
-        if (each_block.block.getHeight() > longest_pos.height) { // relaxation
-          longest_pos.height = each_block.block.getHeight();
-          longest_pos.vector_idx = i;
-        }
+// entry = CRC32 (hex) + op + payload
+void UnresolvedBlockPool::appendBackupLog(char op, const std::string &payload) {
+  std::string entry = op + payload;
+  std::unique_ptr<Botan::HashFunction> crc32(
+      Botan::HashFunction::create("CRC32"));
+  crc32->update(entry);
+
+  m_storage->saveBackup(getBackupLogKey(m_backup_log_tail),
+                      Botan::hex_encode(crc32->final()) + entry);
+  ++m_backup_log_tail;
+  m_storage->saveBackup(UNRESOLVED_LOG_TAIL_KEY, to_string(m_backup_log_tail));
+  m_storage->flushBackup();
+}
 
-        recSearchLongestLinkPos(bin_idx + 1, i, longest_pos);
-      }
-    }
-  };
+bool UnresolvedBlockPool::readBackupLog(uint64_t seq, char &op,
+                                        std::string &payload) {
+  const size_t crc32_hex_size = 8;
 
-  BlockPosOnMap longest_pos(0, 0);
+  std::string value = m_storage->readBackup(getBackupLogKey(seq));
+  if (value.size() < crc32_hex_size + 1)
+    return false;
 
-  if (!m_block_pool.empty()) {
-    for (size_t i = 0; i < m_block_pool[0].size(); ++i) {
-      if (m_block_pool[0][i].prev_vector_idx == 0) {
+  std::string entry = value.substr(crc32_hex_size);
+  std::unique_ptr<Botan::HashFunction> crc32(
+      Botan::HashFunction::create("CRC32"));
+  crc32->update(entry);
+  if (Botan::hex_encode(crc32->final()) != value.substr(0, crc32_hex_size))
+    return false;
 
-        if (m_block_pool[0][i].block.getHeight() >
-            longest_pos.height) { // relaxation
-          longest_pos.height = m_block_pool[0][i].block.getHeight();
-          longest_pos.vector_idx = i;
-        }
+  op = entry[0];
+  payload = entry.substr(1);
+  return true;
+}
 
-        recSearchLongestLinkPos(1, i, longest_pos); // recursive call
-      }
-    }
-  }
+std::string UnresolvedBlockPool::getBackupLogKey(uint64_t seq) {
+  return UNRESOLVED_LOG_ENTRY_KEY + to_string(seq);
+}
 
-  m_cache_possible_pos = longest_pos;
-  m_has_cache_pos = true;
+BlockPosOnMap UnresolvedBlockPool::getLongestBlockPos() { return m_tip_pos; }
 
-  return longest_pos;
+int UnresolvedBlockPool::getBinIdx(block_height_type height) {
+  return static_cast<int>(height - m_last_height) - 1;
 }
 
-void UnresolvedBlockPool::updateConfirmLevel() {
-  if (m_block_pool.empty())
-    return;
+UnresolvedBlock *UnresolvedBlockPool::getBlockAt(const BlockPosOnMap &pos) {
+  int bin_idx = getBinIdx(pos.height);
+  if (pos.height <= m_last_height || m_block_pool.size() < bin_idx + 1 ||
+      m_block_pool[bin_idx].size() < pos.vector_idx + 1)
+    return nullptr;
 
-  for (auto &each_level : m_block_pool) {
-    for (auto &each_block : each_level) {
-      each_block.confirm_level = each_block.block.getNumSSigs();
-    }
+  return &m_block_pool[bin_idx][pos.vector_idx];
+}
+
+// the child's confirm level is added to every ancestor in the pool
+void UnresolvedBlockPool::linkToParent(int bin_idx, size_t vector_idx) {
+  auto &child = m_block_pool[bin_idx][vector_idx];
+  auto &siblings =
+      m_block_pool[bin_idx - 1][child.prev_vector_idx].next_vector_idx;
+  siblings.insert(
+      std::upper_bound(siblings.begin(), siblings.end(), vector_idx),
+      vector_idx);
+
+  int queue_idx = child.prev_vector_idx;
+  for (int i = bin_idx - 1; i >= 0 && queue_idx >= 0; --i) {
+    auto &ancestor = m_block_pool[i][queue_idx];
+    ancestor.confirm_level += child.confirm_level;
+    queue_idx = (i > 0) ? ancestor.prev_vector_idx : -1;
   }
+}
 
-  for (int i = (int)m_block_pool.size() - 1; i > 0; --i) {
-    for (auto &each_block : m_block_pool[i]) { // for vector
-      if (each_block.prev_vector_idx >= 0 &&
-          m_block_pool[i - 1].size() > each_block.prev_vector_idx) {
-        m_block_pool[i - 1][each_block.prev_vector_idx].confirm_level +=
-            each_block.confirm_level;
-      }
+void UnresolvedBlockPool::setLinked(int bin_idx, size_t vector_idx,
+                                    bool linked) {
+  auto &t_block = m_block_pool[bin_idx][vector_idx];
+  t_block.linked = linked;
+  if (linked)
+    updateTip(BlockPosOnMap(t_block.block->getHeight(), vector_idx));
+
+  for (auto &each_idx : t_block.next_vector_idx)
+    setLinked(bin_idx + 1, each_idx, linked);
+}
+
+// the tip is the highest linked block; on a tie, the one met first when
+// walking the bins in vector order from the root
+void UnresolvedBlockPool::updateTip(const BlockPosOnMap &candidate) {
+  if (candidate.height > m_tip_pos.height ||
+      (candidate.height == m_tip_pos.height &&
+       precedesInWalk(candidate, m_tip_pos)))
+    m_tip_pos = candidate;
+}
+
+bool UnresolvedBlockPool::precedesInWalk(const BlockPosOnMap &pos_a,
+                                         const BlockPosOnMap &pos_b) {
+  auto getPath = [this](const BlockPosOnMap &pos) {
+    std::vector<int> path;
+    int queue_idx = static_cast<int>(pos.vector_idx);
+    for (int i = getBinIdx(pos.height); i >= 0 && queue_idx >= 0; --i) {
+      path.emplace_back(queue_idx);
+      queue_idx = m_block_pool[i][queue_idx].prev_vector_idx;
     }
+    return std::vector<int>(path.rbegin(), path.rend());
+  };
+
+  return getPath(pos_a) < getPath(pos_b);
+}
+
+void UnresolvedBlockPool::rebuildTip() {
+  m_tip_pos = BlockPosOnMap(0, 0);
+
+  if (m_block_pool.empty())
+    return;
+
+  for (size_t i = 0; i < m_block_pool[0].size(); ++i) {
+    if (m_block_pool[0][i].prev_vector_idx == 0)
+      setLinked(0, i, true);
   }
 }
 } // namespace gruut
\ No newline at end of file
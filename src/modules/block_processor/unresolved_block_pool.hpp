@@ -8,25 +8,39 @@
 #include "../../services/layered_storage.hpp"
 #include "../../utils/type_converter.hpp"
 
+#include <atomic>
 #include <deque>
+#include <functional>
 #include <list>
+#include <memory>
+#include <set>
+#include <unordered_map>
 #include <vector>
 
 namespace gruut {
 
 const std::string UNRESOLVED_BLOCK_IDS_KEY = "UNRESOLVED_BLOCK_IDS_KEY";
+const std::string UNRESOLVED_LOG_HEAD_KEY = "UNRESOLVED_LOG_HEAD_KEY";
+const std::string UNRESOLVED_LOG_TAIL_KEY = "UNRESOLVED_LOG_TAIL_KEY";
+const std::string UNRESOLVED_LOG_ENTRY_KEY = "UNRESOLVED_LOG_";
+
+// takes a block that has just been linked, with its block layer, to the
+// ledgers
+using ledger_forwarder_t =
+    std::function<void(const Block &block, const block_layer_t &block_layer)>;
 
 struct UnresolvedBlock {
   int prev_vector_idx{-1};
-  bool linked{false};
-  size_t confirm_level{0};
+  std::vector<size_t> next_vector_idx; // children in the next bin, ascending
+  bool linked{false};                  // reachable from the last saved block
+  size_t confirm_level{0}; // #ssigs of this block and all its descendants
   block_layer_t block_layer;
-  Block block;
+  std::shared_ptr<const Block> block; // shared with ledgers and requesters
 
   UnresolvedBlock() = default;
-  UnresolvedBlock(Block &block_, int prev_queue_idx_, size_t confirm_level_,
-                  bool init_linked_)
-      : block(block_), prev_vector_idx(prev_queue_idx_),
+  UnresolvedBlock(std::shared_ptr<const Block> block_, int prev_queue_idx_,
+                  size_t confirm_level_, bool init_linked_)
+      : block(std::move(block_)), prev_vector_idx(prev_queue_idx_),
         confirm_level(confirm_level_), linked(init_linked_) {}
 };
 
@@ -59,26 +73,44 @@ private:
   std::atomic<bool> m_has_cache_block_layer{false};
   std::vector<std::string> m_cache_possible_block_layer;
 
-  std::atomic<bool> m_has_cache_pos{false};
-  BlockPosOnMap m_cache_possible_pos;
+  // maintained on every change, so the tip is always at hand
+  BlockPosOnMap m_tip_pos;
+
+  // raw block id / hash -> position
+  std::unordered_map<std::string, BlockPosOnMap> m_id_index;
+  std::unordered_map<std::string, BlockPosOnMap> m_hash_index;
 
+  Storage *m_storage;
   LayeredStorage *m_layered_storage;
+  ledger_forwarder_t m_ledger_forwarder;
+
+  // backup = full image (ids + blocks) followed by an append-only delta log
+  std::set<std::string> m_backup_base_ids;
+  uint64_t m_backup_log_head{0};
+  uint64_t m_backup_log_tail{0};
 
 public:
   UnresolvedBlockPool();
+  // a pool apart from the node's: backups go to storage, linked blocks to
+  // ledger_forwarder, and no block layer is published
+  UnresolvedBlockPool(Storage *storage, ledger_forwarder_t ledger_forwarder);
   inline size_t size() { return m_block_pool.size(); }
   inline bool empty() { return m_block_pool.empty(); }
-  inline void clear() { m_block_pool.clear(); }
+  inline block_height_type getHeightRangeMax() { return m_height_range_max; }
+  void clear();
   void setPool(const block_id_type &last_block_id,
                const block_id_type &prev_block_id, const hash_t &last_hash,
                const hash_t &prev_hash, block_height_type last_height,
                timestamp_t last_time);
   bool prepareBins(block_height_type t_height);
   void invalidateCaches();
-  unblk_push_result_type push(Block &block, bool is_restore = false);
+  unblk_push_result_type push(std::shared_ptr<const Block> block,
+                              bool is_restore = false);
   bool getBlock(block_height_type t_height, const hash_t &t_prev_hash,
-                const hash_t &t_hash, Block &ret_block);
-  bool getBlock(block_height_type t_height, Block &ret_block);
+                const hash_t &t_hash,
+                std::shared_ptr<const Block> &ret_block);
+  bool getBlock(block_height_type t_height,
+                std::shared_ptr<const Block> &ret_block);
   void getResolvedBlocks(std::vector<UnresolvedBlock> &resolved_blocks,
                          std::vector<std::string> &drop_blocks);
   nth_link_type getUnresolvedLowestLink();
@@ -93,8 +125,18 @@ private:
   void forwardBlocksToLedgerFrom(int bin_idx, int vector_idx);
   json readBackupIds();
   void backupPool();
+  void appendBackupLog(char op, const std::string &payload);
+  void backupPoolIf();
+  bool readBackupLog(uint64_t seq, char &op, std::string &payload);
+  std::string getBackupLogKey(uint64_t seq);
   BlockPosOnMap getLongestBlockPos();
-  void updateConfirmLevel();
+  UnresolvedBlock *getBlockAt(const BlockPosOnMap &pos);
+  int getBinIdx(block_height_type height);
+  void linkToParent(int bin_idx, size_t vector_idx);
+  void setLinked(int bin_idx, size_t vector_idx, bool linked);
+  void updateTip(const BlockPosOnMap &candidate);
+  bool precedesInWalk(const BlockPosOnMap &pos_a, const BlockPosOnMap &pos_b);
+  void rebuildTip();
 };
 } // namespace gruut
 
@@ -0,0 +1,264 @@
+#include "block_range_scheduler.hpp"
+#include "../../utils/safe.hpp"
+#include "../../utils/type_converter.hpp"
+
+#include "easy_logging.hpp"
+
+#include <algorithm>
+
+namespace gruut {
+
+BlockRangeScheduler::BlockRangeScheduler() {
+  el::Loggers::getLogger("BSYN");
+}
+
+void BlockRangeScheduler::addPeer(const std::string &peer_id_b64) {
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+
+  SyncPeer sync_peer;
+  sync_peer.id = TypeConverter::decodeBase64(peer_id_b64);
+  m_sync_peers.emplace(peer_id_b64, sync_peer);
+}
+
+size_t BlockRangeScheduler::numPeers() {
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+  return m_sync_peers.size();
+}
+
+void BlockRangeScheduler::planRanges(block_height_type from_height,
+                                     block_height_type to_height,
+                                     size_t range_size) {
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+
+  for (block_height_type height = from_height; height <= to_height;
+       height += range_size) {
+    m_pending_ranges.emplace_back(
+        height,
+        std::min<block_height_type>(to_height, height + range_size - 1));
+  }
+}
+
+// keeps up to MAX_OUTSTANDING_BLOCK_RANGE requests in flight per peer
+std::vector<BlockRangeRequest>
+BlockRangeScheduler::assignRanges(bool header_only, timestamp_t current_time) {
+  std::vector<BlockRangeRequest> request_this_time;
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+
+  while (!m_pending_ranges.empty()) {
+    SyncPeer *sync_peer = pickPeerLocked();
+    if (sync_peer == nullptr)
+      break;
+
+    BlockRangeRequest range_request;
+    range_request.from_height = m_pending_ranges.front().first;
+    range_request.to_height = m_pending_ranges.front().second;
+    range_request.header_only = header_only;
+    range_request.request_time = current_time;
+    range_request.peer_id_b64 = TypeConverter::encodeBase64(sync_peer->id);
+    range_request.sent_time = std::chrono::steady_clock::now();
+    m_pending_ranges.pop_front();
+
+    ++sync_peer->num_outstanding;
+    m_outstanding_ranges[range_request.from_height] = range_request;
+    request_this_time.emplace_back(range_request);
+  }
+
+  return request_this_time;
+}
+
+bool BlockRangeScheduler::receiveRange(InputMsgEntry &entry) {
+  block_height_type from_height = Safe::getInt(entry.body, "from");
+  block_height_type to_height = Safe::getInt(entry.body, "to");
+  std::string sender_id_b64 = Safe::getString(entry.body, "mID");
+  bool header_only = (Safe::getString(entry.body, "hdr") == "1");
+
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+
+  auto it_map = m_outstanding_ranges.find(from_height);
+  if (it_map == m_outstanding_ranges.end() ||
+      it_map->second.peer_id_b64 != sender_id_b64 ||
+      it_map->second.header_only != header_only)
+    return false; // late reply to a range that has been reassigned
+
+  BlockRangeRequest &range_request = it_map->second;
+
+  // nothing past the range asked for is taken, or the next range would
+  // never be fed; the responder may also stop early at its byte budget, so
+  // the rest is asked for next
+  block_height_type done_height = std::max(
+      std::min(to_height, range_request.to_height), from_height - 1);
+  if (done_height < range_request.to_height)
+    m_pending_ranges.emplace_front(done_height + 1, range_request.to_height);
+
+  auto it_peer = m_sync_peers.find(sender_id_b64);
+  if (it_peer != m_sync_peers.end()) {
+    SyncPeer &sync_peer = it_peer->second;
+    --sync_peer.num_outstanding;
+    sync_peer.num_blocks += done_height + 1 - from_height;
+    sync_peer.total_response_us +=
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - range_request.sent_time)
+            .count();
+  }
+
+  m_outstanding_ranges.erase(it_map);
+
+  if (done_height < from_height)
+    return true;
+
+  auto &blocks_json = entry.body["blocks"];
+  size_t num_blocks = done_height + 1 - from_height;
+  if (blocks_json.is_array() && blocks_json.size() > num_blocks)
+    blocks_json.erase(blocks_json.begin() + num_blocks, blocks_json.end());
+  entry.body["to"] = std::to_string(done_height);
+
+  m_received_ranges[from_height] = std::move(entry);
+  return true;
+}
+
+bool BlockRangeScheduler::takeNextRange(block_height_type &from_height,
+                                        InputMsgEntry &entry) {
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+
+  auto it_map = m_received_ranges.begin();
+  if (it_map == m_received_ranges.end() ||
+      it_map->first != m_next_feed_height)
+    return false;
+
+  from_height = it_map->first;
+  entry = std::move(it_map->second);
+  m_received_ranges.erase(it_map);
+  return true;
+}
+
+void BlockRangeScheduler::setNextFeedHeight(block_height_type height) {
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+  m_next_feed_height = height;
+}
+
+// the merger serves no more ranges, and the rest of [from_height,
+// to_height] as well as whatever else it holds is given out again
+void BlockRangeScheduler::abandonFrom(block_height_type from_height,
+                                      block_height_type to_height,
+                                      const std::string &peer_id_b64) {
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+
+  auto it_peer = m_sync_peers.find(peer_id_b64);
+  if (it_peer != m_sync_peers.end())
+    it_peer->second.num_fail = config::MAX_SYNC_PEER_FAIL;
+
+  auto it_received = m_received_ranges.begin();
+  while (it_received != m_received_ranges.end()) {
+    if (Safe::getString(it_received->second.body, "mID") == peer_id_b64) {
+      m_pending_ranges.emplace_front(
+          it_received->first, Safe::getInt(it_received->second.body, "to"));
+      it_received = m_received_ranges.erase(it_received);
+    } else {
+      ++it_received;
+    }
+  }
+
+  auto it_outstanding = m_outstanding_ranges.begin();
+  while (it_outstanding != m_outstanding_ranges.end()) {
+    if (it_outstanding->second.peer_id_b64 == peer_id_b64) {
+      if (it_peer != m_sync_peers.end())
+        --it_peer->second.num_outstanding;
+      m_pending_ranges.emplace_front(it_outstanding->second.from_height,
+                                     it_outstanding->second.to_height);
+      it_outstanding = m_outstanding_ranges.erase(it_outstanding);
+    } else {
+      ++it_outstanding;
+    }
+  }
+
+  m_pending_ranges.emplace_front(from_height, to_height);
+  m_next_feed_height = from_height;
+}
+
+// gives ranges of silent peers to others; a peer timing out
+// MAX_SYNC_PEER_FAIL times gets no more ranges
+bool BlockRangeScheduler::retryTimedOut(timestamp_t current_time) {
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+
+  auto it_map = m_outstanding_ranges.begin();
+  while (it_map != m_outstanding_ranges.end()) {
+    if (current_time >
+        it_map->second.request_time + config::BLOCK_RANGE_REQ_TIMEOUT) {
+      auto it_peer = m_sync_peers.find(it_map->second.peer_id_b64);
+      if (it_peer != m_sync_peers.end()) {
+        --it_peer->second.num_outstanding;
+        if (++it_peer->second.num_fail == config::MAX_SYNC_PEER_FAIL)
+          CLOG(ERROR, "BSYN") << "Merger [" << it_peer->first
+                              << "] dropped from block sync";
+      }
+
+      m_pending_ranges.emplace_front(it_map->second.from_height,
+                                     it_map->second.to_height);
+      it_map = m_outstanding_ranges.erase(it_map);
+    } else {
+      ++it_map;
+    }
+  }
+
+  if (m_sync_peers.empty() || m_pending_ranges.empty())
+    return true; // nothing to give out
+
+  for (auto &each_peer : m_sync_peers) {
+    if (each_peer.second.isHealthy())
+      return true;
+  }
+
+  return false;
+}
+
+std::map<std::string, SyncPeer> BlockRangeScheduler::getPeers() {
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+  return m_sync_peers;
+}
+
+SyncPeer *BlockRangeScheduler::pickPeer() {
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+  return pickPeerLocked();
+}
+
+SyncPeer *BlockRangeScheduler::getPeer(const std::string &peer_id_b64) {
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+  auto it_peer = m_sync_peers.find(peer_id_b64);
+  return (it_peer == m_sync_peers.end()) ? nullptr : &it_peer->second;
+}
+
+std::deque<std::pair<block_height_type, block_height_type>>
+BlockRangeScheduler::getPendingRanges() {
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+  return m_pending_ranges;
+}
+
+size_t BlockRangeScheduler::numOutstanding() {
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+  return m_outstanding_ranges.size();
+}
+
+size_t BlockRangeScheduler::numReceived() {
+  std::lock_guard<std::mutex> guard(m_range_mutex);
+  return m_received_ranges.size();
+}
+
+// the healthy peer with a free slot and the best throughput so far
+SyncPeer *BlockRangeScheduler::pickPeerLocked() {
+  SyncPeer *best_peer = nullptr;
+  for (auto &each_peer : m_sync_peers) {
+    SyncPeer &sync_peer = each_peer.second;
+    if (!sync_peer.isHealthy() ||
+        sync_peer.num_outstanding >= config::MAX_OUTSTANDING_BLOCK_RANGE)
+      continue;
+
+    if (best_peer == nullptr ||
+        sync_peer.getThroughput() > best_peer->getThroughput() ||
+        (sync_peer.getThroughput() == best_peer->getThroughput() &&
+         sync_peer.num_outstanding < best_peer->num_outstanding))
+      best_peer = &sync_peer;
+  }
+
+  return best_peer;
+}
+} // namespace gruut
@@ -0,0 +1,95 @@
+#ifndef GRUUT_ENTERPRISE_MERGER_BLOCK_RANGE_SCHEDULER_HPP
+#define GRUUT_ENTERPRISE_MERGER_BLOCK_RANGE_SCHEDULER_HPP
+
+#include "../../chain/types.hpp"
+#include "../../config/config.hpp"
+#include "../../services/input_queue.hpp"
+
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gruut {
+
+struct BlockRangeRequest {
+  block_height_type from_height;
+  block_height_type to_height;
+  bool header_only;
+  timestamp_t request_time;
+  std::string peer_id_b64;
+  std::chrono::steady_clock::time_point sent_time;
+};
+
+// a merger at the sync target tip, serving block ranges
+struct SyncPeer {
+  merger_id_type id;
+  size_t num_outstanding{0};
+  size_t num_blocks{0};
+  uint64_t total_response_us{0};
+  size_t num_fail{0};
+
+  bool isHealthy() const { return num_fail < config::MAX_SYNC_PEER_FAIL; }
+
+  // blocks per second; a peer not heard from yet ranks first
+  double getThroughput() const {
+    if (total_response_us == 0)
+      return std::numeric_limits<double>::max();
+    return num_blocks * 1e6 / total_response_us;
+  }
+};
+
+// The catch-up ranges of the block synchronizer: not yet asked, in flight
+// and received (all keyed by from_height), and the mergers serving them.
+// Received ranges are taken back strictly in height order.
+class BlockRangeScheduler {
+private:
+  std::map<std::string, SyncPeer> m_sync_peers;
+  std::deque<std::pair<block_height_type, block_height_type>> m_pending_ranges;
+  std::map<block_height_type, BlockRangeRequest> m_outstanding_ranges;
+  std::map<block_height_type, InputMsgEntry> m_received_ranges;
+  block_height_type m_next_feed_height{0};
+  std::mutex m_range_mutex;
+
+public:
+  BlockRangeScheduler();
+
+  void addPeer(const std::string &peer_id_b64);
+  size_t numPeers();
+
+  // splits [from_height, to_height] into ranges of range_size blocks
+  void planRanges(block_height_type from_height, block_height_type to_height,
+                  size_t range_size);
+  // gives pending ranges to peers with a free slot, best first
+  std::vector<BlockRangeRequest> assignRanges(bool header_only,
+                                              timestamp_t current_time);
+  // a MSG_BLOCK_RANGE reply; false if it answers no range in flight
+  bool receiveRange(InputMsgEntry &entry);
+  // the received range starting at the next height to feed, if any
+  bool takeNextRange(block_height_type &from_height, InputMsgEntry &entry);
+  void setNextFeedHeight(block_height_type height);
+  // the merger serving [from_height, to_height] sent a bad block there
+  void abandonFrom(block_height_type from_height, block_height_type to_height,
+                   const std::string &peer_id_b64);
+  // false once no healthy peer is left for the ranges still to fetch
+  bool retryTimedOut(timestamp_t current_time);
+
+  std::map<std::string, SyncPeer> getPeers();
+  // the peer for the next range; callers hold no lock
+  SyncPeer *pickPeer();
+  SyncPeer *getPeer(const std::string &peer_id_b64);
+  std::deque<std::pair<block_height_type, block_height_type>>
+  getPendingRanges();
+  size_t numOutstanding();
+  size_t numReceived();
+
+private:
+  SyncPeer *pickPeerLocked();
+};
+} // namespace gruut
+
+#endif
@@ -1,5 +1,6 @@
 #include "block_synchronizer.hpp"
 #include "../../application.hpp"
+#include "../../services/certificate_pool.hpp"
 #include "../../services/message_proxy.hpp"
 
 #include "easy_logging.hpp"
@@ -19,6 +20,14 @@ BlockSynchronizer::BlockSynchronizer() {
 
   m_my_id = setting->getMyId();
 
+  m_get_cert_func = [](id_type &id) {
+    return CertificatePool::getInstance()->getCert(id);
+  };
+
+  m_verify_workers.reset(new WorkerPool(std::min<size_t>(
+      config::MAX_BLOCK_VERIFIER,
+      std::max(1u, std::thread::hardware_concurrency()))));
+
   el::Loggers::getLogger("BSYN");
 }
 
@@ -33,7 +42,19 @@ void BlockSynchronizer::syncFinish(ExitCode exit_code) {
     m_sync_finish_callback(exit_code);
     m_is_sync_done = true;
 
-    CLOG(INFO, "BSYN") << "BLOCK SYNCHRONIZATION ---- END";
+    size_t num_synced;
+    {
+      std::lock_guard<std::mutex> guard(m_sync_flags_mutex);
+      num_synced = std::count(m_sync_flags.begin(), m_sync_flags.end(), true);
+    }
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now() - m_sync_begin_time)
+                          .count();
+
+    logSyncPeers();
+
+    CLOG(INFO, "BSYN") << "BLOCK SYNCHRONIZATION ---- END (#block="
+                       << num_synced << "," << elapsed_ms << "ms)";
   });
 }
 
@@ -42,6 +63,8 @@ void BlockSynchronizer::blockSyncControl() {
     return;
   }
 
+  retryTimedOutRanges();
+
   bool is_done = true;
   for (auto each_flag : m_sync_flags) {
     if (each_flag == false) {
@@ -102,20 +125,12 @@ void BlockSynchronizer::messageFetch() {
   case MessageType::MSG_BLOCK: {
     auto push_result =
         Application::app().getBlockProcessor().handleMsgBlock(input_msg_entry);
-    if (push_result.height > 0) {
-
-      std::lock_guard<std::mutex> guard(m_sync_flags_mutex);
-
-      if (push_result.height > m_link_from.height) {
-        size_t req_map_size = push_result.height - m_link_from.height;
-        if (m_sync_flags.size() < req_map_size)
-          m_sync_flags.resize(req_map_size, false);
-
-        m_sync_flags[req_map_size - 1] = true; // last or this
-      }
+    if (push_result.height > 0)
+      markSynced(push_result.height);
+  } break;
 
-      m_sync_flags_mutex.unlock();
-    }
+  case MessageType::MSG_BLOCK_RANGE: {
+    handleBlockRange(input_msg_entry);
   } break;
 
   case MessageType::MSG_RES_STATUS: {
@@ -159,6 +174,8 @@ void BlockSynchronizer::startBlockSync(std::function<void(ExitCode)> callback) {
 
   CLOG(INFO, "BSYN") << "BLOCK SYNCHRONIZATION ---- START";
 
+  m_sync_begin_time = std::chrono::steady_clock::now();
+
   m_link_from = Application::app().getBlockProcessor().getMostPossibleLink();
 
   sendRequestStatus();
@@ -210,16 +227,48 @@ void BlockSynchronizer::sendRequestLastBlock() {
   }
 
   if (last_block_height > m_link_from.height) {
-    sendRequestBlock(last_block_height, last_block_hash_b64,
-                     TypeConverter::decodeBase64(t_merger_id_b64));
+    if (!config::HEADER_FIRST_SYNC)
+      sendRequestBlock(last_block_height, last_block_hash_b64,
+                       TypeConverter::decodeBase64(t_merger_id_b64));
 
-    std::lock_guard<std::mutex> guard(m_sync_flags_mutex);
+    {
+      std::lock_guard<std::mutex> guard(m_sync_flags_mutex);
 
-    size_t req_map_size = last_block_height - m_link_from.height;
-    if (m_sync_flags.size() < req_map_size)
-      m_sync_flags.resize(req_map_size, false);
+      size_t req_map_size = last_block_height - m_link_from.height;
+      if (m_sync_flags.size() < req_map_size)
+        m_sync_flags.resize(req_map_size, false);
+    }
 
-    m_sync_flags_mutex.unlock();
+    // every merger agreeing on the tip serves a share of the gap
+    for (auto &status_dat : m_chain_status) {
+      if (status_dat.second.height != last_block_height ||
+          status_dat.second.hash_b64 != last_block_hash_b64)
+        continue;
+
+      m_range_scheduler.addPeer(status_dat.first);
+    }
+
+    m_range_scheduler.setNextFeedHeight(m_link_from.height + 1);
+    m_sync_to_height = last_block_height;
+    m_sync_to_hash_b64 = last_block_hash_b64;
+    m_last_trusted_hash = m_link_from.hash;
+    m_last_trusted_id = m_link_from.id;
+    m_sync_phase =
+        config::HEADER_FIRST_SYNC ? SyncPhase::HEADER : SyncPhase::BODY;
+
+    CLOG(INFO, "BSYN") << "Syncing " << m_link_from.height + 1 << "-"
+                       << last_block_height << " from "
+                       << m_range_scheduler.numPeers() << " merger(s)";
+
+    if (config::HEADER_FIRST_SYNC) {
+      m_range_scheduler.planRanges(m_link_from.height + 1, last_block_height,
+                                   config::MAX_HEADER_RANGE_SIZE);
+    } else {
+      m_range_scheduler.planRanges(m_link_from.height + 1,
+                                   last_block_height - 1,
+                                   config::MAX_BLOCK_RANGE_SIZE);
+    }
+    sendRequestRangesIf();
   }
 
   m_is_sync_begin = true;
@@ -246,6 +295,222 @@ void BlockSynchronizer::sendRequestBlock(size_t height,
   m_msg_proxy.deliverOutputMessage(msg_req_block);
 }
 
+void BlockSynchronizer::sendRequestRangesIf() {
+  for (auto &each_request : m_range_scheduler.assignRanges(
+           m_sync_phase == SyncPhase::HEADER, Time::now_int()))
+    sendRequestRange(each_request);
+}
+
+void BlockSynchronizer::sendRequestRange(
+    const BlockRangeRequest &range_request) {
+
+  OutputMsgEntry msg_req_range;
+  msg_req_range.type = MessageType::MSG_REQ_BLOCK_RANGE;
+  msg_req_range.body["mID"] = TypeConverter::encodeBase64(m_my_id); // my_id
+  msg_req_range.body["time"] = Time::now();
+  msg_req_range.body["mCert"] = "";
+  msg_req_range.body["from"] = std::to_string(range_request.from_height);
+  msg_req_range.body["to"] = std::to_string(range_request.to_height);
+  msg_req_range.body["maxBytes"] =
+      std::to_string(config::MAX_BLOCK_RANGE_BYTES);
+  msg_req_range.body["hdr"] = range_request.header_only ? "1" : "0";
+  msg_req_range.body["mSig"] = "";
+  msg_req_range.receivers = {
+      TypeConverter::decodeBase64(range_request.peer_id_b64)};
+
+  CLOG(INFO, "BSYN") << "send MSG_REQ_BLOCK_RANGE ("
+                     << range_request.from_height << "-"
+                     << range_request.to_height
+                     << (range_request.header_only ? ",header" : "")
+                     << ") to "
+                     << range_request.peer_id_b64;
+
+  m_msg_proxy.deliverOutputMessage(msg_req_range);
+}
+
+void BlockSynchronizer::handleBlockRange(InputMsgEntry &entry) {
+  if (!m_range_scheduler.receiveRange(entry))
+    return;
+
+  feedReceivedRanges();
+  sendRequestRangesIf();
+}
+
+// hands received ranges on strictly in height order; a range that breaks
+// off early is asked again from the other mergers
+void BlockSynchronizer::feedReceivedRanges() {
+  std::lock_guard<std::mutex> feed_guard(m_feed_mutex);
+
+  while (true) {
+    InputMsgEntry range_entry;
+    block_height_type from_height;
+    if (!m_range_scheduler.takeNextRange(from_height, range_entry))
+      return;
+
+    block_height_type to_height = Safe::getInt(range_entry.body, "to");
+    std::string sender_id_b64 = Safe::getString(range_entry.body, "mID");
+
+    block_height_type done_height =
+        (m_sync_phase == SyncPhase::HEADER)
+            ? feedHeaders(range_entry, from_height)
+            : feedBodies(range_entry, from_height);
+
+    if (done_height < to_height) {
+      abandonRangesFrom(done_height + 1, to_height, sender_id_b64);
+      continue;
+    }
+
+    m_range_scheduler.setNextFeedHeight(done_height + 1);
+
+    if (m_sync_phase == SyncPhase::HEADER && done_height == m_sync_to_height)
+      startBodyPhase();
+  }
+}
+
+// accepts headers extending the trusted chain with a valid merger signature,
+// up to the tip announced in MSG_RES_STATUS; returns the last accepted height
+block_height_type
+BlockSynchronizer::feedHeaders(InputMsgEntry &range_entry,
+                               block_height_type from_height) {
+  auto &blocks_json = range_entry.body["blocks"];
+  std::vector<std::shared_ptr<Block>> headers(blocks_json.size());
+  std::vector<std::function<void()>> verify_tasks;
+  verify_tasks.reserve(headers.size());
+
+  for (size_t i = 0; i < headers.size(); ++i) {
+    verify_tasks.emplace_back([this, &blocks_json, &headers, i]() {
+      bytes block_raw = Safe::getBytesFromB64(blocks_json[i], "blockraw");
+      auto header = std::make_shared<Block>();
+      if (header->initializeHeader(block_raw) &&
+          header->isValidHeader(m_get_cert_func))
+        headers[i] = header;
+    });
+  }
+  m_verify_workers->runAll(verify_tasks);
+
+  block_height_type done_height = from_height - 1;
+  for (auto &each_header : headers) {
+    if (!each_header || each_header->getHeight() != done_height + 1 ||
+        each_header->getPrevHash() != m_last_trusted_hash ||
+        each_header->getPrevBlockId() != m_last_trusted_id)
+      break;
+
+    if (each_header->getHeight() == m_sync_to_height &&
+        each_header->getHashB64() != m_sync_to_hash_b64)
+      break;
+
+    m_last_trusted_hash = each_header->getHash();
+    m_last_trusted_id = each_header->getBlockId();
+    m_trusted_hashes.emplace_back(m_last_trusted_hash);
+    ++done_height;
+  }
+
+  return done_height;
+}
+
+// decodes and verifies the blocks in parallel, then links them in order;
+// after the header phase each block must match its trusted header
+block_height_type BlockSynchronizer::feedBodies(InputMsgEntry &range_entry,
+                                                block_height_type from_height) {
+  auto &block_processor = Application::app().getBlockProcessor();
+  auto &blocks_json = range_entry.body["blocks"];
+  std::string sender_id_b64 = Safe::getString(range_entry.body, "mID");
+
+  std::vector<InputMsgEntry> block_entries(blocks_json.size());
+  std::vector<std::shared_ptr<const Block>> blocks(blocks_json.size());
+  std::vector<std::function<void()>> decode_tasks;
+  decode_tasks.reserve(blocks.size());
+
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    block_entries[i].type = MessageType::MSG_BLOCK;
+    block_entries[i].body = std::move(blocks_json[i]);
+    block_entries[i].body["mID"] = sender_id_b64;
+
+    decode_tasks.emplace_back([&block_processor, &block_entries, &blocks, i]() {
+      blocks[i] = block_processor.decodeBlock(block_entries[i]);
+    });
+  }
+  m_verify_workers->runAll(decode_tasks);
+
+  block_height_type done_height = from_height - 1;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    if (!blocks[i] || blocks[i]->getHeight() != done_height + 1)
+      break;
+
+    if (!m_trusted_hashes.empty()) {
+      size_t trusted_idx = blocks[i]->getHeight() - m_link_from.height - 1;
+      if (trusted_idx >= m_trusted_hashes.size() ||
+          m_trusted_hashes[trusted_idx] != blocks[i]->getHash())
+        break;
+    }
+
+    auto push_result =
+        block_processor.pushVerifiedBlock(blocks[i], block_entries[i]);
+    if (push_result.height > 0)
+      markSynced(push_result.height);
+    ++done_height;
+  }
+
+  return done_height;
+}
+
+// the merger sent a bad block at from_height; it serves no more ranges, and
+// the rest of [from_height, to_height] as well as whatever else it holds is
+// given out again
+void BlockSynchronizer::abandonRangesFrom(block_height_type from_height,
+                                          block_height_type to_height,
+                                          const std::string &peer_id_b64) {
+  CLOG(ERROR, "BSYN") << "Merger [" << peer_id_b64 << "] sent a bad "
+                      << (m_sync_phase == SyncPhase::HEADER ? "header"
+                                                            : "block")
+                      << " at height " << from_height;
+
+  m_range_scheduler.abandonFrom(from_height, to_height, peer_id_b64);
+}
+
+void BlockSynchronizer::startBodyPhase() {
+  CLOG(INFO, "BSYN") << "Header chain verified up to " << m_sync_to_height
+                     << "; fetching blocks";
+
+  m_sync_phase = SyncPhase::BODY;
+  m_range_scheduler.setNextFeedHeight(m_link_from.height + 1);
+  m_range_scheduler.planRanges(m_link_from.height + 1, m_sync_to_height,
+                               config::MAX_BLOCK_RANGE_SIZE);
+  sendRequestRangesIf();
+}
+
+void BlockSynchronizer::retryTimedOutRanges() {
+  if (!m_range_scheduler.retryTimedOut(Time::now_int())) {
+    CLOG(ERROR, "BSYN") << "No healthy merger left for block sync";
+    syncFinish(ExitCode::ERROR_SYNC_FAIL);
+    return;
+  }
+
+  sendRequestRangesIf();
+}
+
+void BlockSynchronizer::logSyncPeers() {
+  for (auto &each_peer : m_range_scheduler.getPeers()) {
+    CLOG(INFO, "BSYN") << "Merger [" << each_peer.first
+                       << "] #block=" << each_peer.second.num_blocks
+                       << ",time=" << each_peer.second.total_response_us / 1000
+                       << "ms,#fail=" << each_peer.second.num_fail;
+  }
+}
+
+void BlockSynchronizer::markSynced(block_height_type height) {
+  std::lock_guard<std::mutex> guard(m_sync_flags_mutex);
+
+  if (height <= m_link_from.height)
+    return;
+
+  size_t req_map_size = height - m_link_from.height;
+  if (m_sync_flags.size() < req_map_size)
+    m_sync_flags.resize(req_map_size, false);
+
+  m_sync_flags[req_map_size - 1] = true;
+}
+
 void BlockSynchronizer::sendRequestStatus() {
 
   OutputMsgEntry msg_req_status;
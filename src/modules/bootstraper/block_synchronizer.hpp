@@ -14,14 +14,19 @@
 #include "../../utils/rsa.hpp"
 #include "../../utils/sha256.hpp"
 #include "../../utils/type_converter.hpp"
+#include "../../utils/worker_pool.hpp"
+#include "block_range_scheduler.hpp"
 #include "nlohmann/json.hpp"
 
 #include <boost/asio.hpp>
 #include <chrono>
 #include <ctime>
+#include <deque>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <random>
@@ -37,6 +42,10 @@ struct OtherStatusData {
       : hash_b64(hash_b64_), height(height_) {}
 };
 
+// HEADER: fetch and verify the header chain of the whole gap first
+// BODY: fetch full blocks, checked against the trusted headers if any
+enum class SyncPhase { HEADER, BODY };
+
 class BlockSynchronizer {
 private:
   InputQueueAlt *m_inputQueue;
@@ -58,8 +67,23 @@ private:
 
   std::map<std::string, OtherStatusData> m_chain_status;
 
+  // catch-up ranges; received ones are fed to the pool in height order
+  BlockRangeScheduler m_range_scheduler;
+  std::chrono::steady_clock::time_point m_sync_begin_time;
+
+  std::atomic<SyncPhase> m_sync_phase{SyncPhase::BODY};
+  block_height_type m_sync_to_height{0};
+  std::string m_sync_to_hash_b64;
+  std::vector<hash_t> m_trusted_hashes; // [0] = m_link_from.height + 1
+  hash_t m_last_trusted_hash;
+  block_id_type m_last_trusted_id;
+
+  std::unique_ptr<WorkerPool> m_verify_workers;
+  std::function<std::string(id_type &)> m_get_cert_func;
+
   std::mutex m_chain_mutex;
   std::mutex m_sync_flags_mutex;
+  std::mutex m_feed_mutex;
 
 public:
   BlockSynchronizer();
@@ -72,6 +96,21 @@ private:
   void sendRequestBlock(size_t height, const std::string &block_hash_b64,
                         const merger_id_type &t_merger);
   void sendRequestStatus();
+  void sendRequestRangesIf();
+  void sendRequestRange(const BlockRangeRequest &range_request);
+  void handleBlockRange(InputMsgEntry &entry);
+  void feedReceivedRanges();
+  block_height_type feedHeaders(InputMsgEntry &range_entry,
+                                block_height_type from_height);
+  block_height_type feedBodies(InputMsgEntry &range_entry,
+                               block_height_type from_height);
+  void abandonRangesFrom(block_height_type from_height,
+                         block_height_type to_height,
+                         const std::string &peer_id_b64);
+  void startBodyPhase();
+  void retryTimedOutRanges();
+  void logSyncPeers();
+  void markSynced(block_height_type height);
   void sendErrorToSigner(InputMsgEntry &input_msg_entry);
   void syncFinish(ExitCode exit_code);
   void blockSyncControl();
@@ -97,6 +97,7 @@ void Bootstrapper::selfCheckUp() {
 void Bootstrapper::endSync(ExitCode exit_code) {
 
   std::call_once(m_endsync_flag, [this, &exit_code]() {
+    Application::app().getBlockProcessor().endBootstrap();
     sendMsgUp();
     stageOver(exit_code);
   });
@@ -1,15 +1,19 @@
 #include "communication.hpp"
 #include "../../application.hpp"
 #include "../../config/config.hpp"
+#include "grpc_util.hpp"
 #include <thread>
 
 namespace gruut {
 Communication::Communication() {
   el::Loggers::getLogger("COMM");
-  m_port_num = Setting::getInstance()->getMyPort();
+  auto setting = Setting::getInstance();
+  m_port_num = setting->getMyPort();
   if (m_port_num.empty())
     m_port_num = config::DEFAULT_PORT_NUM;
 
+  HeaderController::setIdField(setting->getLocalChainId(), setting->getMyId());
+
   m_merger_client.setup();
 
   setUpConnList();
@@ -1,6 +1,5 @@
 #include "grpc_util.hpp"
 #include "../../config/config.hpp"
-#include "../../services/setting.hpp"
 #include "../../utils/compressor.hpp"
 #include "json-schema.hpp"
 #include "msg_schema.hpp"
@@ -11,15 +10,29 @@
 #include "easy_logging.hpp"
 
 namespace gruut {
-std::string
-HeaderController::attachHeader(std::string &compressed_json,
-                               MessageType msg_type,
-                               CompressionAlgorithmType compression_algo_type) {
-  std::string header;
-  uint32_t total_length =
-      static_cast<uint32_t>(HEADER_LENGTH + compressed_json.size());
-
-  header.resize(HEADER_LENGTH);
+std::string HeaderController::m_id_field(CHAIN_ID_TYPE_SIZE + SENDER_ID_LENGTH +
+                                             RESERVED_LENGTH,
+                                         0);
+
+void HeaderController::setIdField(const localchain_id_type &chain_id,
+                                  const id_type &sender_id) {
+  memcpy(&m_id_field[0], &chain_id[0], CHAIN_ID_TYPE_SIZE);
+
+  if (sender_id.size() >= SENDER_ID_LENGTH)
+    memcpy(&m_id_field[CHAIN_ID_TYPE_SIZE], &sender_id[0], SENDER_ID_LENGTH);
+
+  memcpy(&m_id_field[CHAIN_ID_TYPE_SIZE + SENDER_ID_LENGTH], &RESERVED[0],
+         RESERVED_LENGTH);
+}
+
+// fills in the header at the front of packed_msg; its first HEADER_LENGTH
+// bytes are left for the header and the body is already in place
+void HeaderController::writeHeader(
+    std::string &packed_msg, MessageType msg_type,
+    CompressionAlgorithmType compression_algo_type) {
+  uint32_t total_length = static_cast<uint32_t>(packed_msg.size());
+
+  char *header = &packed_msg[0];
   header[0] = G;
   header[1] = VERSION;
   header[2] = static_cast<uint8_t>(msg_type);
@@ -31,28 +44,19 @@ HeaderController::attachHeader(std::string &compressed_json,
   }
   header[4] = static_cast<uint8_t>(compression_algo_type);
   header[5] = NOT_USED;
-  for (int i = 9; i > 6; --i) {
-    header[i] |= total_length;
+  for (int i = 9; i > 5; --i) {
+    header[i] = static_cast<uint8_t>(total_length);
     total_length = (total_length >> 8);
   }
-  header[6] |= total_length;
-
-  auto setting = Setting::getInstance();
-  id_type sender_id = setting->getMyId();
-  localchain_id_type chain_id = setting->getLocalChainId();
-
-  memcpy(&header[10], &chain_id[0], CHAIN_ID_TYPE_SIZE);
-
-  if (sender_id.size() >= SENDER_ID_LENGTH)
-    memcpy(&header[10 + CHAIN_ID_TYPE_SIZE], &sender_id[0], SENDER_ID_LENGTH);
 
-  memcpy(&header[10 + CHAIN_ID_TYPE_SIZE + SENDER_ID_LENGTH], &RESERVED[0],
-         RESERVED_LENGTH);
-
-  return header + compressed_json;
+  memcpy(&header[10], m_id_field.data(), m_id_field.size());
 }
 
 MessageHeader HeaderController::parseHeader(std::string &raw_data) {
+  return parseHeader(raw_data.data());
+}
+
+MessageHeader HeaderController::parseHeader(const char *raw_data) {
   MessageHeader msg_header;
   msg_header.sender_id.resize(SENDER_ID_LENGTH);
   msg_header.identifier = static_cast<uint8_t>(raw_data[0]);
@@ -96,4 +100,35 @@ bool JsonValidator::validateSchema(json &json_object, MessageType msg_type) {
     return false;
   }
 }
+// field 1 (data), wire type 2 (length-delimited)
+static const uint8_t MERGER_FRAME_DATA_TAG = 0x0A;
+
+std::string MergerFrame::makePrefix(size_t data_size) {
+  std::string prefix(1, static_cast<char>(MERGER_FRAME_DATA_TAG));
+  do {
+    uint8_t varint_byte = data_size & 0x7F;
+    data_size >>= 7;
+    if (data_size != 0)
+      varint_byte |= 0x80;
+    prefix.push_back(static_cast<char>(varint_byte));
+  } while (data_size != 0);
+  return prefix;
+}
+
+size_t MergerFrame::readPrefix(const char *frame, size_t frame_size) {
+  auto bytes = reinterpret_cast<const uint8_t *>(frame);
+  if (frame_size == 0 || bytes[0] != MERGER_FRAME_DATA_TAG)
+    return 0;
+
+  uint64_t data_size = 0;
+  size_t pos = 1;
+  for (int shift = 0; pos < frame_size && shift < 64; shift += 7) {
+    uint8_t varint_byte = bytes[pos++];
+    data_size |= static_cast<uint64_t>(varint_byte & 0x7F) << shift;
+    if ((varint_byte & 0x80) == 0)
+      return (data_size == frame_size - pos) ? pos : 0;
+  }
+  return 0;
+}
+
 } // namespace gruut
\ No newline at end of file
@@ -12,13 +12,35 @@
 
 namespace gruut {
 
+// MergerStream.openStream in protobuf_merger.proto; it is served through
+// the generic service, as the checked-in gRPC sources predate it
+const std::string MERGER_STREAM_METHOD = "/grpc_merger.MergerStream/openStream";
+
+// A stream frame is a serialized MergerDataRequest whose data is packed
+// messages laid end to end. Only the field tag and length are written here,
+// so the messages themselves go out without being copied into the frame.
+class MergerFrame {
+public:
+  static std::string makePrefix(size_t data_size);
+  // the size of the prefix in front of the data, or 0 if it is malformed
+  static size_t readPrefix(const char *frame, size_t frame_size);
+};
+
 class HeaderController {
 public:
-  static std::string
-  attachHeader(std::string &compressed_json, MessageType msg_type,
-               CompressionAlgorithmType compression_algo_type);
+  // the chain id and sender id are the same in every header; they are set
+  // once Setting is loaded, before anything is packed
+  static void setIdField(const localchain_id_type &chain_id,
+                         const id_type &sender_id);
+  static void writeHeader(std::string &packed_msg, MessageType msg_type,
+                          CompressionAlgorithmType compression_algo_type);
   static MessageHeader parseHeader(std::string &raw_data);
+  static MessageHeader parseHeader(const char *raw_data);
   static int convertU8ToU32BE(std::array<uint8_t, MSG_LENGTH_SIZE> &len_bytes);
+
+private:
+  // chain id, sender id and reserved bytes, all zero until setIdField()
+  static std::string m_id_field;
 };
 class JsonValidator {
 public:
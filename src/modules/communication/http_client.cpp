@@ -1,59 +1,54 @@
 #include "http_client.hpp"
-#include <iostream>
+
+#include <future>
 
 using namespace std;
 
 namespace gruut {
 HttpClient::HttpClient(const string &m_address) : m_address(m_address) {
+  m_client_pool = HttpClientPool::getInstance();
   el::Loggers::getLogger("HTTP");
 }
 
-CURLcode HttpClient::post(const string &packed_msg) {
-  try {
-    m_curl.setOpt(CURLOPT_URL, m_address.data());
-    m_curl.setOpt(CURLOPT_POST, 1L);
-    m_curl.setOpt(CURLOPT_TIMEOUT, 2L);
-
-    const auto escaped_field_data = m_curl.escape(packed_msg);
-    const string post_field = getPostField("message", escaped_field_data);
-    CLOG(INFO, "HTTP") << "POST (" << m_address << ", " << post_field.size()
-                       << "bytes )";
-
-    m_curl.setOpt(CURLOPT_POSTFIELDS, post_field.data());
-    m_curl.setOpt(CURLOPT_POSTFIELDSIZE, post_field.size());
-
-    m_curl.perform();
-  } catch (curlpp::EasyException &err) {
-    CLOG(ERROR, "HTTP") << err.what();
-    return err.getErrorId();
-  }
-
-  return CURLE_OK;
+// queued; the result is only logged
+bool HttpClient::post(const string &msg) {
+  HttpRequest http_request = makeRequest(msg);
+  http_request.timeout = config::HTTP_POST_TIMEOUT;
+  return m_client_pool->request(std::move(http_request));
 }
 
+// curl gives up after HTTP_REPLY_TIMEOUT; the wait here is only a backstop
+// in case the pool never calls back
 CURLcode HttpClient::postAndGetReply(const string &msg, json &response_json) {
-  try {
-    m_curl.setOpt(CURLOPT_URL, m_address.data());
-    m_curl.setOpt(CURLOPT_POST, 1L);
-
-    const auto escaped_filed_data = m_curl.escape(msg);
-    const string post_field = getPostField("message", escaped_filed_data);
-    CLOG(INFO, "HTTP") << "POST (" << m_address << ", " << post_field.size()
-                       << "bytes )";
-
-    m_curl.setOpt(CURLOPT_POSTFIELDS, post_field.data());
-    m_curl.setOpt(CURLOPT_POSTFIELDSIZE, post_field.size());
+  auto reply = std::make_shared<std::promise<std::pair<CURLcode, string>>>();
+  auto reply_future = reply->get_future();
+
+  HttpRequest http_request = makeRequest(msg);
+  http_request.timeout = config::HTTP_REPLY_TIMEOUT;
+  http_request.done = [reply](CURLcode result, string &response) {
+    reply->set_value(std::make_pair(result, std::move(response)));
+  };
+  m_client_pool->request(std::move(http_request));
+
+  if (reply_future.wait_for(std::chrono::seconds(
+          config::HTTP_REPLY_TIMEOUT + 1)) != std::future_status::ready) {
+    CLOG(ERROR, "HTTP") << "POST (" << m_address << ") - no reply";
+    return CURLE_OPERATION_TIMEDOUT;
+  }
 
-    string http_response;
-    m_curl.setOpt(CURLOPT_WRITEFUNCTION, writeCallback);
-    m_curl.setOpt(CURLOPT_WRITEDATA, &http_response);
-    m_curl.perform();
+  std::pair<CURLcode, string> result;
+  try {
+    result = reply_future.get();
+  } catch (std::future_error &err) { // the pool dropped the request
+    CLOG(ERROR, "HTTP") << "POST (" << m_address << ") - " << err.what();
+    return CURLE_GOT_NOTHING;
+  }
 
-    response_json = json::parse(http_response);
+  if (result.first != CURLE_OK)
+    return result.first;
 
-  } catch (curlpp::EasyException &err) {
-    CLOG(ERROR, "HTTP") << err.what();
-    return err.getErrorId();
+  try {
+    response_json = json::parse(result.second);
   } catch (json::parse_error &err) {
     CLOG(ERROR, "HTTP") << err.what();
     return CURLE_HTTP_POST_ERROR;
@@ -63,27 +58,48 @@ CURLcode HttpClient::postAndGetReply(const string &msg, json &response_json) {
 }
 
 bool HttpClient::checkServStatus() {
-  try {
-    m_curl.setOpt(CURLOPT_URL, m_address.data());
-    m_curl.setOpt(CURLOPT_FAILONERROR, 1L);
+  auto status = std::make_shared<std::promise<bool>>();
+  auto status_future = status->get_future();
+  m_client_pool->request(makeCheckRequest(
+      [status](bool is_alive) { status->set_value(is_alive); }));
 
-    m_curl.perform();
-  } catch (curlpp::EasyException &err) {
+  if (status_future.wait_for(std::chrono::seconds(
+          config::HTTP_CHECK_TIMEOUT + 1)) != std::future_status::ready)
+    return false;
+
+  try {
+    return status_future.get();
+  } catch (std::future_error &) { // the pool dropped the request
     return false;
   }
-  return true;
 }
 
-std::string HttpClient::getPostField(const string &key, const string &value) {
-  const string post_field = key + "=" + value;
-  return post_field;
+// returns false, and done is not called, while an earlier check of the
+// endpoint is still running
+bool HttpClient::checkServStatus(std::function<void(bool)> done) {
+  HttpRequest http_request = makeCheckRequest(std::move(done));
+  http_request.skip_if_running = true;
+  return m_client_pool->request(std::move(http_request));
+}
+
+HttpRequest HttpClient::makeCheckRequest(std::function<void(bool)> done) {
+  HttpRequest http_request;
+  http_request.url = m_address;
+  http_request.is_post = false;
+  http_request.fail_on_error = true;
+  http_request.timeout = config::HTTP_CHECK_TIMEOUT;
+  http_request.done = [done](CURLcode result, string &) {
+    done(result == CURLE_OK);
+  };
+  return http_request;
 }
 
-size_t HttpClient::writeCallback(const char *in, size_t size, size_t num,
-                                 string *out) {
-  const std::size_t total_bytes(size * num);
-  out->append(in, total_bytes);
-  return total_bytes;
+HttpRequest HttpClient::makeRequest(const string &msg) {
+  HttpRequest http_request;
+  http_request.url = m_address;
+  http_request.msg = msg;
+  http_request.raw_body = config::HTTP_RAW_BODY;
+  return http_request;
 }
 
 } // namespace gruut
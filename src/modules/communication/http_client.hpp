@@ -1,30 +1,36 @@
 #ifndef GRUUT_ENTERPRISE_MERGER_HTTP_CLIENT_HPP
 #define GRUUT_ENTERPRISE_MERGER_HTTP_CLIENT_HPP
 
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
 
 #include "curlpp.hpp"
 #include "easy_logging.hpp"
+#include "http_client_pool.hpp"
 
 #include "../../utils/safe.hpp"
 
 namespace gruut {
+// A cheap handle on one endpoint; the requests themselves go through the
+// shared HttpClientPool.
 class HttpClient {
 public:
   HttpClient() { el::Loggers::getLogger("HTTP"); }
   HttpClient(const std::string &m_address);
 
-  CURLcode post(const std::string &packed_msg);
+  // false if the request could not be queued
+  bool post(const std::string &msg);
   CURLcode postAndGetReply(const std::string &msg, json &json_data);
   bool checkServStatus();
+  bool checkServStatus(std::function<void(bool)> done);
 
 private:
-  std::string getPostField(const std::string &key, const std::string &value);
-  static size_t writeCallback(const char *in, size_t size, size_t num,
-                              string *out);
+  HttpRequest makeRequest(const std::string &msg);
+  HttpRequest makeCheckRequest(std::function<void(bool)> done);
 
-  curlpp::Easy m_curl;
+  HttpClientPool *m_client_pool;
   std::string m_address;
 };
 } // namespace gruut
@@ -0,0 +1,164 @@
+#include "http_client_pool.hpp"
+
+#include "easy_logging.hpp"
+
+namespace gruut {
+
+HttpClientPool::HttpClientPool() {
+  el::Loggers::getLogger("HTTP");
+
+  m_multi = curl_multi_init();
+  curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                    static_cast<long>(config::MAX_HTTP_CONN_PER_HOST));
+
+  m_pool_thread = std::thread([this]() { runLoop(); });
+}
+
+// requests still in flight are dropped without calling them back
+HttpClientPool::~HttpClientPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_request_mutex);
+    m_stop = true;
+  }
+  curl_multi_wakeup(m_multi);
+
+  if (m_pool_thread.joinable())
+    m_pool_thread.join();
+
+  for (auto &transfer_entry : m_transfers)
+    curl_multi_remove_handle(m_multi, transfer_entry.first);
+  m_transfers.clear();
+  m_idle_curls.clear();
+
+  curl_multi_cleanup(m_multi);
+}
+
+// false if the request was skipped
+bool HttpClientPool::request(HttpRequest http_request) {
+  {
+    std::lock_guard<std::mutex> lock(m_request_mutex);
+    if (http_request.skip_if_running &&
+        !m_running_urls.insert(http_request.url).second)
+      return false;
+    m_new_requests.emplace_back(std::move(http_request));
+  }
+  curl_multi_wakeup(m_multi);
+  return true;
+}
+
+void HttpClientPool::runLoop() {
+  while (true) {
+    std::deque<HttpRequest> new_requests;
+    {
+      std::lock_guard<std::mutex> lock(m_request_mutex);
+      if (m_stop)
+        return;
+      new_requests.swap(m_new_requests);
+    }
+
+    for (auto &http_request : new_requests)
+      startTransfer(http_request);
+
+    int num_running;
+    curl_multi_perform(m_multi, &num_running);
+
+    CURLMsg *curl_msg;
+    int num_msgs;
+    while ((curl_msg = curl_multi_info_read(m_multi, &num_msgs)) != nullptr) {
+      if (curl_msg->msg == CURLMSG_DONE)
+        finishTransfer(curl_msg->easy_handle, curl_msg->data.result);
+    }
+
+    curl_multi_poll(m_multi, nullptr, 0, 1000, nullptr);
+  }
+}
+
+void HttpClientPool::startTransfer(HttpRequest &http_request) {
+  std::unique_ptr<HttpTransfer> transfer(new HttpTransfer);
+  transfer->request = std::move(http_request);
+
+  if (m_idle_curls.empty()) {
+    transfer->curl.reset(new curlpp::Easy);
+  } else {
+    transfer->curl = std::move(m_idle_curls.back());
+    m_idle_curls.pop_back();
+    transfer->curl->reset();
+  }
+
+  auto &curl = *transfer->curl;
+  auto &request = transfer->request;
+  try {
+    curl.setOpt(CURLOPT_URL, request.url.data());
+    curl.setOpt(CURLOPT_TCP_KEEPALIVE, 1L);
+    curl.setOpt(CURLOPT_WRITEFUNCTION, writeCallback);
+    curl.setOpt(CURLOPT_WRITEDATA, &transfer->response);
+    if (request.timeout > 0)
+      curl.setOpt(CURLOPT_TIMEOUT, request.timeout);
+    if (request.fail_on_error)
+      curl.setOpt(CURLOPT_FAILONERROR, 1L);
+
+    if (request.is_post) {
+      if (request.raw_body) {
+        transfer->post_field = std::move(request.msg);
+        transfer->headers.add("Content-Type: application/json");
+        curl.setOpt(CURLOPT_HTTPHEADER, transfer->headers.getHandle());
+      } else {
+        transfer->post_field = "message=" + curl.escape(request.msg);
+      }
+
+      CLOG(INFO, "HTTP") << "POST (" << request.url << ", "
+                         << transfer->post_field.size() << "bytes )";
+
+      curl.setOpt(CURLOPT_POST, 1L);
+      curl.setOpt(CURLOPT_POSTFIELDS, transfer->post_field.data());
+      curl.setOpt(CURLOPT_POSTFIELDSIZE, transfer->post_field.size());
+    }
+  } catch (curlpp::EasyException &err) {
+    CLOG(ERROR, "HTTP") << err.what();
+    endRequest(request, err.getErrorId(), transfer->response);
+    m_idle_curls.emplace_back(std::move(transfer->curl));
+    return;
+  }
+
+  CURL *handle = curl.getHandle();
+  curl_multi_add_handle(m_multi, handle);
+  m_transfers[handle] = std::move(transfer);
+}
+
+void HttpClientPool::finishTransfer(CURL *handle, CURLcode result) {
+  auto it_map = m_transfers.find(handle);
+  if (it_map == m_transfers.end())
+    return;
+
+  std::unique_ptr<HttpTransfer> transfer = std::move(it_map->second);
+  m_transfers.erase(it_map);
+  curl_multi_remove_handle(m_multi, handle);
+
+  if (result != CURLE_OK && !transfer->request.fail_on_error)
+    CLOG(ERROR, "HTTP") << "POST (" << transfer->request.url
+                        << ") - " << curl_easy_strerror(result);
+
+  endRequest(transfer->request, result, transfer->response);
+
+  m_idle_curls.emplace_back(std::move(transfer->curl));
+}
+
+void HttpClientPool::endRequest(HttpRequest &http_request, CURLcode result,
+                                std::string &response) {
+  if (http_request.skip_if_running) {
+    std::lock_guard<std::mutex> lock(m_request_mutex);
+    m_running_urls.erase(http_request.url);
+  }
+
+  if (http_request.done)
+    http_request.done(result, response);
+}
+
+size_t HttpClientPool::writeCallback(const char *in, size_t size, size_t num,
+                                     std::string *out) {
+  const std::size_t total_bytes(size * num);
+  out->append(in, total_bytes);
+  return total_bytes;
+}
+
+} // namespace gruut
@@ -0,0 +1,76 @@
+#ifndef GRUUT_ENTERPRISE_MERGER_HTTP_CLIENT_POOL_HPP
+#define GRUUT_ENTERPRISE_MERGER_HTTP_CLIENT_POOL_HPP
+
+#include "../../config/config.hpp"
+#include "../../utils/template_singleton.hpp"
+#include "curlpp.hpp"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace gruut {
+
+struct HttpRequest {
+  std::string url;
+  std::string msg;
+  bool is_post{true};
+  bool raw_body{false}; // msg as a JSON body, not as a `message` form field
+  bool fail_on_error{false};
+  // not started while another such request to the same url is in flight
+  bool skip_if_running{false};
+  long timeout{0}; // in seconds, 0 = none
+  // called on the pool thread with the result and the response body
+  std::function<void(CURLcode, std::string &)> done;
+};
+
+struct HttpTransfer {
+  HttpRequest request;
+  std::unique_ptr<curlpp::Easy> curl;
+  curlpp::List headers;
+  std::string post_field;
+  std::string response;
+};
+
+// One curl multi handle, driven by its own thread, carries every HTTP
+// request of the merger. The multi handle keeps connections open after a
+// transfer, so posts to the same tracker or service endpoint reuse one TCP
+// connection, and transfers to different endpoints run concurrently.
+class HttpClientPool : public TemplateSingleton<HttpClientPool> {
+private:
+  CURLM *m_multi;
+  std::thread m_pool_thread;
+
+  std::deque<HttpRequest> m_new_requests;
+  std::unordered_set<std::string> m_running_urls; // skip_if_running only
+  std::mutex m_request_mutex;
+  bool m_stop{false};
+
+  // only touched by the pool thread
+  std::unordered_map<CURL *, std::unique_ptr<HttpTransfer>> m_transfers;
+  std::vector<std::unique_ptr<curlpp::Easy>> m_idle_curls;
+
+public:
+  HttpClientPool();
+  ~HttpClientPool();
+
+  bool request(HttpRequest http_request);
+
+private:
+  void runLoop();
+  void startTransfer(HttpRequest &http_request);
+  void finishTransfer(CURL *handle, CURLcode result);
+  void endRequest(HttpRequest &http_request, CURLcode result,
+                  std::string &response);
+  static size_t writeCallback(const char *in, size_t size, size_t num,
+                              std::string *out);
+};
+} // namespace gruut
+
+#endif
@@ -248,6 +248,11 @@ public:
   }
   void disableTracker() { m_enabled_tracker = false; }
 
+  // a post queued for the tracker
+  void countTrackerPost() { ++m_num_tracker_posts; }
+
+  uint64_t getNumTrackerPosts() { return m_num_tracker_posts; }
+
   void disableMergerCheck() { m_enabled_merger_check = false; }
 
   void disableSECheck() { m_enabled_se_check = false; }
@@ -296,6 +301,7 @@ private:
   std::atomic<bool> m_enabled_tracker{true};
   std::atomic<bool> m_enabled_merger_check{true};
   std::atomic<bool> m_enabled_se_check{true};
+  std::atomic<uint64_t> m_num_tracker_posts{0};
 };
 
 } // namespace gruut
@@ -0,0 +1,405 @@
+#include "merger_channel_pool.hpp"
+#include "grpc_util.hpp"
+
+#include "easy_logging.hpp"
+
+#include <algorithm>
+
+namespace gruut {
+
+MergerChannelPool::MergerChannelPool() {
+  el::Loggers::getLogger("MCLN");
+  m_send_thread = std::thread([this]() { sendLoop(); });
+}
+
+// open streams are cancelled and left to the process exit; no new call may
+// be started on the queue once it is shut down
+MergerChannelPool::~MergerChannelPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_channel_mutex);
+    m_is_shutdown = true;
+    for (auto &channel_entry : m_channels) {
+      if (channel_entry.second.stream != nullptr)
+        channel_entry.second.stream->context.TryCancel();
+    }
+  }
+
+  m_send_cq.Shutdown();
+  if (m_send_thread.joinable())
+    m_send_thread.join();
+}
+
+std::shared_ptr<MergerCommunication::Stub>
+MergerChannelPool::getStub(const MergerInfo &merger_info) {
+  std::lock_guard<std::mutex> lock(m_channel_mutex);
+  return getChannel(merger_info).stub;
+}
+
+// a channel in backoff after a failure is reported down right away;
+// otherwise it is given up to MERGER_CONNECT_TIMEOUT to get connected
+bool MergerChannelPool::isConnected(const MergerInfo &merger_info) {
+  std::shared_ptr<Channel> channel;
+  {
+    std::lock_guard<std::mutex> lock(m_channel_mutex);
+    channel = getChannel(merger_info).channel;
+  }
+
+  grpc_connectivity_state state = channel->GetState(true);
+  if (state == GRPC_CHANNEL_READY)
+    return true;
+  if (state == GRPC_CHANNEL_TRANSIENT_FAILURE ||
+      state == GRPC_CHANNEL_SHUTDOWN)
+    return false;
+
+  return channel->WaitForConnected(
+      std::chrono::system_clock::now() +
+      std::chrono::milliseconds(config::MERGER_CONNECT_TIMEOUT));
+}
+
+void MergerChannelPool::send(const MergerInfo &merger_info,
+                             const std::shared_ptr<std::string> &packed_msg,
+                             bool low_priority) {
+  std::string merger_id_b64 = TypeConverter::encodeBase64(merger_info.id);
+
+  std::lock_guard<std::mutex> lock(m_channel_mutex);
+  MergerChannel &merger_channel = getChannel(merger_info);
+  auto &send_queue = merger_channel.send_queue;
+
+  // only low-priority messages are given up quietly; a queue full of
+  // others refuses the new one, and each such refusal is logged
+  if (send_queue.size() >= config::MAX_MERGER_SEND_QUEUE) {
+    auto it_low = std::find_if(
+        send_queue.begin(), send_queue.end(),
+        [](const MergerSendItem &item) { return item.low_priority; });
+
+    if (it_low == send_queue.end() && !low_priority) {
+      CLOG(ERROR, "MCLN") << "Merger [" << merger_id_b64
+                          << "] is lagging; a message was refused (#queued="
+                          << send_queue.size() << ")";
+      return;
+    }
+
+    if (++merger_channel.num_dropped % config::MAX_MERGER_SEND_QUEUE == 1)
+      CLOG(ERROR, "MCLN") << "Merger [" << merger_id_b64
+                          << "] is lagging (#dropped="
+                          << merger_channel.num_dropped << ")";
+
+    if (it_low == send_queue.end())
+      return;
+    send_queue.erase(it_low);
+  }
+
+  send_queue.push_back({packed_msg, low_priority});
+  sendNextIf(merger_id_b64, merger_channel);
+}
+
+// callers hold m_channel_mutex
+MergerChannel &MergerChannelPool::getChannel(const MergerInfo &merger_info) {
+  std::string merger_id_b64 = TypeConverter::encodeBase64(merger_info.id);
+  std::string address = merger_info.address + ":" + merger_info.port;
+
+  MergerChannel &merger_channel = m_channels[merger_id_b64];
+  if (merger_channel.channel == nullptr || merger_channel.address != address) {
+    ChannelArguments channel_args;
+    channel_args.SetInt(GRPC_ARG_KEEPALIVE_TIME_MS,
+                        config::MERGER_KEEPALIVE_INTERVAL);
+    channel_args.SetInt(GRPC_ARG_KEEPALIVE_PERMIT_WITHOUT_CALLS, 1);
+    channel_args.SetInt(GRPC_ARG_INITIAL_RECONNECT_BACKOFF_MS,
+                        config::MIN_MERGER_RECONNECT_BACKOFF);
+    channel_args.SetInt(GRPC_ARG_MIN_RECONNECT_BACKOFF_MS,
+                        config::MIN_MERGER_RECONNECT_BACKOFF);
+    channel_args.SetInt(GRPC_ARG_MAX_RECONNECT_BACKOFF_MS,
+                        config::MAX_MERGER_RECONNECT_BACKOFF);
+
+    // a stream to the old address is finished when its cancelled write or
+    // start comes back
+    if (merger_channel.stream != nullptr) {
+      merger_channel.stream->context.TryCancel();
+      merger_channel.stream = nullptr;
+    }
+
+    merger_channel.address = address;
+    merger_channel.channel = CreateCustomChannel(
+        address, InsecureChannelCredentials(), channel_args);
+    merger_channel.stub = MergerCommunication::NewStub(merger_channel.channel);
+    merger_channel.generic_stub =
+        std::make_shared<GenericStub>(merger_channel.channel);
+  }
+
+  return merger_channel;
+}
+
+// starts the next write unless one is in flight; callers hold
+// m_channel_mutex
+void MergerChannelPool::sendNextIf(const std::string &merger_id_b64,
+                                   MergerChannel &merger_channel) {
+  if (m_is_shutdown || merger_channel.is_sending ||
+      merger_channel.send_queue.empty())
+    return;
+
+  if (merger_channel.stream == nullptr &&
+      std::chrono::system_clock::now() >= merger_channel.stream_retry_time) {
+    openStream(merger_id_b64, merger_channel);
+  } else if (merger_channel.stream != nullptr &&
+             merger_channel.stream->is_open) {
+    // otherwise the next acknowledgement starts it
+    if (merger_channel.stream->unacked_frames.size() <
+        config::MAX_MERGER_UNACKED_FRAMES)
+      writeFrame(merger_channel);
+  } else {
+    sendUnary(merger_id_b64, merger_channel);
+  }
+}
+
+void MergerChannelPool::sendUnary(const std::string &merger_id_b64,
+                                  MergerChannel &merger_channel) {
+  // protobuf needs its own copy of the bytes, except for the last merger
+  // still holding the buffer, which can hand it over
+  std::shared_ptr<std::string> packed_msg =
+      std::move(merger_channel.send_queue.front().packed_msg);
+  merger_channel.send_queue.pop_front();
+
+  MergerDataRequest request;
+  if (packed_msg.use_count() == 1)
+    request.set_data(std::move(*packed_msg));
+  else
+    request.set_data(*packed_msg);
+
+  auto send_call = new MergerSendCall;
+  send_call->merger_id_b64 = merger_id_b64;
+  send_call->context.set_deadline(
+      std::chrono::system_clock::now() +
+      std::chrono::milliseconds(config::MERGER_SEND_TIMEOUT));
+  send_call->response_reader = merger_channel.stub->PrepareAsyncpushData(
+      &send_call->context, request, &m_send_cq);
+  send_call->response_reader->StartCall();
+  send_call->response_reader->Finish(&send_call->reply, &send_call->status,
+                                     &send_call->tag);
+
+  merger_channel.is_sending = true;
+}
+
+void MergerChannelPool::openStream(const std::string &merger_id_b64,
+                                   MergerChannel &merger_channel) {
+  auto stream = new MergerStream;
+  stream->merger_id_b64 = merger_id_b64;
+  stream->stream = merger_channel.generic_stub->PrepareCall(
+      &stream->context, MERGER_STREAM_METHOD, &m_send_cq);
+  stream->stream->StartCall(&stream->start_tag);
+  ++stream->num_pending;
+
+  merger_channel.stream = stream;
+  merger_channel.is_sending = true;
+}
+
+static void releasePackedMsg(void *packed_msg) {
+  delete static_cast<std::shared_ptr<std::string> *>(packed_msg);
+}
+
+// everything queued, up to MAX_MERGER_FRAME_BYTES (but at least one
+// message), goes out as one frame; the slices point into the shared
+// buffers, so nothing is copied
+void MergerChannelPool::writeFrame(MergerChannel &merger_channel) {
+  auto &send_queue = merger_channel.send_queue;
+  MergerStream *stream = merger_channel.stream;
+  stream->unacked_frames.emplace_back();
+  MergerStreamFrame &stream_frame = stream->unacked_frames.back();
+
+  size_t frame_bytes = 0;
+  while (!send_queue.empty()) {
+    size_t msg_bytes = send_queue.front().packed_msg->size();
+    if (!stream_frame.items.empty() &&
+        frame_bytes + msg_bytes > config::MAX_MERGER_FRAME_BYTES)
+      break;
+
+    stream_frame.items.emplace_back(std::move(send_queue.front()));
+    send_queue.pop_front();
+    frame_bytes += msg_bytes;
+  }
+
+  std::vector<Slice> slices;
+  slices.reserve(stream_frame.items.size() + 1);
+  slices.emplace_back(MergerFrame::makePrefix(frame_bytes));
+  for (auto &item : stream_frame.items) {
+    auto packed_msg = new std::shared_ptr<std::string>(item.packed_msg);
+    slices.emplace_back(&(**packed_msg)[0], (*packed_msg)->size(),
+                        releasePackedMsg, packed_msg);
+  }
+
+  ByteBuffer frame(slices.data(), slices.size());
+
+  stream_frame.write_start = std::chrono::system_clock::now();
+  stream->stream->Write(frame, &stream->write_tag);
+  ++stream->num_pending;
+
+  merger_channel.is_sending = true;
+}
+
+// the merger acknowledges the frames in the order they were written
+void MergerChannelPool::readAck(MergerStream *stream) {
+  stream->stream->Read(&stream->ack, &stream->ack_tag);
+  ++stream->num_pending;
+}
+
+// the first failure cancels whatever else is in flight on the stream, and
+// the stream is finished once all of it has come back; merger_channel is
+// nullptr if the stream is no longer the channel's
+void MergerChannelPool::closeStream(MergerChannel *merger_channel,
+                                    MergerStream *stream) {
+  if (!stream->is_closing) {
+    stream->is_closing = true;
+    stream->is_open = false;
+    if (merger_channel != nullptr)
+      merger_channel->stream_retry_time =
+          std::chrono::system_clock::now() +
+          std::chrono::milliseconds(config::MERGER_STREAM_RETRY_INTERVAL);
+
+    if (!stream->unacked_frames.empty()) {
+      CLOG(ERROR, "MCLN") << "Stream to merger [" << stream->merger_id_b64
+                          << "] broke; " << stream->unacked_frames.size()
+                          << " frame(s) requeued";
+      requeueFrames(stream);
+    }
+    stream->context.TryCancel();
+  }
+
+  if (stream->num_pending == 0 && !m_is_shutdown)
+    stream->stream->Finish(&stream->status, &stream->finish_tag);
+}
+
+// the messages go back in front of whatever was queued after them, so the
+// merger still gets everything in order; callers hold m_channel_mutex
+void MergerChannelPool::requeueFrames(MergerStream *stream) {
+  MergerChannel *merger_channel = findChannel(stream->merger_id_b64);
+  if (merger_channel != nullptr && !m_is_shutdown) {
+    auto &send_queue = merger_channel->send_queue;
+    for (auto it_frame = stream->unacked_frames.rbegin();
+         it_frame != stream->unacked_frames.rend(); ++it_frame)
+      send_queue.insert(send_queue.begin(),
+                        std::make_move_iterator(it_frame->items.begin()),
+                        std::make_move_iterator(it_frame->items.end()));
+  }
+  stream->unacked_frames.clear();
+}
+
+// a merger that stops reading or acknowledging stalls its stream without
+// breaking it
+void MergerChannelPool::cancelStuckStreams() {
+  auto now = std::chrono::system_clock::now();
+  auto timeout = std::chrono::milliseconds(config::MERGER_SEND_TIMEOUT);
+
+  std::lock_guard<std::mutex> lock(m_channel_mutex);
+  for (auto &channel_entry : m_channels) {
+    MergerChannel &merger_channel = channel_entry.second;
+    MergerStream *stream = merger_channel.stream;
+    if (stream == nullptr || !stream->is_open ||
+        stream->unacked_frames.empty() ||
+        now - stream->unacked_frames.front().write_start < timeout)
+      continue;
+
+    CLOG(ERROR, "MCLN") << "Stream to merger [" << channel_entry.first
+                        << "] is stuck";
+    stream->context.TryCancel();
+  }
+}
+
+void MergerChannelPool::sendLoop() {
+  void *tag;
+  bool ok;
+  auto next_check = std::chrono::system_clock::now();
+
+  while (true) {
+    auto next_status = m_send_cq.AsyncNext(&tag, &ok, next_check);
+    if (next_status == CompletionQueue::SHUTDOWN)
+      break;
+
+    if (next_status == CompletionQueue::GOT_EVENT) {
+      auto send_tag = static_cast<MergerSendTag *>(tag);
+      if (send_tag->op == MergerSendOp::UNARY)
+        handleUnary(static_cast<MergerSendCall *>(send_tag->call));
+      else
+        handleStream(send_tag->op, static_cast<MergerStream *>(send_tag->call),
+                     ok);
+    }
+
+    if (std::chrono::system_clock::now() >= next_check) {
+      cancelStuckStreams();
+      next_check = std::chrono::system_clock::now() +
+                   std::chrono::milliseconds(config::MERGER_SEND_TIMEOUT);
+    }
+  }
+}
+
+void MergerChannelPool::handleUnary(MergerSendCall *send_call) {
+  std::unique_ptr<MergerSendCall> send_call_ptr(send_call);
+
+  if (!send_call->status.ok())
+    CLOG(ERROR, "MCLN") << "Opponent's response - "
+                        << send_call->status.error_message() << " ["
+                        << send_call->merger_id_b64 << "]";
+
+  std::lock_guard<std::mutex> lock(m_channel_mutex);
+  MergerChannel *merger_channel = findChannel(send_call->merger_id_b64);
+  if (merger_channel == nullptr)
+    return;
+
+  merger_channel->is_sending = false;
+  sendNextIf(send_call->merger_id_b64, *merger_channel);
+}
+
+void MergerChannelPool::handleStream(MergerSendOp op, MergerStream *stream,
+                                     bool ok) {
+  std::lock_guard<std::mutex> lock(m_channel_mutex);
+  MergerChannel *merger_channel = findChannel(stream->merger_id_b64);
+
+  if (op == MergerSendOp::STREAM_FINISH) {
+    CLOG(INFO, "MCLN") << "Stream to merger [" << stream->merger_id_b64
+                       << "] closed - " << stream->status.error_message();
+    if (merger_channel != nullptr && merger_channel->stream == stream)
+      merger_channel->stream = nullptr;
+    delete stream;
+    return;
+  }
+
+  // a start or a write is the one thing in flight for the merger, even if
+  // the stream has been replaced since; acknowledgements are read apart
+  --stream->num_pending;
+  if (merger_channel != nullptr && op != MergerSendOp::STREAM_ACK)
+    merger_channel->is_sending = false;
+  if (merger_channel != nullptr && merger_channel->stream != stream)
+    merger_channel = nullptr;
+
+  if (!ok || merger_channel == nullptr || stream->is_closing ||
+      m_is_shutdown) {
+    closeStream(merger_channel, stream);
+  } else if (op == MergerSendOp::STREAM_START) {
+    // the merger sends its initial metadata once it has taken the stream;
+    // one without the stream rejects it instead
+    stream->stream->ReadInitialMetadata(&stream->accept_tag);
+    ++stream->num_pending;
+    merger_channel->is_sending = true;
+    return;
+  } else if (op == MergerSendOp::STREAM_ACCEPT) {
+    stream->is_open = true;
+    readAck(stream);
+  } else if (op == MergerSendOp::STREAM_ACK) {
+    if (!stream->unacked_frames.empty())
+      stream->unacked_frames.pop_front();
+    readAck(stream);
+  }
+
+  merger_channel = findChannel(stream->merger_id_b64);
+  if (merger_channel != nullptr)
+    sendNextIf(stream->merger_id_b64, *merger_channel);
+}
+
+// callers hold m_channel_mutex
+MergerChannel *
+MergerChannelPool::findChannel(const std::string &merger_id_b64) {
+  auto it_map = m_channels.find(merger_id_b64);
+  if (it_map == m_channels.end())
+    return nullptr;
+  return &it_map->second;
+}
+
+} // namespace gruut
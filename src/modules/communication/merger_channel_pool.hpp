@@ -0,0 +1,157 @@
+#ifndef GRUUT_ENTERPRISE_MERGER_MERGER_CHANNEL_POOL_HPP
+#define GRUUT_ENTERPRISE_MERGER_MERGER_CHANNEL_POOL_HPP
+
+#include "../../config/config.hpp"
+#include "../../services/setting.hpp"
+#include "../../utils/template_singleton.hpp"
+#include "../../utils/type_converter.hpp"
+#include "protos/protobuf_merger.grpc.pb.h"
+
+#include <grpcpp/generic/generic_stub.h>
+#include <grpcpp/grpcpp.h>
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+using namespace grpc;
+using namespace grpc_merger;
+
+namespace gruut {
+
+// packed_msg is shared by every merger a message is broadcast to and is not
+// modified while shared
+struct MergerSendItem {
+  std::shared_ptr<std::string> packed_msg;
+  bool low_priority;
+};
+
+enum class MergerSendOp {
+  UNARY,
+  STREAM_START,
+  STREAM_ACCEPT,
+  STREAM_WRITE,
+  STREAM_ACK,
+  STREAM_FINISH
+};
+
+// what a completion on the send queue is about
+struct MergerSendTag {
+  MergerSendOp op;
+  void *call; // MergerSendCall or MergerStream
+};
+
+// one asynchronous pushData in flight
+struct MergerSendCall {
+  MergerSendTag tag{MergerSendOp::UNARY, this};
+  std::string merger_id_b64;
+  ClientContext context;
+  MergerDataReply reply;
+  Status status;
+  std::unique_ptr<ClientAsyncResponseReader<MergerDataReply>> response_reader;
+};
+
+// a frame written to a stream that the merger has not acknowledged yet
+struct MergerStreamFrame {
+  std::deque<MergerSendItem> items;
+  std::chrono::system_clock::time_point write_start;
+};
+
+// the long-lived stream to a merger; each write is one frame of packed
+// messages laid end to end, and the merger acknowledges each frame once it
+// has handled it
+struct MergerStream {
+  MergerSendTag start_tag{MergerSendOp::STREAM_START, this};
+  MergerSendTag accept_tag{MergerSendOp::STREAM_ACCEPT, this};
+  MergerSendTag write_tag{MergerSendOp::STREAM_WRITE, this};
+  MergerSendTag ack_tag{MergerSendOp::STREAM_ACK, this};
+  MergerSendTag finish_tag{MergerSendOp::STREAM_FINISH, this};
+  std::string merger_id_b64;
+  ClientContext context;
+  Status status;
+  std::unique_ptr<GenericClientAsyncReaderWriter> stream;
+  ByteBuffer ack;
+  bool is_open{false};
+  bool is_closing{false};
+  int num_pending{0}; // operations in flight; Finish waits for all of them
+  // oldest first; put back in the queue if the stream breaks
+  std::deque<MergerStreamFrame> unacked_frames;
+};
+
+struct MergerChannel {
+  std::string address; // ip:port the channel was made for
+  std::shared_ptr<Channel> channel;
+  std::shared_ptr<MergerCommunication::Stub> stub;
+  std::shared_ptr<GenericStub> generic_stub;
+  MergerStream *stream{nullptr};
+  // pushData is used until then after the stream has failed
+  std::chrono::system_clock::time_point stream_retry_time;
+  std::deque<MergerSendItem> send_queue;
+  bool is_sending{false}; // a call, stream start or frame write in flight
+  uint64_t num_dropped{0}; // low-priority messages only
+};
+
+// One long-lived gRPC channel per merger, shared by every MergerClient.
+// Keepalive pings keep idle channels warm, and gRPC itself reconnects a
+// broken channel with exponential backoff, so the channel state doubles as
+// the connection status of the merger.
+//
+// Messages to a merger go through its own bounded queue, one asynchronous
+// write at a time (so they arrive in order), and each write has its own
+// deadline. A slow merger therefore only delays its own messages; once its
+// queue is full, low-priority messages to it are dropped and any other new
+// message is refused, so nothing already queued is pushed out for it.
+//
+// Writes go over one bidirectional stream per merger, and whatever queued up
+// during the previous write is sent as one frame. Up to
+// MAX_MERGER_UNACKED_FRAMES frames may wait for their acknowledgement. If
+// the stream cannot be opened (e.g. an older merger) or breaks, the queue
+// falls back to one pushData call per message until
+// MERGER_STREAM_RETRY_INTERVAL has passed. The messages of frames that were
+// not acknowledged go back to the front of the queue and are sent again that
+// way, so a merger may get a message twice but does not miss one.
+class MergerChannelPool : public TemplateSingleton<MergerChannelPool> {
+private:
+  std::unordered_map<std::string, MergerChannel> m_channels;
+  std::mutex m_channel_mutex;
+
+  CompletionQueue m_send_cq;
+  std::thread m_send_thread;
+  bool m_is_shutdown{false};
+
+public:
+  MergerChannelPool();
+  ~MergerChannelPool();
+
+  std::shared_ptr<MergerCommunication::Stub>
+  getStub(const MergerInfo &merger_info);
+  bool isConnected(const MergerInfo &merger_info);
+  void send(const MergerInfo &merger_info,
+            const std::shared_ptr<std::string> &packed_msg, bool low_priority);
+
+private:
+  MergerChannel &getChannel(const MergerInfo &merger_info);
+  void sendNextIf(const std::string &merger_id_b64,
+                  MergerChannel &merger_channel);
+  void sendUnary(const std::string &merger_id_b64,
+                 MergerChannel &merger_channel);
+  void openStream(const std::string &merger_id_b64,
+                  MergerChannel &merger_channel);
+  void writeFrame(MergerChannel &merger_channel);
+  void readAck(MergerStream *stream);
+  void closeStream(MergerChannel *merger_channel, MergerStream *stream);
+  void requeueFrames(MergerStream *stream);
+  void cancelStuckStreams();
+
+  void sendLoop();
+  void handleUnary(MergerSendCall *send_call);
+  void handleStream(MergerSendOp op, MergerStream *stream, bool ok);
+  MergerChannel *findChannel(const std::string &merger_id_b64);
+};
+} // namespace gruut
+
+#endif
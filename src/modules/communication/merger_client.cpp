@@ -10,6 +10,7 @@ namespace gruut {
 MergerClient::MergerClient() {
   m_rpc_receiver_list = RpcReceiverList::getInstance();
   m_conn_manager = ConnManager::getInstance();
+  m_channel_pool = MergerChannelPool::getInstance();
 
   el::Loggers::getLogger("MCLN");
 }
@@ -70,8 +71,7 @@ void MergerClient::accessToTracker() {
 
   auto merger_list = m_conn_manager->getAllMergerInfo();
   for (auto &merger_info : merger_list) {
-    Status st = sendHealthCheck(merger_info);
-    if (st.ok()) {
+    if (m_channel_pool->isConnected(merger_info)) {
       auto &bp_scheduler = Application::app().getBpScheduler();
       bp_scheduler.setWelcome(false);
       return;
@@ -104,27 +104,30 @@ void MergerClient::checkHttpConnection() {
   auto se_list = m_conn_manager->getAllSeInfo();
   auto tk_info = m_conn_manager->getTrackerInfo();
 
-  bool status;
+  auto conn_manager = m_conn_manager;
 
+  // all checks run at once; each status is set when its check comes back
   if (!m_disable_tracker) {
     HttpClient tk_http_client(tk_info.address + ":" + tk_info.port);
-    status = tk_http_client.checkServStatus();
-    m_conn_manager->setTrackerStatus(status);
+    tk_http_client.checkServStatus([conn_manager](bool status) {
+      conn_manager->setTrackerStatus(status);
+    });
   }
 
   for (auto &se_info : se_list) {
     HttpClient se_http_client(se_info.address + ":" + se_info.port);
-    status = se_http_client.checkServStatus();
-    m_conn_manager->setSeStatus(se_info.id, status);
+    servend_id_type se_id = se_info.id;
+    se_http_client.checkServStatus([conn_manager, se_id](bool status) mutable {
+      conn_manager->setSeStatus(se_id, status);
+    });
   }
 }
 
 void MergerClient::checkRpcConnection() {
   auto merger_list = m_conn_manager->getAllMergerInfo();
   for (auto &merger_info : merger_list) {
-
-    Status st = sendHealthCheck(merger_info);
-    m_conn_manager->setMergerStatus(merger_info.id, st.ok());
+    m_conn_manager->setMergerStatus(merger_info.id,
+                                    m_channel_pool->isConnected(merger_info));
   }
 }
 
@@ -136,7 +139,13 @@ void MergerClient::sendMessage(MessageType msg_type,
   // CLOG(INFO, "MCLN") << "called sendMessage()";
 
   if (checkMergerMsgType(msg_type)) {
-    sendToMerger(receiver_list, packed_msg_list[0]);
+    // one buffer shared by every merger
+    std::shared_ptr<std::string> packed_msg;
+    if (checkSignerMsgType(msg_type)) // MSG_ERROR goes to signers as well
+      packed_msg = std::make_shared<std::string>(packed_msg_list[0]);
+    else
+      packed_msg = std::make_shared<std::string>(std::move(packed_msg_list[0]));
+    sendToMerger(msg_type, receiver_list, packed_msg);
   }
 
   if (checkSignerMsgType(msg_type)) {
@@ -163,14 +172,17 @@ json MergerClient::sendToTracker(OutputMsgEntry &output_msg) {
   auto tk_info = m_conn_manager->getTrackerInfo();
   std::string address = tk_info.address + ":" + tk_info.port + "/src";
 
+  // only posts that made it into the queue of the HTTP client pool count
   if (output_msg.type == MessageType::MSG_CHAIN_INFO ||
       output_msg.type == MessageType::MSG_JOIN_MERGER) {
     address += "/ChainInfo.php";
     HttpClient http_client(address);
-    http_client.post(send_msg);
+    if (http_client.post(send_msg))
+      m_conn_manager->countTrackerPost();
   } else {
     address += "/CheckExist.php";
     HttpClient http_client(address);
+    m_conn_manager->countTrackerPost();
     http_client.postAndGetReply(send_msg, reply_json);
   }
   return reply_json;
@@ -207,21 +219,20 @@ void MergerClient::sendToSE(std::vector<id_type> &receiver_list,
   }
 }
 
-void MergerClient::sendToMerger(std::vector<id_type> &receiver_list,
-                                std::string &packed_msg) {
+void MergerClient::sendToMerger(MessageType msg_type,
+                                std::vector<id_type> &receiver_list,
+                                std::shared_ptr<std::string> &packed_msg) {
 
   // CLOG(INFO, "MCLN") << "called sendToMerger()";
 
-  MergerDataRequest request;
-  request.set_data(packed_msg);
-
+  bool low_priority = checkLowPriorityMsgType(msg_type);
   bool sent_somewhere = false;
 
   if (receiver_list.empty()) {
     auto merger_list = m_conn_manager->getAllMergerInfo();
     for (auto &merger_info : merger_list) {
       if (m_conn_manager->getMergerStatus(merger_info.id)) {
-        sendMsgToMerger(merger_info, request);
+        sendMsgToMerger(merger_info, packed_msg, low_priority);
         sent_somewhere = true;
       }
     }
@@ -253,7 +264,7 @@ void MergerClient::sendToMerger(std::vector<id_type> &receiver_list,
       }
       MergerInfo merger_info = m_conn_manager->getMergerInfo(receiver_id);
       if (m_conn_manager->getMergerStatus(merger_info.id)) {
-        sendMsgToMerger(merger_info, request);
+        sendMsgToMerger(merger_info, packed_msg, low_priority);
         sent_somewhere = true;
         break;
       }
@@ -265,24 +276,16 @@ void MergerClient::sendToMerger(std::vector<id_type> &receiver_list,
   }
 }
 
+// only queues the message; the channel pool sends it asynchronously, so a
+// broadcast takes as long as the slowest merger rather than the sum of all
 void MergerClient::sendMsgToMerger(MergerInfo &merger_info,
-                                   MergerDataRequest &request) {
+                                   std::shared_ptr<std::string> &packed_msg,
+                                   bool low_priority) {
 
   CLOG(INFO, "MCLN") << "sendToMerger("
                      << merger_info.address + ":" + merger_info.port << ") ";
 
-  std::shared_ptr<ChannelCredentials> credential = InsecureChannelCredentials();
-  std::shared_ptr<Channel> channel =
-      CreateChannel(merger_info.address + ":" + merger_info.port, credential);
-  std::unique_ptr<MergerCommunication::Stub> stub =
-      MergerCommunication::NewStub(channel);
-
-  ClientContext context;
-  MergerDataReply reply;
-
-  Status status = stub->pushData(&context, request, &reply);
-  if (!status.ok())
-    CLOG(ERROR, "MCLN") << "Opponent's response - " << status.error_message();
+  m_channel_pool->send(merger_info, packed_msg, low_priority);
 }
 
 void MergerClient::sendToSigner(MessageType msg_type,
@@ -297,28 +300,12 @@ void MergerClient::sendToSigner(MessageType msg_type,
 
     auto tag = static_cast<Identity *>(signer_rpc_info.tag_identity);
     ReplyMsg reply;
-    reply.set_message(packed_msg_list[i]);
+    reply.set_message(std::move(packed_msg_list[i]));
     if (signer_rpc_info.send_msg != nullptr)
       signer_rpc_info.send_msg->Write(reply, tag);
   }
 }
 
-Status MergerClient::sendHealthCheck(MergerInfo &merger_info) {
-  ConnCheckRequest request;
-  request.set_checker(true);
-  ConnCheckResponse response;
-  ClientContext context;
-
-  std::shared_ptr<ChannelCredentials> credential = InsecureChannelCredentials();
-  std::shared_ptr<Channel> channel =
-      CreateChannel(merger_info.address + ":" + merger_info.port, credential);
-  std::unique_ptr<MergerCommunication::Stub> hc_stub =
-      MergerCommunication::NewStub(channel);
-
-  Status st = hc_stub->ConnCheck(&context, request, &response);
-  return st;
-}
-
 bool MergerClient::checkMergerMsgType(MessageType msg_type) {
   // clang-format off
   return (
@@ -326,15 +313,28 @@ bool MergerClient::checkMergerMsgType(MessageType msg_type) {
       msg_type == MessageType::MSG_PING ||
       msg_type == MessageType::MSG_TX ||
       msg_type == MessageType::MSG_REQ_BLOCK ||
+      msg_type == MessageType::MSG_REQ_BLOCK_RANGE ||
       msg_type == MessageType::MSG_WELCOME ||
       msg_type == MessageType::MSG_REQ_STATUS ||
       msg_type == MessageType::MSG_RES_STATUS ||
       msg_type == MessageType::MSG_BLOCK ||
+      msg_type == MessageType::MSG_BLOCK_RANGE ||
       msg_type == MessageType::MSG_ERROR
       );
   // clang-format on
 }
 
+// messages a lagging merger can do without; they are dropped first when
+// its send queue is full
+bool MergerClient::checkLowPriorityMsgType(MessageType msg_type) {
+  // clang-format off
+  return (
+      msg_type == MessageType::MSG_PING ||
+      msg_type == MessageType::MSG_TX
+      );
+  // clang-format on
+}
+
 bool MergerClient::checkSignerMsgType(MessageType msg_type) {
   // clang-format off
   return (
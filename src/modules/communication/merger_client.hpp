@@ -4,6 +4,7 @@
 #include "../../services/output_queue.hpp"
 #include "../../utils/periodic_task.hpp"
 #include "manage_connection.hpp"
+#include "merger_channel_pool.hpp"
 #include "protos/health.grpc.pb.h"
 #include "protos/protobuf_merger.grpc.pb.h"
 #include "protos/protobuf_se.grpc.pb.h"
@@ -35,6 +36,7 @@ public:
 private:
   RpcReceiverList *m_rpc_receiver_list;
   ConnManager *m_conn_manager;
+  MergerChannelPool *m_channel_pool;
   bool m_disable_tracker{false};
 
   PeriodicTask m_rpc_check_scheduler;
@@ -47,18 +49,20 @@ private:
   void sendToSE(std::vector<id_type> &receiver_list, OutputMsgEntry &output_msg,
                 std::string api_path);
 
-  void sendToMerger(std::vector<id_type> &receiver_list,
-                    std::string &packed_msg);
+  void sendToMerger(MessageType msg_type, std::vector<id_type> &receiver_list,
+                    std::shared_ptr<std::string> &packed_msg);
   void sendToSigner(MessageType msg_type, std::vector<id_type> &receiver_list,
                     std::vector<std::string> &packed_msg_list);
 
-  void sendMsgToMerger(MergerInfo &merger_id, MergerDataRequest &request);
+  void sendMsgToMerger(MergerInfo &merger_info,
+                       std::shared_ptr<std::string> &packed_msg,
+                       bool low_priority);
 
   bool checkMergerMsgType(MessageType msg_tpye);
+  bool checkLowPriorityMsgType(MessageType msg_type);
   bool checkSignerMsgType(MessageType msg_tpye);
   bool checkSEMsgType(MessageType msg_type);
   bool checkTrackerMsgType(MessageType msg_type);
-  Status sendHealthCheck(MergerInfo &merger_info);
   std::string getApiPath(MessageType msg_type);
 };
 } // namespace gruut
@@ -15,52 +15,68 @@ void MergerServer::runServer(const std::string &port_num) {
   ServerBuilder builder;
 
   builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
+  // let the other mergers keep their idle channels to us warm
+  builder.AddChannelArgument(GRPC_ARG_KEEPALIVE_PERMIT_WITHOUT_CALLS, 1);
+  builder.AddChannelArgument(
+      GRPC_ARG_HTTP2_MIN_RECV_PING_INTERVAL_WITHOUT_DATA_MS,
+      config::MERGER_KEEPALIVE_INTERVAL / 2);
   builder.RegisterService(&m_merger_service);
   builder.RegisterService(&m_se_service);
   builder.RegisterService(&m_signer_service);
-  m_completion_queue = builder.AddCompletionQueue();
+  builder.RegisterAsyncGenericService(&m_generic_service);
+  for (size_t i = 0; i < config::NUM_SERVER_CQ; ++i)
+    m_completion_queues.emplace_back(builder.AddCompletionQueue());
   m_server = builder.BuildAndStart();
 
+  m_rpc_workers.reset(new WorkerPool(config::NUM_RPC_WORKERS));
+
   m_is_started = true;
 
   CLOG(INFO, "MSVR") << "Server listening on " << server_address;
 
-  new CheckConn(&m_merger_service, m_completion_queue.get());
+  // every queue waits for every kind of call, so any of them can take the
+  // next request
+  for (auto &completion_queue : m_completion_queues) {
+    auto cq = completion_queue.get();
+    auto workers = m_rpc_workers.get();
+
+    new CheckConn(&m_merger_service, cq);
 
-  new RecvFromMerger(&m_merger_service, m_completion_queue.get());
-  new RecvFromSE(&m_se_service, m_completion_queue.get());
-  new OpenChannel(&m_signer_service, m_completion_queue.get());
-  new SignerService(&m_signer_service, m_completion_queue.get());
+    new RecvFromMerger(&m_merger_service, cq, workers);
+    new RecvMergerStream(&m_generic_service, cq);
+    new RecvFromSE(&m_se_service, cq, workers);
+    new OpenChannel(&m_signer_service, cq);
+    new SignerService(&m_signer_service, cq, workers);
+  }
 
-  recvMessage();
+  for (auto &completion_queue : m_completion_queues) {
+    auto cq = completion_queue.get();
+    m_cq_threads.emplace_back([this, cq]() { recvMessage(cq); });
+  }
 }
 
-void MergerServer::recvMessage() {
+// polls one completion queue until it is shut down
+void MergerServer::recvMessage(ServerCompletionQueue *completion_queue) {
   void *tag;
   bool ok;
-  try {
-    while (true) {
-      if (m_input_queue->size() < config::AVAILABLE_INPUT_SIZE) {
-        GPR_ASSERT(m_completion_queue->Next(&tag, &ok));
-        if (ok)
-          static_cast<CallData *>(tag)->proceed();
-      } else {
-        // CLOG(INFO, "MSVR") << "#InputQueue = " << m_input_queue->size();
-        std::this_thread::sleep_for(std::chrono::milliseconds(2));
-      }
+  while (true) {
+    if (m_input_queue->size() >= config::AVAILABLE_INPUT_SIZE) {
+      // CLOG(INFO, "MSVR") << "#InputQueue = " << m_input_queue->size();
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      continue;
     }
-  } catch (std::exception &e) {
-    CLOG(ERROR, "MSVR") << "RPC Server problem : " << e.what();
-    if (m_completion_queue != nullptr) {
-      while (m_completion_queue->Next(&tag, &ok)) {
-        if (tag != nullptr)
-          static_cast<CallData *>(tag)->proceed(false);
-      }
+
+    if (!completion_queue->Next(&tag, &ok))
+      break;
+
+    try {
+      if (ok)
+        static_cast<CallData *>(tag)->proceed();
+      else
+        static_cast<CallData *>(tag)->fail();
+    } catch (std::exception &e) {
+      CLOG(ERROR, "MSVR") << "RPC Server problem : " << e.what();
     }
-    m_completion_queue.reset();
-    m_server.reset();
-    CLOG(INFO, "MSVR") << "RPC Server restart";
-    runServer(m_port_num);
   }
 }
 
@@ -105,15 +121,21 @@ void RecvFromMerger::proceed(bool st) {
   } break;
 
   case RpcCallStatus::PROCESS: {
-    new RecvFromMerger(m_service, m_completion_queue);
+    new RecvFromMerger(m_service, m_completion_queue, m_rpc_workers);
 
-    std::async(std::launch::async, [this]() {
-      std::string packed_msg = m_request.data();
+    m_rpc_workers->post([this]() {
+      const std::string &packed_msg = m_request.data();
       Status rpc_status;
       id_type recv_id;
 
-      MessageHandler message_handler;
-      message_handler.unpackMsg(packed_msg, rpc_status, recv_id);
+      try {
+        MessageHandler message_handler;
+        message_handler.unpackMsg(packed_msg.data(), packed_msg.size(),
+                                  rpc_status, recv_id);
+      } catch (std::exception &e) {
+        rpc_status = Status(StatusCode::INTERNAL, "Merger internal error");
+        CLOG(INFO, "MSVR") << e.what();
+      }
 
       MergerDataReply m_reply;
       m_receive_status = RpcCallStatus::FINISH;
@@ -130,6 +152,113 @@ void RecvFromMerger::proceed(bool st) {
   }
 }
 
+void RecvMergerStream::proceed(bool st) {
+  if (!st) {
+    delete this;
+    return;
+  }
+  switch (m_receive_status) {
+  case RpcCallStatus::CREATE: {
+    m_receive_status = RpcCallStatus::READ;
+    m_service->RequestCall(&m_generic_context, &m_stream, m_completion_queue,
+                           m_completion_queue, this);
+  } break;
+
+  case RpcCallStatus::READ: {
+    new RecvMergerStream(m_service, m_completion_queue);
+
+    if (m_generic_context.method() != MERGER_STREAM_METHOD) {
+      m_receive_status = RpcCallStatus::FINISH;
+      m_stream.Finish(Status(StatusCode::UNIMPLEMENTED, ""), this);
+      break;
+    }
+
+    // tells the sender the stream is taken
+    m_receive_status = RpcCallStatus::WAIT;
+    m_stream.SendInitialMetadata(this);
+  } break;
+
+  case RpcCallStatus::PROCESS: {
+    unpackFrame();
+
+    // the sender keeps the frame until it is acknowledged
+    Slice empty_reply;
+    ByteBuffer ack(&empty_reply, 1);
+    m_receive_status = RpcCallStatus::WAIT;
+    m_stream.Write(ack, this);
+  } break;
+
+  case RpcCallStatus::WAIT: {
+    m_receive_status = RpcCallStatus::PROCESS;
+    m_stream.Read(&m_frame, this);
+  } break;
+
+  default: {
+    delete this;
+  } break;
+  }
+}
+
+// a failed read means the sender closed or lost the stream
+void RecvMergerStream::fail() {
+  if (m_receive_status == RpcCallStatus::PROCESS ||
+      m_receive_status == RpcCallStatus::WAIT) {
+    m_receive_status = RpcCallStatus::FINISH;
+    m_stream.Finish(Status::OK, this);
+  } else {
+    delete this;
+  }
+}
+
+void RecvMergerStream::unpackFrame() {
+  std::vector<Slice> slices;
+  if (!m_frame.Dump(&slices).ok())
+    return;
+
+  // a frame usually arrives in one slice and is read where it is; only a
+  // split one is joined first
+  std::string joined_frame;
+  const char *frame;
+  size_t frame_size;
+  if (slices.size() == 1) {
+    frame = reinterpret_cast<const char *>(slices[0].begin());
+    frame_size = slices[0].size();
+  } else {
+    joined_frame.reserve(m_frame.Length());
+    for (auto &slice : slices)
+      joined_frame.append(reinterpret_cast<const char *>(slice.begin()),
+                          slice.size());
+    frame = joined_frame.data();
+    frame_size = joined_frame.size();
+  }
+
+  size_t pos = MergerFrame::readPrefix(frame, frame_size);
+  if (pos == 0) {
+    CLOG(ERROR, "MSVR") << "Malformed frame from merger (" << frame_size
+                        << " bytes dropped)";
+    return;
+  }
+
+  MessageHandler message_handler;
+  while (pos + HEADER_LENGTH <= frame_size) {
+    MessageHeader header = HeaderController::parseHeader(frame + pos);
+    size_t msg_size = static_cast<size_t>(
+        HeaderController::convertU8ToU32BE(header.total_length));
+    if (msg_size < HEADER_LENGTH || pos + msg_size > frame_size)
+      break;
+
+    Status rpc_status;
+    id_type recv_id;
+    message_handler.unpackMsg(frame + pos, msg_size, rpc_status, recv_id);
+
+    pos += msg_size;
+  }
+
+  if (pos != frame_size)
+    CLOG(ERROR, "MSVR") << "Malformed frame from merger (" << frame_size - pos
+                        << " bytes dropped)";
+}
+
 void RecvFromSE::proceed(bool st) {
   if (!st) {
     delete this;
@@ -144,16 +273,17 @@ void RecvFromSE::proceed(bool st) {
   } break;
 
   case RpcCallStatus::PROCESS: {
-    new RecvFromSE(m_service, m_completion_queue);
+    new RecvFromSE(m_service, m_completion_queue, m_rpc_workers);
 
-    std::async(std::launch::async, [this]() {
+    m_rpc_workers->post([this]() {
       Status rpc_status;
       servend_id_type receiver_id;
       Reply m_reply;
       try {
-        std::string packed_msg = m_request.message();
+        const std::string &packed_msg = m_request.message();
         MessageHandler message_handler;
-        message_handler.unpackMsg(packed_msg, rpc_status, receiver_id);
+        message_handler.unpackMsg(packed_msg.data(), packed_msg.size(),
+                                  rpc_status, receiver_id);
 
         if (rpc_status.ok()) {
           m_reply.set_status(Reply_Status_SUCCESS);
@@ -236,16 +366,17 @@ void SignerService::proceed(bool st) {
   } break;
 
   case RpcCallStatus::PROCESS: {
-    new SignerService(m_service, m_completion_queue);
+    new SignerService(m_service, m_completion_queue, m_rpc_workers);
 
-    std::async(std::launch::async, [this]() {
+    m_rpc_workers->post([this]() {
       Status rpc_status;
       id_type receiver_id;
       MsgStatus m_reply;
       try {
-        std::string packed_msg = m_request.message();
+        const std::string &packed_msg = m_request.message();
         MessageHandler message_handler;
-        message_handler.unpackMsg(packed_msg, rpc_status, receiver_id);
+        message_handler.unpackMsg(packed_msg.data(), packed_msg.size(),
+                                  rpc_status, receiver_id);
 
         if (rpc_status.ok()) {
           m_reply.set_status(MsgStatus_Status_SUCCESS);
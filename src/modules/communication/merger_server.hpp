@@ -1,156 +1,210 @@
-#ifndef GRUUT_ENTERPRISE_MERGER_MERGER_SERVER_HPP
-#define GRUUT_ENTERPRISE_MERGER_MERGER_SERVER_HPP
-
-#include "../../services/input_queue.hpp"
-#include "protos/health.grpc.pb.h"
-#include "protos/protobuf_merger.grpc.pb.h"
-#include "protos/protobuf_se.grpc.pb.h"
-#include "protos/protobuf_signer.grpc.pb.h"
-#include "rpc_receiver_list.hpp"
-#include <atomic>
-#include <grpc/support/log.h>
-#include <grpcpp/grpcpp.h>
-#include <iostream>
-#include <memory>
-
-#include "easy_logging.hpp"
-
-using namespace grpc;
-using namespace grpc_merger;
-using namespace grpc_se;
-using namespace grpc_signer;
-
-namespace gruut {
-
-class MergerServer {
-public:
-  MergerServer() {
-    m_input_queue = InputQueueAlt::getInstance();
-    el::Loggers::getLogger("MSVR");
-  }
-  ~MergerServer() {
-    m_server->Shutdown();
-    m_completion_queue->Shutdown();
-  }
-  void runServer(const std::string &port_num);
-
-  inline bool isStarted() { return m_is_started; }
-
-private:
-  std::string m_port_num;
-  std::unique_ptr<Server> m_server;
-  std::unique_ptr<ServerCompletionQueue> m_completion_queue;
-  MergerCommunication::AsyncService m_merger_service;
-  GruutSeService::AsyncService m_se_service;
-  GruutSignerService::AsyncService m_signer_service;
-  InputQueueAlt *m_input_queue;
-  void recvMessage();
-  std::atomic<bool> m_is_started{false};
-};
-
-class CallData {
-public:
-  virtual void proceed(bool st = true) = 0;
-
-protected:
-  ServerCompletionQueue *m_completion_queue;
-  ServerContext m_context;
-  RpcCallStatus m_receive_status;
-};
-
-class CheckConn final : public CallData {
-public:
-  CheckConn(MergerCommunication::AsyncService *service,
-            ServerCompletionQueue *cq)
-      : m_responder(&m_context) {
-    m_service = service;
-    m_completion_queue = cq;
-    m_receive_status = RpcCallStatus::CREATE;
-    proceed();
-  }
-
-  void proceed(bool st = true);
-
-private:
-  MergerCommunication::AsyncService *m_service;
-  ConnCheckRequest m_request;
-  ServerAsyncResponseWriter<ConnCheckResponse> m_responder;
-};
-
-class RecvFromMerger final : public CallData {
-public:
-  RecvFromMerger(MergerCommunication::AsyncService *service,
-                 ServerCompletionQueue *cq)
-      : m_responder(&m_context) {
-    m_service = service;
-    m_completion_queue = cq;
-    m_receive_status = RpcCallStatus::CREATE;
-    proceed();
-  }
-  void proceed(bool st = true);
-
-private:
-  MergerCommunication::AsyncService *m_service;
-  MergerDataRequest m_request;
-  ServerAsyncResponseWriter<MergerDataReply> m_responder;
-};
-
-class RecvFromSE final : public CallData {
-public:
-  RecvFromSE(GruutSeService::AsyncService *service, ServerCompletionQueue *cq)
-      : m_responder(&m_context) {
-    m_service = service;
-    m_completion_queue = cq;
-    m_receive_status = RpcCallStatus::CREATE;
-    proceed();
-  }
-  void proceed(bool st = true);
-
-private:
-  GruutSeService::AsyncService *m_service;
-  Request m_request;
-  ServerAsyncResponseWriter<Reply> m_responder;
-};
-
-class OpenChannel final : public CallData {
-public:
-  OpenChannel(GruutSignerService::AsyncService *service,
-              ServerCompletionQueue *cq)
-      : m_stream(&m_context) {
-    m_service = service;
-    m_completion_queue = cq;
-    m_receive_status = RpcCallStatus::CREATE;
-    m_rpc_receiver_list = RpcReceiverList::getInstance();
-    proceed();
-  }
-  void proceed(bool st = true);
-
-private:
-  std::string m_signer_id_b64;
-  RpcReceiverList *m_rpc_receiver_list;
-  GruutSignerService::AsyncService *m_service;
-  Identity m_request;
-  ServerAsyncReaderWriter<ReplyMsg, Identity> m_stream;
-};
-
-class SignerService final : public CallData {
-public:
-  SignerService(GruutSignerService::AsyncService *service,
-                ServerCompletionQueue *cq)
-      : m_responder(&m_context) {
-    m_service = service;
-    m_completion_queue = cq;
-    m_receive_status = RpcCallStatus::CREATE;
-    proceed();
-  }
-  void proceed(bool st = true);
-
-private:
-  GruutSignerService::AsyncService *m_service;
-  RequestMsg m_request;
-  ServerAsyncResponseWriter<MsgStatus> m_responder;
-};
-
-} // namespace gruut
-
+#ifndef GRUUT_ENTERPRISE_MERGER_MERGER_SERVER_HPP
+#define GRUUT_ENTERPRISE_MERGER_MERGER_SERVER_HPP
+
+#include "../../config/config.hpp"
+#include "../../services/input_queue.hpp"
+#include "../../utils/worker_pool.hpp"
+#include "protos/health.grpc.pb.h"
+#include "protos/protobuf_merger.grpc.pb.h"
+#include "protos/protobuf_se.grpc.pb.h"
+#include "protos/protobuf_signer.grpc.pb.h"
+#include "rpc_receiver_list.hpp"
+#include <atomic>
+#include <chrono>
+#include <grpc/support/log.h>
+#include <grpcpp/generic/async_generic_service.h>
+#include <grpcpp/grpcpp.h>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "easy_logging.hpp"
+
+using namespace grpc;
+using namespace grpc_merger;
+using namespace grpc_se;
+using namespace grpc_signer;
+
+namespace gruut {
+
+class MergerServer {
+public:
+  MergerServer() {
+    m_input_queue = InputQueueAlt::getInstance();
+    el::Loggers::getLogger("MSVR");
+  }
+  // handlers still queued on the workers finish their calls before the
+  // completion queues are shut down; the streams of other mergers and
+  // signers never end by themselves, so calls still open after
+  // MERGER_SEND_TIMEOUT are cancelled
+  ~MergerServer() {
+    if (m_server != nullptr)
+      m_server->Shutdown(
+          std::chrono::system_clock::now() +
+          std::chrono::milliseconds(config::MERGER_SEND_TIMEOUT));
+    m_rpc_workers.reset();
+    for (auto &completion_queue : m_completion_queues)
+      completion_queue->Shutdown();
+    for (auto &cq_thread : m_cq_threads) {
+      if (cq_thread.joinable())
+        cq_thread.join();
+    }
+  }
+  void runServer(const std::string &port_num);
+
+  inline bool isStarted() { return m_is_started; }
+
+private:
+  std::string m_port_num;
+  std::unique_ptr<Server> m_server;
+  std::vector<std::unique_ptr<ServerCompletionQueue>> m_completion_queues;
+  std::vector<std::thread> m_cq_threads;
+  std::unique_ptr<WorkerPool> m_rpc_workers;
+  MergerCommunication::AsyncService m_merger_service;
+  AsyncGenericService m_generic_service;
+  GruutSeService::AsyncService m_se_service;
+  GruutSignerService::AsyncService m_signer_service;
+  InputQueueAlt *m_input_queue;
+  void recvMessage(ServerCompletionQueue *completion_queue);
+  std::atomic<bool> m_is_started{false};
+};
+
+class CallData {
+public:
+  virtual void proceed(bool st = true) = 0;
+  // an operation came back not ok; most calls wait for their next event
+  virtual void fail() {}
+
+protected:
+  ServerCompletionQueue *m_completion_queue;
+  ServerContext m_context;
+  RpcCallStatus m_receive_status;
+};
+
+class CheckConn final : public CallData {
+public:
+  CheckConn(MergerCommunication::AsyncService *service,
+            ServerCompletionQueue *cq)
+      : m_responder(&m_context) {
+    m_service = service;
+    m_completion_queue = cq;
+    m_receive_status = RpcCallStatus::CREATE;
+    proceed();
+  }
+
+  void proceed(bool st = true);
+
+private:
+  MergerCommunication::AsyncService *m_service;
+  ConnCheckRequest m_request;
+  ServerAsyncResponseWriter<ConnCheckResponse> m_responder;
+};
+
+class RecvFromMerger final : public CallData {
+public:
+  RecvFromMerger(MergerCommunication::AsyncService *service,
+                 ServerCompletionQueue *cq, WorkerPool *workers)
+      : m_responder(&m_context) {
+    m_service = service;
+    m_completion_queue = cq;
+    m_rpc_workers = workers;
+    m_receive_status = RpcCallStatus::CREATE;
+    proceed();
+  }
+  void proceed(bool st = true);
+
+private:
+  MergerCommunication::AsyncService *m_service;
+  WorkerPool *m_rpc_workers;
+  MergerDataRequest m_request;
+  ServerAsyncResponseWriter<MergerDataReply> m_responder;
+};
+
+// one long-lived stream per merger peer; each read is a MergerFrame of
+// packed messages laid end to end, answered by an empty MergerDataReply once
+// its messages are handled
+class RecvMergerStream final : public CallData {
+public:
+  RecvMergerStream(AsyncGenericService *service, ServerCompletionQueue *cq)
+      : m_stream(&m_generic_context) {
+    m_service = service;
+    m_completion_queue = cq;
+    m_receive_status = RpcCallStatus::CREATE;
+    proceed();
+  }
+  void proceed(bool st = true);
+  void fail() override;
+
+private:
+  AsyncGenericService *m_service;
+  GenericServerContext m_generic_context;
+  GenericServerAsyncReaderWriter m_stream;
+  ByteBuffer m_frame;
+  void unpackFrame();
+};
+
+class RecvFromSE final : public CallData {
+public:
+  RecvFromSE(GruutSeService::AsyncService *service, ServerCompletionQueue *cq,
+             WorkerPool *workers)
+      : m_responder(&m_context) {
+    m_service = service;
+    m_completion_queue = cq;
+    m_rpc_workers = workers;
+    m_receive_status = RpcCallStatus::CREATE;
+    proceed();
+  }
+  void proceed(bool st = true);
+
+private:
+  GruutSeService::AsyncService *m_service;
+  WorkerPool *m_rpc_workers;
+  Request m_request;
+  ServerAsyncResponseWriter<Reply> m_responder;
+};
+
+class OpenChannel final : public CallData {
+public:
+  OpenChannel(GruutSignerService::AsyncService *service,
+              ServerCompletionQueue *cq)
+      : m_stream(&m_context) {
+    m_service = service;
+    m_completion_queue = cq;
+    m_receive_status = RpcCallStatus::CREATE;
+    m_rpc_receiver_list = RpcReceiverList::getInstance();
+    proceed();
+  }
+  void proceed(bool st = true);
+
+private:
+  std::string m_signer_id_b64;
+  RpcReceiverList *m_rpc_receiver_list;
+  GruutSignerService::AsyncService *m_service;
+  Identity m_request;
+  ServerAsyncReaderWriter<ReplyMsg, Identity> m_stream;
+};
+
+class SignerService final : public CallData {
+public:
+  SignerService(GruutSignerService::AsyncService *service,
+                ServerCompletionQueue *cq, WorkerPool *workers)
+      : m_responder(&m_context) {
+    m_service = service;
+    m_completion_queue = cq;
+    m_rpc_workers = workers;
+    m_receive_status = RpcCallStatus::CREATE;
+    proceed();
+  }
+  void proceed(bool st = true);
+
+private:
+  GruutSignerService::AsyncService *m_service;
+  WorkerPool *m_rpc_workers;
+  RequestMsg m_request;
+  ServerAsyncResponseWriter<MsgStatus> m_responder;
+};
+
+} // namespace gruut
+
 #endif
\ No newline at end of file
@@ -16,40 +16,43 @@ MessageHandler::MessageHandler() {
 
 void MessageHandler::unpackMsg(std::string &packed_msg,
                                grpc::Status &rpc_status, id_type &recv_id) {
+  unpackMsg(packed_msg.data(), packed_msg.size(), rpc_status, recv_id);
+}
+
+// reads the message in place; only the decoded body is copied out
+void MessageHandler::unpackMsg(const char *packed_msg, size_t msg_size,
+                               grpc::Status &rpc_status, id_type &recv_id) {
   using namespace grpc;
-  if (packed_msg.size() < HEADER_LENGTH) {
+  if (msg_size < HEADER_LENGTH) {
     rpc_status = Status(StatusCode::INVALID_ARGUMENT,
                         "Wrong Message (MessageHandler::unpackMsg)");
     return;
   }
   MessageHeader header = HeaderController::parseHeader(packed_msg);
-  if (!validateMsgFormat(header)) {
+  int body_size = getMsgBodySize(header);
+  if (!validateMsgFormat(header) || body_size < 0 ||
+      HEADER_LENGTH + static_cast<size_t>(body_size) > msg_size) {
     rpc_status = Status(StatusCode::INVALID_ARGUMENT, "Wrong Message");
     return;
   }
-  size_t body_size = getMsgBodySize(header);
   recv_id = header.sender_id;
-  std::string recv_str_id = TypeConverter::encodeBase64(recv_id);
 
-  if (header.mac_algo_type == MACAlgorithmType::HMAC) {
-    std::string msg = packed_msg.substr(0, HEADER_LENGTH + body_size);
-    std::vector<uint8_t> hmac(packed_msg.begin() + HEADER_LENGTH + body_size,
-                              packed_msg.end());
+  const char *msg_body = packed_msg + HEADER_LENGTH;
 
-    auto signer_pool = SignerPool::getInstance();
-    Botan::secure_vector<uint8_t> secure_vector_key =
-        signer_pool->getHmacKey(recv_id);
-    std::vector<uint8_t> key = std::vector<uint8_t>(secure_vector_key.begin(),
-                                                    secure_vector_key.end());
+  if (header.mac_algo_type == MACAlgorithmType::HMAC) {
+    auto msg = reinterpret_cast<const uint8_t *>(packed_msg);
+    size_t hmac_offset = HEADER_LENGTH + body_size;
+    std::vector<uint8_t> hmac(msg + hmac_offset, msg + msg_size);
 
-    if (!Hmac::verifyHMAC(msg, hmac, key)) {
+    auto hmac_context = SignerPool::getInstance()->getHmacContext(recv_id);
+    if (hmac_context == nullptr ||
+        !hmac_context->verify(msg, hmac_offset, hmac)) {
       rpc_status = Status(StatusCode::UNAUTHENTICATED, "Wrong HMAC");
       return;
     }
   }
 
-  std::string msg_body = getMsgBody(packed_msg, body_size);
-  json json_data = getJson(header.compression_algo_type, msg_body);
+  json json_data = getJson(header.compression_algo_type, msg_body, body_size);
 
   if (!JsonValidator::validateSchema(json_data, header.message_type)) {
     rpc_status =
@@ -64,30 +67,37 @@ void MessageHandler::unpackMsg(std::string &packed_msg,
 void MessageHandler::packMsg(OutputMsgEntry &output_msg) {
   MessageType msg_type = output_msg.type;
 
-  json body = output_msg.body;
   MessageHeader header;
   header.message_type = msg_type;
 
   header.compression_algo_type = config::DEFAULT_COMPRESSION_TYPE;
-  std::string packed_msg = genPackedMsg(header, body);
+  std::string packed_msg = genPackedMsg(header, output_msg.body);
   std::vector<std::string> packed_msg_list;
 
   if (msg_type == MessageType::MSG_ACCEPT ||
       msg_type == MessageType::MSG_REQ_SSIG) {
     auto signer_pool = SignerPool::getInstance();
-
-    for (auto &recv_id : output_msg.receivers) {
-      Botan::secure_vector<uint8_t> secure_vector_key =
-          signer_pool->getHmacKey(recv_id);
-      std::vector<uint8_t> key(secure_vector_key.begin(),
-                               secure_vector_key.end());
-      std::vector<uint8_t> hmac = Hmac::generateHMAC(packed_msg, key);
-      std::string str_hmac(hmac.begin(), hmac.end());
-      std::string hmac_packed_data = packed_msg + str_hmac;
-      packed_msg_list.emplace_back(hmac_packed_data);
+    auto &receivers = output_msg.receivers;
+
+    // sendToSigner pairs receivers and messages by index, so a signer that
+    // has left is taken out of the receivers as well
+    for (auto it_recv = receivers.begin(); it_recv != receivers.end();) {
+      auto hmac_context = signer_pool->getHmacContext(*it_recv);
+      if (hmac_context == nullptr) {
+        it_recv = receivers.erase(it_recv);
+        continue;
+      }
+      std::vector<uint8_t> hmac = hmac_context->generate(packed_msg);
+
+      std::string hmac_packed_data;
+      hmac_packed_data.reserve(packed_msg.size() + hmac.size());
+      hmac_packed_data.append(packed_msg);
+      hmac_packed_data.append(hmac.begin(), hmac.end());
+      packed_msg_list.emplace_back(std::move(hmac_packed_data));
+      ++it_recv;
     }
   } else {
-    packed_msg_list.emplace_back(packed_msg);
+    packed_msg_list.emplace_back(std::move(packed_msg));
   }
 
   MergerClient merger_client;
@@ -111,22 +121,17 @@ int MessageHandler::getMsgBodySize(MessageHeader &header) {
   return body_size;
 }
 
-std::string MessageHandler::getMsgBody(std::string &packed_msg, int body_size) {
-  std::string packed_body = packed_msg.substr(HEADER_LENGTH, body_size);
-  return packed_body;
-}
-
 json MessageHandler::getJson(CompressionAlgorithmType compression_type,
-                             std::string &body) {
+                             const char *body, size_t body_size) {
   json unpacked_body;
-  if (!body.empty()) {
+  if (body_size > 0) {
     switch (compression_type) {
     case CompressionAlgorithmType::LZ4: {
-      std::string origin_data = Compressor::decompressData(body);
+      std::string origin_data = Compressor::decompressData(body, body_size);
       unpacked_body = Safe::parseJson(origin_data);
     } break;
     case CompressionAlgorithmType::NONE: {
-      unpacked_body = Safe::parseJson(body);
+      unpacked_body = Safe::parseJson(body, body_size);
     } break;
     default:
       break;
@@ -135,21 +140,27 @@ json MessageHandler::getJson(CompressionAlgorithmType compression_type,
   return unpacked_body;
 }
 
-std::string MessageHandler::genPackedMsg(MessageHeader &header, json &body) {
+// the body is written right behind room left for the header, which is
+// filled in last, so the message is built in one buffer
+std::string MessageHandler::genPackedMsg(MessageHeader &header,
+                                         const json &body) {
   std::string body_dump = body.dump();
 
+  std::string packed_msg;
+  packed_msg.resize(HEADER_LENGTH);
+
   switch (header.compression_algo_type) {
   case CompressionAlgorithmType::LZ4: {
-    std::string compressed_body = Compressor::compressData(body_dump);
-    body_dump = compressed_body;
+    Compressor::appendCompressed(body_dump, packed_msg);
   } break;
   case CompressionAlgorithmType ::NONE:
   default:
+    packed_msg.append(body_dump);
     break;
   }
 
-  std::string packed_msg = HeaderController::attachHeader(
-      body_dump, header.message_type, header.compression_algo_type);
+  HeaderController::writeHeader(packed_msg, header.message_type,
+                                header.compression_algo_type);
   return packed_msg;
 }
 
@@ -19,6 +19,8 @@ public:
   MessageHandler();
   void unpackMsg(std::string &packed_msg, grpc::Status &rpc_status,
                  id_type &receiver_id);
+  void unpackMsg(const char *packed_msg, size_t msg_size,
+                 grpc::Status &rpc_status, id_type &receiver_id);
   void packMsg(OutputMsgEntry &output_msg);
 
   void genInternalMsg(MessageType msg_type, std::string &id_b64);
@@ -27,9 +29,9 @@ private:
   InputQueueAlt *m_input_queue;
   bool validateMsgFormat(MessageHeader &header);
   int getMsgBodySize(MessageHeader &header);
-  std::string getMsgBody(std::string &packed_msg, int body_size);
-  json getJson(CompressionAlgorithmType compression_type, std::string &body);
-  std::string genPackedMsg(MessageHeader &header, json &body);
+  json getJson(CompressionAlgorithmType compression_type, const char *body,
+               size_t body_size);
+  std::string genPackedMsg(MessageHeader &header, const json &body);
 };
 
 } // namespace gruut
@@ -527,12 +527,97 @@ const json SCHEMA_RES_STATUS = R"({
   ]
 })"_json;
 
+const json SCHEMA_REQ_BLOCK_RANGE = R"({
+  "title": "block range request",
+  "type": "object",
+  "properties": {
+    "mID": {
+      "type": "string"
+    },
+    "time": {
+      "type": "string"
+    },
+    "mCert": {
+      "type": "string"
+    },
+    "from": {
+      "type": "string"
+    },
+    "to": {
+      "type": "string"
+    },
+    "maxBytes": {
+      "type": "string"
+    },
+    "hdr": {
+      "type": "string"
+    },
+    "mSig": {
+      "type": "string"
+    }
+  },
+  "required": [
+    "mID",
+    "time",
+    "from",
+    "to"
+  ]
+})"_json;
+
+const json SCHEMA_BLOCK_RANGE = R"({
+  "title": "Block range",
+  "type": "object",
+  "properties": {
+    "mID": {
+      "type": "string"
+    },
+    "time": {
+      "type": "string"
+    },
+    "from": {
+      "type": "string"
+    },
+    "to": {
+      "type": "string"
+    },
+    "hdr": {
+      "type": "string"
+    },
+    "blocks": {
+      "type": "array",
+      "items": {
+        "type": "object",
+        "properties": {
+          "blockraw": {
+            "type": "string"
+          },
+          "tx": {
+            "type": "array"
+          }
+        },
+        "required": [
+          "blockraw",
+          "tx"
+        ]
+      }
+    }
+  },
+  "required": [
+    "mID",
+    "from",
+    "to",
+    "blocks"
+  ]
+})"_json;
+
 const std::map<MessageType, json> MSG_SCHEMA_MAP = {
     {MessageType::MSG_UP, SCHEMA_UP},
     {MessageType::MSG_PING, SCHEMA_PING},
     {MessageType::MSG_WELCOME, SCHEMA_WELCOME},
     {MessageType::MSG_REQ_BLOCK, SCHEMA_REQ_BLOCK},
     {MessageType::MSG_BLOCK, SCHEMA_BLOCK},
+    {MessageType::MSG_REQ_BLOCK_RANGE, SCHEMA_REQ_BLOCK_RANGE},
+    {MessageType::MSG_BLOCK_RANGE, SCHEMA_BLOCK_RANGE},
     {MessageType::MSG_JOIN, SCHEMA_JOIN},
     {MessageType::MSG_RESPONSE_1, SCHEMA_RESPONSE_FIRST},
     {MessageType::MSG_SUCCESS, SCHEMA_SUCCESS},
@@ -4,7 +4,19 @@
 
 namespace gruut {
 
-BlockHealthChecker::BlockHealthChecker() { el::Loggers::getLogger("BHCH"); }
+BlockHealthChecker::BlockHealthChecker() {
+  m_get_cert_func = [](id_type &id) {
+    return CertificatePool::getInstance()->getCert(id);
+  };
+
+  m_get_user_cert_func = [](std::string &id_b64, timestamp_t t_time) {
+    auto &cert_ledger =
+        Application::app().getCustomLedgerManager().getCertificateLedger();
+    return cert_ledger.getCertificate(id_b64, t_time);
+  };
+
+  el::Loggers::getLogger("BHCH");
+}
 
 void BlockHealthChecker::start() {
   auto &io_service = Application::app().getIoService();
@@ -28,107 +40,159 @@ void BlockHealthChecker::startHealthCheck() {
 
   CLOG(INFO, "BHCH") << "BLOCK HEALTH CHECKING ---- START";
 
-  std::unique_ptr<Block> test_block;
+  block_height_type from_height = 1;
+  hash_t prev_hash =
+      TypeConverter::decodeBase64(config::GENESIS_BLOCK_PREV_HASH_B64);
+  block_id_type prev_block_id =
+      TypeConverter::decodeBase64(config::GENESIS_BLOCK_PREV_ID_B64);
+
+  // resume after the last checked block, unless it is no longer on the chain
+  ledger_tip_type checkpoint;
+  if (storage->getHealthCheckpoint(checkpoint) && checkpoint.height > 0 &&
+      checkpoint.height <= latest_block_info.height) {
+    auto checkpoint_link = storage->getNthBlockLinkInfo(checkpoint.height);
+    if (TypeConverter::encodeBase64(checkpoint_link.id) ==
+        checkpoint.block_id_b64) {
+      from_height = checkpoint.height + 1;
+      prev_hash = checkpoint_link.hash;
+      prev_block_id = checkpoint_link.id;
+
+      CLOG(INFO, "BHCH") << "Blocks up to " << checkpoint.height
+                         << " were checked before";
+    }
+  }
 
   bool is_healthy = true;
-  std::string prev_hash_b64 = config::GENESIS_BLOCK_PREV_HASH_B64;
-  std::string prev_block_id_b64 = config::GENESIS_BLOCK_PREV_ID_B64;
-  size_t last_healthy_block = 0;
-
-  size_t unit_step =
-      (latest_block_info.height < 10) ? 1 : latest_block_info.height / 10;
-
-  std::function<std::string(id_type &)> get_cert_func = [this](id_type &id) {
-    return CertificatePool::getInstance()->getCert(id);
-  };
+  block_height_type last_healthy_block = from_height - 1;
+
+  size_t num_to_check = latest_block_info.height + 1 - from_height;
+  size_t unit_step = (num_to_check < 10) ? 1 : num_to_check / 10;
+  size_t next_report = unit_step;
+
+  WorkerPool check_workers(
+      std::max(1u, std::thread::hardware_concurrency()) - 1);
+  auto begin_time = std::chrono::steady_clock::now();
+
+  for (block_height_type batch_from = from_height;
+       is_healthy && batch_from <= latest_block_info.height;
+       batch_from += config::HEALTH_CHECK_BATCH_SIZE) {
+
+    block_height_type batch_to = std::min<block_height_type>(
+        latest_block_info.height,
+        batch_from + config::HEALTH_CHECK_BATCH_SIZE - 1);
+
+    std::vector<BlockHealthRecord> records(batch_to + 1 - batch_from);
+    checkBlocks(check_workers, batch_from, records);
+
+    for (size_t i = 0; i < records.size(); ++i) {
+      auto &record = records[i];
+      if (!record.is_valid || record.prev_hash != prev_hash ||
+          record.prev_id != prev_block_id) {
+        CLOG(ERROR, "BHCH")
+            << "Health check is aborted. (found problem in block "
+            << TypeConverter::encodeBase64(record.id) << " at height "
+            << batch_from + i << ")";
+        is_healthy = false;
+        break;
+      }
+
+      last_healthy_block = batch_from + i;
+      prev_hash = record.hash;
+      prev_block_id = record.id;
+    }
 
-  std::function<std::string(std::string &, timestamp_t)> get_user_cert_func =
-      [this](std::string &id_b64, timestamp_t t_time) {
-        auto &cert_ledger =
-            Application::app().getCustomLedgerManager().getCertificateLedger();
-        return cert_ledger.getCertificate(id_b64, t_time);
-      };
-
-  for (size_t i = 1; i <= latest_block_info.height; ++i) {
-
-    if (i % unit_step == 0)
-      CLOG(INFO, "BHCH") << "Checking ... " << i << "/"
-                         << latest_block_info.height;
-
-    storage_block_type nth_block = storage->readBlock(i);
-    test_block.reset(new Block);
-    test_block->initialize(nth_block);
-    if (test_block->isValidEarly(get_cert_func) &&
-        test_block->isValidLate(get_user_cert_func) &&
-        test_block->getPrevHashB64() == prev_hash_b64 &&
-        test_block->getPrevBlockIdB64() == prev_block_id_b64) {
-
-      last_healthy_block = i;
-
-      prev_hash_b64 = test_block->getHashB64();
-      prev_block_id_b64 = test_block->getBlockIdB64();
-
-    } else {
-      CLOG(ERROR, "BHCH") << "Health check is aborted. (found problem in block "
-                          << test_block->getBlockIdB64() << ")";
-      is_healthy = false;
-      break;
+    if (last_healthy_block >= batch_from)
+      storage->saveHealthCheckpoint(last_healthy_block,
+                                    TypeConverter::encodeBase64(prev_block_id));
+
+    size_t num_checked = last_healthy_block + 1 - from_height;
+    if (num_checked >= next_report) {
+      CLOG(INFO, "BHCH") << "Checking ... " << last_healthy_block << "/"
+                         << latest_block_info.height << " ("
+                         << getBlocksPerSec(num_checked, begin_time)
+                         << " blocks/s)";
+      next_report = (num_checked / unit_step + 1) * unit_step;
     }
   }
 
   if (!is_healthy) {
-    // clang-format off
-    CLOG(ERROR, "BHCH") << "+-------------------------------------------------------------------------+";
-    CLOG(ERROR, "BHCH") << "| DB health check has been failed.                                        |";
-    CLOG(ERROR, "BHCH") << "| It is strongly recommended to stop running and repair DB.               |";
-    CLOG(ERROR, "BHCH") << "| To run anyway, input 'run'.                                             |";
-    CLOG(ERROR, "BHCH") << "| To run after deleting blocks from corrupted one, input 'del'.           |";
-    CLOG(ERROR, "BHCH") << "| To abort run, press ctrl+C or input others                              |";
-    CLOG(ERROR, "BHCH") << "+-------------------------------------------------------------------------+";
-    // clang-format on
-
-    std::string commend;
-    std::cout << "run / del / [quit] : ";
-    std::getline(std::cin, commend);
-    std::transform(commend.begin(), commend.end(), commend.begin(), ::tolower);
-
-    if (commend == "run") {
+    if (Setting::getInstance()->getDBCheckIgnore()) {
       // clang-format off
       CLOG(ERROR, "BHCH") << "+-------------------------------------------------------------------------+";
-      CLOG(ERROR, "BHCH") << "| Warning! No guarantee to work correctly. :(                             |";
+      CLOG(ERROR, "BHCH") << "| DB health check has been failed.                                        |";
+      CLOG(ERROR, "BHCH") << "| It is strongly recommended to stop running and repair DB.               |";
+      CLOG(ERROR, "BHCH") << "| Running anyway; no guarantee to work correctly. :(                      |";
       CLOG(ERROR, "BHCH") << "+-------------------------------------------------------------------------+";
       // clang-format on
 
       endCheck(ExitCode::ERROR_BLOCK_HEALTH_SKIP);
       return;
+    }
 
-    } else if (commend == "del") {
-
-      // TODO : delete blocks in the storage
-
-    } else {
-      // clang-format off
-      CLOG(INFO, "BHCH") << "+-------------------------------------------------------------------------+";
-      CLOG(INFO, "BHCH") << "| Bye.                                                                    |";
-      CLOG(INFO, "BHCH") << "+-------------------------------------------------------------------------+";
-      // clang-format on
+    // clang-format off
+    CLOG(ERROR, "BHCH") << "+-------------------------------------------------------------------------+";
+    CLOG(ERROR, "BHCH") << "| DB health check has been failed.                                        |";
+    CLOG(ERROR, "BHCH") << "| Stopped. Repair DB, or run with --dbcheckignore to run anyway. :(       |";
+    CLOG(ERROR, "BHCH") << "+-------------------------------------------------------------------------+";
+    // clang-format on
 
-      endCheck(ExitCode::ERROR_ABORT);
-      return;
-    }
+    endCheck(ExitCode::ERROR_ABORT);
+    return;
 
   } else {
     // clang-format off
     CLOG(INFO, "BHCH") << "+-------------------------------------------------------------------------+";
     CLOG(INFO, "BHCH") << "| All blocks are clear. :)                                                |";
     CLOG(INFO, "BHCH") << "+-------------------------------------------------------------------------+";
-    CLOG(INFO, "BHCH") << "BLOCK HEALTH CHECKING ---- END";
     // clang-format on
+    CLOG(INFO, "BHCH") << "BLOCK HEALTH CHECKING ---- END (#block="
+                       << num_to_check << ","
+                       << getBlocksPerSec(num_to_check, begin_time)
+                       << " blocks/s)";
   }
 
   endCheck(ExitCode::NORMAL);
 }
 
+// reads, decodes and verifies blocks [from_height, from_height +
+// records.size()) on the calling thread and all the workers
+void BlockHealthChecker::checkBlocks(WorkerPool &check_workers,
+                                     block_height_type from_height,
+                                     std::vector<BlockHealthRecord> &records) {
+  auto storage = Storage::getInstance();
+  std::atomic<size_t> next_idx{0};
+
+  auto check_task = [this, storage, from_height, &records, &next_idx]() {
+    size_t idx;
+    while ((idx = next_idx++) < records.size()) {
+      storage_block_type nth_block = storage->readBlock(from_height + idx);
+      Block test_block;
+      if (!test_block.initialize(nth_block))
+        continue;
+
+      auto &record = records[idx];
+      record.id = test_block.getBlockId();
+      record.prev_id = test_block.getPrevBlockId();
+      record.hash = test_block.getHash();
+      record.prev_hash = test_block.getPrevHash();
+      record.is_valid = test_block.isValidEarly(m_get_cert_func) &&
+                        test_block.isValidLate(m_get_user_cert_func);
+    }
+  };
+
+  std::vector<std::function<void()>> check_tasks(check_workers.size() + 1,
+                                                 check_task);
+  check_workers.runAll(check_tasks);
+}
+
+double BlockHealthChecker::getBlocksPerSec(
+    size_t num_blocks, std::chrono::steady_clock::time_point begin_time) {
+  auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - begin_time)
+                        .count();
+  return (elapsed_ms == 0) ? 0.0 : num_blocks * 1000.0 / elapsed_ms;
+}
+
 void BlockHealthChecker::endCheck(ExitCode exit_code) {
   m_finish = true;
   stageOver(exit_code);
@@ -5,18 +5,35 @@
 #include "../../chain/types.hpp"
 #include "../../config/config.hpp"
 #include "../../services/storage.hpp"
+#include "../../utils/worker_pool.hpp"
 
 #include "../module.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace gruut {
 
+// outcome of the checks a block can pass on its own; links between blocks
+// are checked afterwards over these
+struct BlockHealthRecord {
+  bool is_valid{false};
+  block_id_type id;
+  block_id_type prev_id;
+  hash_t hash;
+  hash_t prev_hash;
+};
+
 class BlockHealthChecker : public Module {
 private:
+  std::function<std::string(id_type &)> m_get_cert_func;
+  std::function<std::string(std::string &, timestamp_t)> m_get_user_cert_func;
+
 public:
   BlockHealthChecker();
   void start() override;
@@ -25,6 +42,10 @@ public:
 
 private:
   void startHealthCheck();
+  void checkBlocks(WorkerPool &check_workers, block_height_type from_height,
+                   std::vector<BlockHealthRecord> &records);
+  double getBlocksPerSec(size_t num_blocks,
+                         std::chrono::steady_clock::time_point begin_time);
   void endCheck(ExitCode exit_code);
   std::atomic<bool> m_finish{false};
 };
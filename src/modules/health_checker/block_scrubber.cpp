@@ -0,0 +1,119 @@
+#include "block_scrubber.hpp"
+#include "../../application.hpp"
+#include "easy_logging.hpp"
+
+namespace gruut {
+
+BlockScrubber::BlockScrubber() {
+  m_storage = Storage::getInstance();
+  auto &io_service = Application::app().getIoService();
+  m_scrub_scheduler.setIoService(io_service);
+
+  restartPass();
+
+  el::Loggers::getLogger("BSCR");
+}
+
+BlockScrubber::BlockScrubber(Storage *storage) : m_storage(storage) {
+  restartPass();
+
+  el::Loggers::getLogger("BSCR");
+}
+
+void BlockScrubber::start() {
+  if (config::MAX_SCRUB_BLOCKS_PER_TICK == 0)
+    return;
+
+  m_scrub_scheduler.setInterval(config::BLOCK_SCRUB_INTERVAL);
+  m_scrub_scheduler.setTaskFunction([this]() { scrubNext(); });
+  m_scrub_scheduler.runTask();
+}
+
+BlockScrubStat BlockScrubber::getScrubStat() {
+  std::lock_guard<std::mutex> guard(m_scrub_mutex);
+  BlockScrubStat stat = m_stat;
+  stat.scrub_height = m_scrub_height;
+  return stat;
+}
+
+// one tick: at most MAX_SCRUB_BLOCKS_PER_TICK blocks or
+// MAX_SCRUB_BYTES_PER_TICK raw bytes, whichever comes first
+void BlockScrubber::scrubNext() {
+  std::lock_guard<std::mutex> guard(m_scrub_mutex);
+
+  // the latest block may still be half-written (its transactions go to
+  // storage after the latest height), so it waits for the next one
+  auto latest_block_info = m_storage->getNthBlockLinkInfo();
+  if (latest_block_info.height <= 1)
+    return;
+
+  size_t num_bytes = 0;
+  for (size_t i = 0; i < config::MAX_SCRUB_BLOCKS_PER_TICK &&
+                     num_bytes < config::MAX_SCRUB_BYTES_PER_TICK;
+       ++i) {
+    if (m_scrub_height >= latest_block_info.height) {
+      ++m_stat.num_passes;
+      CLOG(INFO, "BSCR") << "Scrubbed blocks up to "
+                         << latest_block_info.height - 1 << " (#pass="
+                         << m_stat.num_passes
+                         << ",#bad=" << m_stat.num_bad_blocks << ")";
+      restartPass();
+      break;
+    }
+
+    if (!scrubBlock(m_scrub_height, num_bytes)) {
+      ++m_stat.num_bad_blocks;
+      m_stat.last_bad_height = m_scrub_height;
+    }
+
+    ++m_stat.num_blocks;
+    ++m_scrub_height;
+  }
+}
+
+bool BlockScrubber::scrubBlock(block_height_type height, size_t &num_bytes) {
+  storage_block_type nth_block = m_storage->readBlock(height);
+  num_bytes += nth_block.block_raw.size();
+
+  Block test_block;
+  std::string problem;
+
+  if (nth_block.block_raw.empty()) {
+    problem = "missing block";
+  } else if (!test_block.initialize(nth_block)) {
+    problem = "undecodable block";
+  } else if (test_block.getHash() != nth_block.hash) {
+    problem = "raw block does not match its hash";
+  } else if (test_block.getBlockId() != nth_block.id ||
+             test_block.getHeight() != height) {
+    problem = "block is indexed at a wrong height";
+  } else if (!test_block.hasValidTxRoot()) {
+    problem = "transactions do not match the Merkle root";
+  } else if (test_block.getPrevHash() != m_prev_hash ||
+             test_block.getPrevBlockId() != m_prev_block_id) {
+    problem = "block is not linked to the one below";
+  }
+
+  // the chain is followed from this block on even if it is bad, so one
+  // broken block is not reported again as a broken link above it
+  m_prev_hash = nth_block.hash;
+  m_prev_block_id = nth_block.id;
+
+  if (problem.empty())
+    return true;
+
+  CLOG(ERROR, "BSCR") << "Bad block at height " << height << " ("
+                      << TypeConverter::encodeBase64(nth_block.id)
+                      << "): " << problem;
+  return false;
+}
+
+void BlockScrubber::restartPass() {
+  m_scrub_height = 1;
+  m_prev_hash =
+      TypeConverter::decodeBase64(config::GENESIS_BLOCK_PREV_HASH_B64);
+  m_prev_block_id =
+      TypeConverter::decodeBase64(config::GENESIS_BLOCK_PREV_ID_B64);
+}
+
+} // namespace gruut
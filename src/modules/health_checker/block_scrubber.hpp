@@ -0,0 +1,57 @@
+#ifndef GRUUT_ENTERPRISE_MERGER_BLOCK_SCRUBBER_HPP
+#define GRUUT_ENTERPRISE_MERGER_BLOCK_SCRUBBER_HPP
+
+#include "../../chain/block.hpp"
+#include "../../chain/types.hpp"
+#include "../../config/config.hpp"
+#include "../../services/storage.hpp"
+#include "../../utils/periodic_task.hpp"
+
+#include "../module.hpp"
+
+#include <mutex>
+#include <string>
+
+namespace gruut {
+
+struct BlockScrubStat {
+  uint64_t num_passes{0}; // completed passes over the whole chain
+  uint64_t num_blocks{0};
+  uint64_t num_bad_blocks{0};
+  block_height_type scrub_height{0}; // next block to check
+  block_height_type last_bad_height{0};
+};
+
+// Re-verifies stored blocks in the background, a few at a time, while the
+// merger serves traffic: the raw block against its `_hash` key, the Merkle
+// root of the stored transactions against `txrt`, and the link to the block
+// below. Problems are logged and counted; nothing is repaired.
+class BlockScrubber : public Module {
+private:
+  Storage *m_storage;
+  PeriodicTask m_scrub_scheduler;
+
+  block_height_type m_scrub_height{1};
+  hash_t m_prev_hash;
+  block_id_type m_prev_block_id;
+
+  BlockScrubStat m_stat;
+  std::mutex m_scrub_mutex;
+
+public:
+  BlockScrubber();
+  // a scrubber over storage that is never scheduled; scrubNext() drives it
+  explicit BlockScrubber(Storage *storage);
+  void start() override;
+
+  void scrubNext();
+  BlockScrubStat getScrubStat();
+
+private:
+  bool scrubBlock(block_height_type height, size_t &num_bytes);
+  void restartPass();
+};
+
+} // namespace gruut
+
+#endif // GRUUT_ENTERPRISE_MERGER_BLOCK_SCRUBBER_HPP
@@ -35,6 +35,7 @@ public:
     ("dbpath", "Location where LevelDB stores data", cxxopts::value<string>()->default_value(config::DEFAULT_DB_PATH))
     ("dbclear", "To wipe out the existing LevelDB")
     ("dbcheck", "To perform DB health check before running")
+    ("dbcheckignore", "To keep running even if DB health check fails")
     ("disableTK", "Not to access to the tracker")
     ("txforward", "To forward MSG_TX to appropriate merger");
     // clang-format on
@@ -132,6 +133,11 @@ public:
         CLOG(INFO, "ARGV") << "DB HEALTH CHECKING IS ENABLED.";
       }
 
+      if (result.count("dbcheckignore")) {
+        setting->setDBCheckIgnore();
+        CLOG(INFO, "ARGV") << "DB HEALTH CHECK FAILURE WILL BE IGNORED.";
+      }
+
       if (result.count("disableTK")) {
         setting->setDisableTracker();
         CLOG(INFO, "ARGV") << "MERGER DOES NOT ACCESS TO TRACKER.";
@@ -10,16 +10,26 @@
 #include "../chain/mem_ledger.hpp"
 #include "../chain/types.hpp"
 #include "../utils/safe.hpp"
+#include "../utils/worker_pool.hpp"
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <list>
+#include <map>
 #include <memory>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
 namespace gruut {
 
+using tx_partition_t = std::map<TransactionType, tx_views_t>;
+
 class CustomLedgerManager {
 private:
   std::vector<std::shared_ptr<Ledger>> m_ledgers;
+  std::unique_ptr<WorkerPool> m_ledger_workers;
   std::shared_ptr<CertificateLedger> m_certificate_ledger;
   std::shared_ptr<DigestLedger> m_digest_ledger;
   std::shared_ptr<SmsLedger> m_sms_ledger;
@@ -32,9 +42,18 @@ public:
     m_digest_ledger = std::make_shared<DigestLedger>();
     m_sms_ledger = std::make_shared<SmsLedger>();
 
-    registerLedger(m_certificate_ledger);
-    registerLedger(m_digest_ledger);
-    registerLedger(m_sms_ledger);
+    // a ledger left out would silently skip its transactions in every block
+    for (auto &ledger : std::vector<std::shared_ptr<Ledger>>{
+             m_certificate_ledger, m_digest_ledger, m_sms_ledger}) {
+      if (!registerLedger(ledger))
+        throw std::logic_error("Ledger prefix [" + ledger->getPrefix() +
+                               "] cannot be registered");
+    }
+
+    size_t num_workers = std::min<size_t>(
+        m_ledgers.size(), std::max(1u, std::thread::hardware_concurrency()));
+    if (num_workers > 1)
+      m_ledger_workers.reset(new WorkerPool(num_workers - 1));
   }
 
   bool isValidTransaction(const Transaction &tx) {
@@ -49,19 +68,107 @@ public:
     return is_valid;
   }
 
-  void procLedgerBlock(const json &txs_json, const std::string &block_id_b64,
+  // Transactions are partitioned by type once, and every ledger with work in
+  // this block runs on its own worker. Ledgers never share a key prefix, so
+  // they cannot write the same keys.
+  void procLedgerBlock(const std::vector<Transaction> &txs,
+                       const std::string &block_id_b64,
                        const block_layer_t &block_layer) {
     // CLOG(INFO, "CLMA") << "called procLedgerBlock()";
+    tx_partition_t tx_partition = partitionTxs(txs);
+
+    std::vector<std::function<void()>> ledger_tasks;
+    std::list<tx_views_t> merged_views;
     for (auto &ledger : m_ledgers) {
-      ledger->procBlock(txs_json, block_id_b64, block_layer);
+      std::vector<TransactionType> tx_types = ledger->getTxTypes();
+      const tx_views_t *views_for_ledger = nullptr;
+
+      if (tx_types.size() == 1) {
+        auto it_map = tx_partition.find(tx_types[0]);
+        if (it_map != tx_partition.end())
+          views_for_ledger = &it_map->second;
+      } else {
+        tx_views_t merged;
+        for (auto &each_type : tx_types) {
+          auto it_map = tx_partition.find(each_type);
+          if (it_map == tx_partition.end())
+            continue;
+          merged.insert(merged.end(), it_map->second.begin(),
+                        it_map->second.end());
+        }
+        if (!merged.empty()) {
+          merged_views.emplace_back(std::move(merged));
+          views_for_ledger = &merged_views.back();
+        }
+      }
+
+      if (views_for_ledger == nullptr)
+        continue;
+
+      ledger_tasks.emplace_back(
+          [&ledger, views_for_ledger, &block_id_b64, &block_layer]() {
+            ledger->procBlock(*views_for_ledger, block_id_b64, block_layer);
+          });
+    }
+
+    if (m_ledger_workers == nullptr || ledger_tasks.size() < 2) {
+      for (auto &each_task : ledger_tasks)
+        each_task();
+      return;
+    }
+
+    m_ledger_workers->runAll(ledger_tasks);
+  }
+
+  // adapter for callers holding transactions in JSON
+  void procLedgerBlock(const json &txs_json, const std::string &block_id_b64,
+                       const block_layer_t &block_layer) {
+    procLedgerBlock(parseTxs(txs_json), block_id_b64, block_layer);
+  }
+
+  static tx_partition_t partitionTxs(const std::vector<Transaction> &txs) {
+    tx_partition_t tx_partition;
+    for (auto &each_tx : txs) {
+      tx_partition[each_tx.getTransactionType()].emplace_back(
+          each_tx.getView());
     }
+
+    return tx_partition;
+  }
+
+  static std::vector<Transaction> parseTxs(const json &txs_json) {
+    std::vector<Transaction> txs;
+    if (!txs_json.is_array())
+      return txs;
+
+    txs.reserve(txs_json.size());
+    for (auto &each_tx_json : txs_json) {
+      Transaction each_tx;
+      json tx_json = each_tx_json;
+      if (each_tx.setJson(tx_json))
+        txs.emplace_back(std::move(each_tx));
+    }
+
+    return txs;
   }
 
   CertificateLedger &getCertificateLedger() { return *m_certificate_ledger; }
 
 private:
-  void registerLedger(std::shared_ptr<Ledger> ledger) {
+  bool registerLedger(std::shared_ptr<Ledger> ledger) {
+    const std::string &new_prefix = ledger->getPrefix();
+    for (auto &each_ledger : m_ledgers) {
+      const std::string &prefix = each_ledger->getPrefix();
+      size_t cmp_len = std::min(prefix.size(), new_prefix.size());
+      if (prefix.compare(0, cmp_len, new_prefix, 0, cmp_len) == 0) {
+        CLOG(ERROR, "CLMA") << "Ledger prefix [" << new_prefix
+                            << "] overlaps with [" << prefix << "]";
+        return false;
+      }
+    }
+
     m_ledgers.emplace_back(ledger);
+    return true;
   }
 
   void initLedger() { m_ledgers.clear(); }
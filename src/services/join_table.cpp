@@ -0,0 +1,91 @@
+#include "join_table.hpp"
+#include "../utils/type_converter.hpp"
+
+namespace gruut {
+JoinTable::JoinTable(timestamp_t now)
+    : m_join_expiry_wheel(config::JOIN_TIMEOUT_SEC + 2),
+      m_last_expiry_check(now) {}
+
+void JoinTable::insert(const std::string &signer_id_b64,
+                       std::shared_ptr<JoinTemporaryData> join_data) {
+  size_t slot = (join_data->start_time + config::JOIN_TIMEOUT_SEC + 1) %
+                m_join_expiry_wheel.size();
+
+  std::lock_guard<std::mutex> lock(m_join_table_mutex);
+  m_join_temp_table[signer_id_b64] = std::move(join_data);
+  m_join_expiry_wheel[slot].emplace_back(signer_id_b64);
+}
+
+std::shared_ptr<JoinTemporaryData>
+JoinTable::find(const std::string &signer_id_b64) {
+  std::lock_guard<std::mutex> lock(m_join_table_mutex);
+  auto it_map = m_join_temp_table.find(signer_id_b64);
+  if (it_map == m_join_temp_table.end())
+    return nullptr;
+
+  return it_map->second;
+}
+
+void JoinTable::erase(const std::string &signer_id_b64,
+                      const std::shared_ptr<JoinTemporaryData> &join_data) {
+  std::lock_guard<std::mutex> lock(m_join_table_mutex);
+  auto it_map = m_join_temp_table.find(signer_id_b64);
+  if (it_map != m_join_temp_table.end() && it_map->second == join_data)
+    m_join_temp_table.erase(it_map);
+}
+
+void JoinTable::eraseUnlocked(const std::string &signer_id_b64) {
+  std::lock_guard<std::mutex> lock(m_join_table_mutex);
+  auto it_map = m_join_temp_table.find(signer_id_b64);
+  if (it_map != m_join_temp_table.end() && !it_map->second->join_lock)
+    m_join_temp_table.erase(it_map);
+}
+
+size_t JoinTable::expire(timestamp_t now, SignerPool &signer_pool) {
+  std::vector<signer_id_type> stale_signers;
+  {
+    std::lock_guard<std::mutex> lock(m_join_table_mutex);
+    size_t num_slots = m_join_expiry_wheel.size();
+    timestamp_t from_time = m_last_expiry_check + 1;
+    if (now >= num_slots && from_time < now - num_slots + 1)
+      from_time = now - num_slots + 1;
+
+    for (timestamp_t slot_time = from_time; slot_time <= now; ++slot_time) {
+      // a join not due yet stays in its slot for the next turn of the wheel
+      auto &slot = m_join_expiry_wheel[slot_time % num_slots];
+      std::vector<std::string> pending;
+      for (auto &signer_id_b64 : slot) {
+        auto it_map = m_join_temp_table.find(signer_id_b64);
+        if (it_map == m_join_temp_table.end())
+          continue;
+
+        if (!isTimeout(*it_map->second, now)) {
+          pending.emplace_back(std::move(signer_id_b64));
+          continue;
+        }
+
+        if (!it_map->second->join_lock)
+          stale_signers.emplace_back(
+              TypeConverter::decodeBase64(signer_id_b64));
+        m_join_temp_table.erase(it_map);
+      }
+      slot.swap(pending);
+    }
+    m_last_expiry_check = now;
+  }
+
+  size_t num_evicted = 0;
+  for (auto &signer_id : stale_signers) {
+    auto signer = signer_pool.getSigner(signer_id);
+    if (signer != nullptr && signer->status == SignerStatus::TEMPORARY &&
+        signer_pool.removeSigner(signer_id))
+      ++num_evicted;
+  }
+  return num_evicted;
+}
+
+bool JoinTable::isTimeout(const JoinTemporaryData &join_data,
+                          timestamp_t now) {
+  return (now - join_data.start_time > config::JOIN_TIMEOUT_SEC);
+}
+} // namespace gruut
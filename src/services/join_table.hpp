@@ -0,0 +1,57 @@
+#ifndef GRUUT_ENTERPRISE_MERGER_JOIN_TABLE_HPP
+#define GRUUT_ENTERPRISE_MERGER_JOIN_TABLE_HPP
+
+#include "../chain/types.hpp"
+#include "../config/config.hpp"
+#include "signer_pool.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gruut {
+struct JoinTemporaryData {
+  std::string merger_nonce;
+  std::string signer_cert;
+  std::vector<uint8_t> shared_secret_key;
+  timestamp_t start_time;
+  std::atomic<bool> join_lock;
+  std::atomic<bool> responding{false}; // MSG_RESPONSE_1 taken by a worker
+};
+
+// The joins in progress, by signer id in base64. Each join is also put in
+// the wheel slot of the second it times out, so expire() only looks at the
+// joins due since its last call.
+class JoinTable {
+public:
+  // now is the time the wheel starts from
+  explicit JoinTable(timestamp_t now);
+
+  void insert(const std::string &signer_id_b64,
+              std::shared_ptr<JoinTemporaryData> join_data);
+  std::shared_ptr<JoinTemporaryData> find(const std::string &signer_id_b64);
+  // only if the entry is still join_data and not a later join
+  void erase(const std::string &signer_id_b64,
+             const std::shared_ptr<JoinTemporaryData> &join_data);
+  // only if the key exchange of the entry is not running
+  void eraseUnlocked(const std::string &signer_id_b64);
+
+  // Drops the joins timed out by now. A signer that got its key but never
+  // sent MSG_SUCCESS is still TEMPORARY and is dropped from signer_pool as
+  // well; returns the number of such signers.
+  size_t expire(timestamp_t now, SignerPool &signer_pool);
+
+  static bool isTimeout(const JoinTemporaryData &join_data, timestamp_t now);
+
+private:
+  std::unordered_map<std::string, std::shared_ptr<JoinTemporaryData>>
+      m_join_temp_table;
+  std::vector<std::vector<std::string>> m_join_expiry_wheel;
+  timestamp_t m_last_expiry_check;
+  std::mutex m_join_table_mutex;
+};
+} // namespace gruut
+#endif
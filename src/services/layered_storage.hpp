@@ -6,13 +6,25 @@
 #include "easy_logging.hpp"
 #include "storage.hpp"
 
+#include <algorithm>
+#include <functional>
+#include <mutex>
+
 namespace gruut {
 
+// called with the wrap keys whose visible value may have changed,
+// or with is_all = true when any key may have changed
+using ledger_listener_t =
+    std::function<void(const std::vector<std::string> &keys, bool is_all)>;
+
 class LayeredStorage : public TemplateSingleton<LayeredStorage> {
 private:
   Storage *m_storage;
   mem_ledger_t m_mem_ledger;
   std::vector<std::string> m_block_layer;
+  std::mutex m_layer_mutex;
+  std::vector<ledger_listener_t> m_listeners;
+  std::mutex m_listener_mutex;
 
 public:
   LayeredStorage() {
@@ -37,9 +49,39 @@ public:
 
     return true;
   }
+
+  void addListener(ledger_listener_t listener) {
+    std::lock_guard<std::mutex> lock(m_listener_mutex);
+    m_listeners.emplace_back(std::move(listener));
+  }
+
   template <typename V = std::vector<std::string>>
   void setBlockLayer(V &&block_layer = {}) {
-    m_block_layer = block_layer;
+    block_layer_t new_layer = block_layer;
+    block_layer_t old_layer;
+    {
+      std::lock_guard<std::mutex> lock(m_layer_mutex);
+      old_layer = m_block_layer;
+      m_block_layer = new_layer;
+    }
+
+    // Growing at the head or shrinking at the tail (resolved blocks, already
+    // on disk) only exposes the records of the new head blocks.
+    size_t num_new_blocks = 0;
+    if (!isSameChain(old_layer, new_layer, num_new_blocks)) {
+      notifyListeners({}, true);
+      return;
+    }
+
+    std::vector<std::string> changed_keys;
+    for (size_t i = 0; i < num_new_blocks; ++i) {
+      auto kv_vector = m_mem_ledger.getKV(new_layer[i]);
+      for (auto &each_record : kv_vector)
+        changed_keys.emplace_back(each_record.key);
+    }
+
+    if (!changed_keys.empty())
+      notifyListeners(changed_keys, false);
   }
 
   template <typename T = std::string, typename V = block_layer_t>
@@ -47,7 +89,13 @@ public:
     std::string ret_val;
 
     if (block_layer.empty()) {
-      for (auto &each_block_id_b64 : m_block_layer) { // reverse_order
+      block_layer_t current_layer;
+      {
+        std::lock_guard<std::mutex> lock(m_layer_mutex);
+        current_layer = m_block_layer;
+      }
+
+      for (auto &each_block_id_b64 : current_layer) { // reverse_order
         if (m_mem_ledger.getVal(key, each_block_id_b64, ret_val)) {
           break;
         }
@@ -68,7 +116,10 @@ public:
 
   void flushLedger() { m_storage->flushLedger(); }
 
-  void clearLedger() { m_mem_ledger.clear(); }
+  void clearLedger() {
+    m_mem_ledger.clear();
+    notifyListeners({}, true);
+  }
 
   template <typename T = std::string> void moveToDiskLedger(T &&block_id_b64) {
 
@@ -79,11 +130,40 @@ public:
     }
 
     m_storage->flushLedger();
-    dropLedger(block_id_b64);
+
+    // the records are still visible, now from disk
+    m_mem_ledger.dropKV(block_id_b64);
   }
 
   template <typename T = std::string> void dropLedger(T &&block_id_b64) {
     m_mem_ledger.dropKV(block_id_b64);
+    notifyListeners({}, true);
+  }
+
+private:
+  // new_layer == (new head blocks) + (head part of old_layer)
+  bool isSameChain(const block_layer_t &old_layer,
+                   const block_layer_t &new_layer, size_t &num_new_blocks) {
+    num_new_blocks = new_layer.size();
+    if (old_layer.empty() || new_layer.empty())
+      return true;
+
+    auto it = std::find(new_layer.begin(), new_layer.end(), old_layer.front());
+    if (it == new_layer.end())
+      return false;
+
+    num_new_blocks = static_cast<size_t>(std::distance(new_layer.begin(), it));
+    size_t num_kept = new_layer.size() - num_new_blocks;
+    if (num_kept > old_layer.size())
+      return false;
+
+    return std::equal(it, new_layer.end(), old_layer.begin());
+  }
+
+  void notifyListeners(const std::vector<std::string> &keys, bool is_all) {
+    std::lock_guard<std::mutex> lock(m_listener_mutex);
+    for (auto &listener : m_listeners)
+      listener(keys, is_all);
   }
 };
 
@@ -40,6 +40,8 @@ void MessageProxy::deliverInputMessage(InputMsgEntry &input_message) {
   case MessageType::MSG_REQ_CHECK:
   case MessageType::MSG_BLOCK:
   case MessageType::MSG_REQ_BLOCK:
+  case MessageType::MSG_BLOCK_RANGE:
+  case MessageType::MSG_REQ_BLOCK_RANGE:
   case MessageType::MSG_REQ_STATUS:
   case MessageType::MSG_REQ_HEADER: {
     Application::app().getBlockProcessor().handleMessage(input_message);
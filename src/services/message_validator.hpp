@@ -99,7 +99,17 @@ const std::vector<std::tuple<MessageType, std::string, EntryType, EntryLength>>
 
     {MessageType::MSG_REQ_BLOCK, "mID", EntryType::BASE64, EntryLength::ID},
     {MessageType::MSG_REQ_BLOCK, "time", EntryType::TIMESTAMP_NOW, EntryLength::NOT_LIMITED},
-    {MessageType::MSG_REQ_BLOCK, "hgt", EntryType::UINT, EntryLength::NOT_LIMITED}
+    {MessageType::MSG_REQ_BLOCK, "hgt", EntryType::UINT, EntryLength::NOT_LIMITED},
+
+    {MessageType::MSG_REQ_BLOCK_RANGE, "mID", EntryType::BASE64, EntryLength::ID},
+    {MessageType::MSG_REQ_BLOCK_RANGE, "time", EntryType::TIMESTAMP_NOW, EntryLength::NOT_LIMITED},
+    {MessageType::MSG_REQ_BLOCK_RANGE, "from", EntryType::UINT, EntryLength::NOT_LIMITED},
+    {MessageType::MSG_REQ_BLOCK_RANGE, "to", EntryType::UINT, EntryLength::NOT_LIMITED},
+
+    {MessageType::MSG_BLOCK_RANGE, "mID", EntryType::BASE64, EntryLength::ID},
+    {MessageType::MSG_BLOCK_RANGE, "from", EntryType::UINT, EntryLength::NOT_LIMITED},
+    {MessageType::MSG_BLOCK_RANGE, "to", EntryType::UINT, EntryLength::NOT_LIMITED},
+    {MessageType::MSG_BLOCK_RANGE, "blocks", EntryType::ARRAYOFOBJECT, EntryLength::NOT_LIMITED}
 };
 // clang-format on
 
@@ -172,6 +172,7 @@ private:
   std::vector<ServiceEndpointInfo> m_service_endpoints;
   std::vector<MergerInfo> m_mergers;
   bool m_db_check{false};
+  bool m_db_check_ignore{false};
   bool m_disable_tracker{false};
   bool m_tx_forward{false};
 
@@ -199,6 +200,10 @@ public:
 
   bool getDBCheck() { return m_db_check; }
 
+  void setDBCheckIgnore() { m_db_check_ignore = true; }
+
+  bool getDBCheckIgnore() { return m_db_check_ignore; }
+
   void setTxForward() { m_tx_forward = true; }
 
   bool getTxForward() { return m_tx_forward; }
@@ -17,7 +17,7 @@ SignatureRequester::SignatureRequester() {
   el::Loggers::getLogger("SIGR");
 }
 
-bool SignatureRequester::isNewSigner(Signer &signer) {
+bool SignatureRequester::isNewSigner(const Signer &signer) {
 
   auto cert = m_cert_ledger.getCertificate(signer.user_id);
   return (cert.empty() || cert != signer.pk_cert);
@@ -43,9 +43,9 @@ void SignatureRequester::requestSignatures() {
     return;
   }
 
-  std::vector<Signer> new_signers;
+  std::vector<SignerHandle> new_signers;
   for (auto &signer : target_signers) {
-    if (isNewSigner(signer)) {
+    if (isNewSigner(*signer)) {
       new_signers.emplace_back(signer);
     }
   }
@@ -141,16 +141,18 @@ void SignatureRequester::doCreateBlock() {
   }));
 }
 
-void SignatureRequester::sendRequestMessage(std::vector<Signer> &signers) {
+void SignatureRequester::sendRequestMessage(
+    std::vector<SignerHandle> &signers) {
   if (signers.empty()) {
     CLOG(ERROR, "SIGR") << "No signer";
     return;
   }
 
   vector<id_type> receivers_list;
-  for_each(signers.begin(), signers.end(), [&receivers_list](Signer signer) {
-    receivers_list.emplace_back(signer.user_id);
-  });
+  for_each(signers.begin(), signers.end(),
+           [&receivers_list](const SignerHandle &signer) {
+             receivers_list.emplace_back(signer->user_id);
+           });
 
   OutputMsgEntry output_message;
   output_message.type = MessageType::MSG_REQ_SSIG;
@@ -168,8 +170,8 @@ void SignatureRequester::sendRequestMessage(std::vector<Signer> &signers) {
   proxy.deliverOutputMessage(output_message);
 }
 
-std::vector<Signer> SignatureRequester::selectSigners() {
-  std::vector<Signer> selected_signers;
+std::vector<SignerHandle> SignatureRequester::selectSigners() {
+  std::vector<SignerHandle> selected_signers;
 
   auto signer_pool = SignerPool::getInstance();
   size_t num_available_signers =
@@ -183,7 +185,7 @@ std::vector<Signer> SignatureRequester::selectSigners() {
 }
 
 Transaction
-SignatureRequester::genCertificateTransaction(vector<Signer> &signers) {
+SignatureRequester::genCertificateTransaction(vector<SignerHandle> &signers) {
   Transaction new_transaction;
 
   if (!signers.empty()) {
@@ -197,9 +199,9 @@ SignatureRequester::genCertificateTransaction(vector<Signer> &signers) {
 
     std::vector<content_type> content_list;
     for (auto &signer : signers) {
-      auto user_id_str = TypeConverter::encodeBase64(signer.user_id);
+      auto user_id_str = TypeConverter::encodeBase64(signer->user_id);
       content_list.emplace_back(user_id_str);
-      content_list.emplace_back(signer.pk_cert);
+      content_list.emplace_back(signer->pk_cert);
     }
 
     new_transaction.setContents(content_list);
@@ -37,11 +37,11 @@ public:
 
 private:
   void doCreateBlock();
-  void sendRequestMessage(std::vector<Signer> &signers);
-  std::vector<Signer> selectSigners();
-  bool isNewSigner(Signer &signer);
+  void sendRequestMessage(std::vector<SignerHandle> &signers);
+  std::vector<SignerHandle> selectSigners();
+  bool isNewSigner(const Signer &signer);
 
-  Transaction genCertificateTransaction(std::vector<Signer> &signers);
+  Transaction genCertificateTransaction(std::vector<SignerHandle> &signers);
 
   std::unique_ptr<boost::asio::io_service::strand> m_block_gen_strand;
   PeriodicTask m_collect_check_scheduler;
@@ -4,147 +4,190 @@
 using namespace gruut::config;
 
 namespace gruut {
+using ReadLock = boost::shared_lock<boost::shared_mutex>;
+using WriteLock = boost::unique_lock<boost::shared_mutex>;
+
+SignerPool::SignerPool() : m_rng(std::random_device()()) {
+  m_signer_pool.reserve(MAX_SIGNER_NUM);
+}
+
 void SignerPool::pushSigner(signer_id_type &user_id, std::string &pk_cert,
                             Botan::secure_vector<uint8_t> &hmac_key,
                             SignerStatus status) {
-  Signer new_signer;
-  new_signer.user_id = user_id;
-  new_signer.pk_cert = pk_cert;
-  new_signer.hmac_key = hmac_key;
-  new_signer.status = status;
-  new_signer.last_update = Time::now_int();
-
-  auto signer_iter = find(new_signer.user_id);
-  if (signer_iter == m_signer_pool.end()) {
-    std::lock_guard<std::mutex> guard(m_push_mutex);
-    m_signer_pool.push_back(new_signer);
-    m_push_mutex.unlock();
-  } else {
-    std::lock_guard<std::mutex> guard(m_update_mutex);
-    *signer_iter = new_signer;
-    m_update_mutex.unlock();
-  }
+  std::shared_ptr<Signer> new_signer = std::make_shared<Signer>();
+  new_signer->user_id = user_id;
+  new_signer->pk_cert = pk_cert;
+  new_signer->hmac_key = hmac_key;
+  new_signer->hmac_context = makeHmacContext(hmac_key);
+  new_signer->status = status;
+  new_signer->last_update = Time::now_int();
+
+  WriteLock lock(m_pool_mutex);
+  replaceSigner(toKey(user_id), std::move(new_signer));
 }
 
 bool SignerPool::updatePkCert(signer_id_type &user_id, std::string &pk_cert) {
-  auto signer_iter = find(user_id);
-
-  if (signer_iter == m_signer_pool.end()) {
+  WriteLock lock(m_pool_mutex);
+  auto signer = find(user_id);
+  if (signer == nullptr)
     return false;
-  } else {
-    std::lock_guard<std::mutex> guard(m_update_mutex);
-    (*signer_iter).pk_cert = pk_cert;
-    m_update_mutex.unlock();
 
-    return true;
-  }
+  std::shared_ptr<Signer> new_signer = std::make_shared<Signer>(*signer);
+  new_signer->pk_cert = pk_cert;
+  replaceSigner(toKey(user_id), std::move(new_signer));
+  return true;
 }
 
 bool SignerPool::updateHmacKey(signer_id_type &user_id,
                                hmac_key_type &hmac_key) {
-  auto signer_iter = find(user_id);
+  auto hmac_context = makeHmacContext(hmac_key);
 
-  if (signer_iter == m_signer_pool.end()) {
+  WriteLock lock(m_pool_mutex);
+  auto signer = find(user_id);
+  if (signer == nullptr)
     return false;
-  } else {
-    std::lock_guard<std::mutex> guard(m_update_mutex);
-    (*signer_iter).hmac_key = hmac_key;
-    (*signer_iter).last_update = Time::now_int();
-    m_update_mutex.unlock();
 
-    return true;
-  }
+  std::shared_ptr<Signer> new_signer = std::make_shared<Signer>(*signer);
+  new_signer->hmac_key = hmac_key;
+  new_signer->hmac_context = std::move(hmac_context);
+  new_signer->last_update = Time::now_int();
+  replaceSigner(toKey(user_id), std::move(new_signer));
+  return true;
 }
 
 bool SignerPool::updateStatus(signer_id_type &user_id, SignerStatus status) {
-  auto signer_iter = find(user_id);
-
-  if (signer_iter == m_signer_pool.end()) {
+  WriteLock lock(m_pool_mutex);
+  auto signer = find(user_id);
+  if (signer == nullptr)
     return false;
-  } else {
-    std::lock_guard<std::mutex> guard(m_update_mutex);
-    (*signer_iter).status = status;
-    (*signer_iter).last_update = Time::now_int();
-    m_update_mutex.unlock();
 
-    return true;
-  }
+  std::shared_ptr<Signer> new_signer = std::make_shared<Signer>(*signer);
+  new_signer->status = status;
+  new_signer->last_update = Time::now_int();
+  replaceSigner(toKey(user_id), std::move(new_signer));
+  return true;
 }
 
 bool SignerPool::removeSigner(signer_id_type &user_id) {
-  auto signer_iter = find(user_id);
+  auto key = toKey(user_id);
 
-  if (signer_iter == m_signer_pool.end()) {
+  WriteLock lock(m_pool_mutex);
+  auto it_map = m_signer_pool.find(key);
+  if (it_map == m_signer_pool.end())
     return false;
-  } else {
-    std::lock_guard<std::mutex> guard(m_push_mutex);
-    m_signer_pool.erase(signer_iter);
-    m_push_mutex.unlock();
 
-    return true;
-  }
+  m_status_index[static_cast<size_t>(it_map->second->status)].erase(key);
+  m_signer_pool.erase(it_map);
+  return true;
 }
 
 hmac_key_type SignerPool::getHmacKey(signer_id_type &user_id) {
-  auto signer_iter = find(user_id);
-  if (signer_iter == m_signer_pool.end())
+  ReadLock lock(m_pool_mutex);
+  auto signer = find(user_id);
+  if (signer == nullptr)
     return hmac_key_type();
 
-  return (*signer_iter).hmac_key;
+  return signer->hmac_key;
+}
+
+std::shared_ptr<const HmacContext>
+SignerPool::getHmacContext(signer_id_type &user_id) {
+  ReadLock lock(m_pool_mutex);
+  auto signer = find(user_id);
+  if (signer == nullptr)
+    return nullptr;
+
+  return signer->hmac_context;
 }
 
 std::string SignerPool::getPkCert(signer_id_type &user_id) {
-  auto signer_iter = find(user_id);
-  if (signer_iter == m_signer_pool.end())
+  ReadLock lock(m_pool_mutex);
+  auto signer = find(user_id);
+  if (signer == nullptr)
     return "";
 
-  return (*signer_iter).pk_cert;
+  return signer->pk_cert;
 }
 
 size_t SignerPool::getNumSignerBy(SignerStatus status) {
-  auto signers_num = std::count_if(
-      m_signer_pool.begin(), m_signer_pool.end(),
-      [&status](Signer &signer) { return signer.status == status; });
+  ReadLock lock(m_pool_mutex);
+  return m_status_index[static_cast<size_t>(status)].size();
+}
 
-  return signers_num;
+SignerHandle SignerPool::getSigner(signer_id_type &user_id) {
+  ReadLock lock(m_pool_mutex);
+  return find(user_id);
 }
 
 void SignerPool::clearPool() {
-  std::lock_guard<std::mutex> guard(m_push_mutex);
+  WriteLock lock(m_pool_mutex);
   m_signer_pool.clear();
-  m_push_mutex.unlock();
+  for (auto &status_index : m_status_index)
+    status_index.clear();
+}
+
+const size_t SignerPool::size() {
+  ReadLock lock(m_pool_mutex);
+  return m_signer_pool.size();
 }
 
-const size_t SignerPool::size() { return m_signer_pool.size(); }
+bool SignerPool::isFull() { return size() >= MAX_SIGNER_NUM; }
 
-std::vector<Signer> SignerPool::getRandomSigners(size_t number) {
-  std::vector<Signer> signers;
+// reservoir sampling over the GOOD index; only the handles of the chosen
+// signers are copied
+std::vector<SignerHandle> SignerPool::getRandomSigners(size_t number) {
+  std::vector<SignerHandle> signers;
   signers.reserve(number);
+  if (number == 0)
+    return signers;
+
+  ReadLock lock(m_pool_mutex);
+  std::lock_guard<std::mutex> rng_lock(m_rng_mutex);
+
+  auto &good_index = m_status_index[static_cast<size_t>(SignerStatus::GOOD)];
+  size_t num_seen = 0;
+  for (auto &key : good_index) {
+    if (signers.size() < number) {
+      signers.emplace_back(m_signer_pool.find(key)->second);
+    } else {
+      std::uniform_int_distribution<size_t> pick(0, num_seen);
+      size_t slot = pick(m_rng);
+      if (slot < number)
+        signers[slot] = m_signer_pool.find(key)->second;
+    }
+    ++num_seen;
+  }
 
-  std::for_each(m_signer_pool.begin(), m_signer_pool.end(),
-                [&signers](Signer &signer) {
-                  if (signer.status == SignerStatus::GOOD)
-                    signers.emplace_back(signer);
-                });
+  return signers;
+}
+
+SignerPool::signer_key_type SignerPool::toKey(const signer_id_type &user_id) {
+  return signer_key_type(user_id.begin(), user_id.end());
+}
 
-  std::shuffle(signers.begin(), signers.end(),
-               std::mt19937(std::random_device()()));
+SignerHandle SignerPool::find(signer_id_type &user_id) {
+  auto it_map = m_signer_pool.find(toKey(user_id));
+  if (it_map == m_signer_pool.end())
+    return nullptr;
 
-  return std::vector<Signer>(signers.begin(), signers.begin() + number);
+  return it_map->second;
 }
 
-std::list<Signer>::iterator SignerPool::find(signer_id_type &user_id) {
-  auto it = std::find_if(
-      m_signer_pool.begin(), m_signer_pool.end(),
-      [this, &user_id](Signer &signer) { return signer.user_id == user_id; });
+// the caller holds the write lock
+void SignerPool::replaceSigner(const signer_key_type &key,
+                               SignerHandle new_signer) {
+  auto &slot = m_signer_pool[key];
+  if (slot != nullptr)
+    m_status_index[static_cast<size_t>(slot->status)].erase(key);
 
-  return it;
+  m_status_index[static_cast<size_t>(new_signer->status)].insert(key);
+  slot = std::move(new_signer);
 }
 
-Signer SignerPool::getSigner(int index) {
-  auto it = m_signer_pool.begin();
-  std::advance(it, index);
-  return *it;
+std::shared_ptr<const HmacContext>
+SignerPool::makeHmacContext(hmac_key_type &hmac_key) {
+  std::vector<uint8_t> key(hmac_key.begin(), hmac_key.end());
+  return std::make_shared<const HmacContext>(key);
 }
 
-} // namespace gruut
\ No newline at end of file
+} // namespace gruut
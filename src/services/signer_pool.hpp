@@ -6,16 +6,27 @@
 #include "../utils/template_singleton.hpp"
 #include "../utils/time.hpp"
 
-#include <algorithm>
-#include <list>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <array>
+#include <memory>
 #include <mutex>
 #include <random>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace gruut {
+
+// Signers are kept by id in a hash map, and the ids are also indexed by
+// status, so lookups and counts do not depend on the number of signers.
+// A stored Signer is never modified; an update swaps in a new copy, so a
+// SignerHandle handed out stays valid and consistent without the lock.
 class SignerPool : public TemplateSingleton<SignerPool> {
 public:
+  SignerPool();
+
   void pushSigner(signer_id_type &user_id, std::string &pk_cert,
                   Botan::secure_vector<uint8_t> &hmac_key,
                   SignerStatus stat = SignerStatus::UNKNOWN);
@@ -31,11 +42,13 @@ public:
 
   hmac_key_type getHmacKey(signer_id_type &user_id);
 
+  std::shared_ptr<const HmacContext> getHmacContext(signer_id_type &user_id);
+
   std::string getPkCert(signer_id_type &user_id);
 
   size_t getNumSignerBy(SignerStatus status = SignerStatus::GOOD);
 
-  Signer getSigner(int index);
+  SignerHandle getSigner(signer_id_type &user_id);
 
   void clearPool();
 
@@ -43,14 +56,24 @@ public:
 
   bool isFull();
 
-  std::vector<Signer> getRandomSigners(size_t number);
+  std::vector<SignerHandle> getRandomSigners(size_t number);
 
 private:
-  std::list<Signer>::iterator find(signer_id_type &user_id);
+  using signer_key_type = std::string;
+  using status_index_type = std::unordered_set<signer_key_type>;
+
+  static signer_key_type toKey(const signer_id_type &user_id);
+  SignerHandle find(signer_id_type &user_id);
+  void replaceSigner(const signer_key_type &key, SignerHandle new_signer);
+  std::shared_ptr<const HmacContext> makeHmacContext(hmac_key_type &hmac_key);
+
+  std::unordered_map<signer_key_type, SignerHandle> m_signer_pool;
+  // one id set per SignerStatus value
+  std::array<status_index_type, NUM_SIGNER_STATUS> m_status_index;
+  boost::shared_mutex m_pool_mutex;
 
-  std::list<Signer> m_signer_pool;
-  std::mutex m_push_mutex;
-  std::mutex m_update_mutex;
+  std::mt19937 m_rng;
+  std::mutex m_rng_mutex;
 };
 
 } // namespace gruut
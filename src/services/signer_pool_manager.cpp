@@ -3,13 +3,24 @@
 #include "easy_logging.hpp"
 
 namespace gruut {
-SignerPoolManager::SignerPoolManager() {
+SignerPoolManager::SignerPoolManager()
+    : m_join_table(static_cast<timestamp_t>(Time::now_int())),
+      m_join_workers(config::NUM_JOIN_WORKERS) {
   auto setting = Setting::getInstance();
   m_my_cert = setting->getMyCert();
   m_my_id = setting->getMyId();
   m_signer_pool = SignerPool::getInstance();
   el::Loggers::getLogger("SMGR");
+
+  m_join_expiry_scheduler.setIoService(Application::app().getIoService());
+  m_join_expiry_scheduler.setInterval(config::JOIN_EXPIRY_CHECK_INTERVAL);
+  m_join_expiry_scheduler.setTaskFunction([this]() {
+    m_join_table.expire(static_cast<timestamp_t>(Time::now_int()),
+                        *m_signer_pool);
+  });
+  m_join_expiry_scheduler.runTask();
 }
+
 void SignerPoolManager::handleMessage(InputMsgEntry &input_message) {
 
   string recv_id_b64 = Safe::getString(input_message.body, "sID");
@@ -25,98 +36,43 @@ void SignerPoolManager::handleMessage(InputMsgEntry &input_message) {
 
     auto current_time = Time::now_int();
 
-    m_join_temp_table[recv_id_b64].reset(new JoinTemporaryData());
-    m_join_temp_table[recv_id_b64]->join_lock = true;
-    m_join_temp_table[recv_id_b64]->start_time =
-        static_cast<timestamp_t>(current_time);
-    m_join_temp_table[recv_id_b64]->merger_nonce =
-        PRNG::toString(PRNG::randomize(32));
+    shared_ptr<JoinTemporaryData> join_data =
+        make_shared<JoinTemporaryData>();
+    join_data->join_lock = true;
+    join_data->start_time = static_cast<timestamp_t>(current_time);
+    join_data->merger_nonce = PRNG::toString(PRNG::randomize(32));
+
+    m_join_table.insert(recv_id_b64, join_data);
 
     OutputMsgEntry output_message;
     output_message.type = MessageType::MSG_CHALLENGE;
     output_message.body["mID"] = TypeConverter::encodeBase64(m_my_id);
     output_message.body["time"] = to_string(current_time);
-    output_message.body["mN"] = m_join_temp_table[recv_id_b64]->merger_nonce;
+    output_message.body["mN"] = join_data->merger_nonce;
     output_message.receivers = {recv_id};
 
     m_proxy.deliverOutputMessage(output_message);
 
   } break;
   case MessageType::MSG_RESPONSE_1: {
-    if (m_join_temp_table.find(recv_id_b64) == m_join_temp_table.end()) {
-      CLOG(ERROR, "SMGR") << "Illegal Trial";
-      sendErrorMessage(recv_id, ErrorMsgType::ECDH_ILLEGAL_ACCESS);
-      return;
-    }
-
-    if (isTimeout(recv_id_b64)) {
-      CLOG(ERROR, "SMGR") << "Join timeout (" << recv_id_b64 << ")";
-      sendErrorMessage(recv_id, ErrorMsgType::ECDH_TIMEOUT,
-                       "too late MSG_RESPONSE_1");
-      return;
-    }
-
-    if (!verifySignature(recv_id, input_message.body)) {
-      CLOG(ERROR, "SMGR") << "Invalid Signature";
-      sendErrorMessage(recv_id, ErrorMsgType::ECDH_INVALID_SIG);
-      return;
-    }
-
-    m_join_temp_table[recv_id_b64]->signer_cert =
-        Safe::getString(input_message.body, "cert");
-
-    json message_body;
-
-    HmacKeyMaker key_maker;
-    key_maker.genRandomSecretKey();
-    auto public_key = key_maker.getPublicKey();
-
-    string dhx = public_key.first;
-    string dhy = public_key.second;
-
-    auto signer_dhx = Safe::getString(input_message.body, "dhx");
-    auto signer_dhy = Safe::getString(input_message.body, "dhy");
-
-    auto shared_sk_bytes =
-        key_maker.getSharedSecretKey(signer_dhx, signer_dhy, 32);
-
-    if (shared_sk_bytes.empty()) {
-      CLOG(ERROR, "SMGR") << "Failed to generate SSK (invalid PK)";
-      sendErrorMessage(recv_id, ErrorMsgType::ECDH_INVALID_PK, "");
-      return;
-    }
-
-    m_join_temp_table[recv_id_b64]->shared_secret_key =
-        vector<uint8_t>(shared_sk_bytes.begin(), shared_sk_bytes.end());
-
-    timestamp_t current_time = static_cast<timestamp_t>(Time::now_int());
-
-    OutputMsgEntry output_message;
-    output_message.type = MessageType::MSG_RESPONSE_2;
-    output_message.body["mID"] = TypeConverter::encodeBase64(m_my_id);
-    output_message.body["time"] = to_string(current_time);
-    output_message.body["cert"] = m_my_cert;
-    output_message.body["dhx"] = dhx;
-    output_message.body["dhy"] = dhy;
-    output_message.body["sig"] = signMessage(
-        m_join_temp_table[recv_id_b64]->merger_nonce,
-        Safe::getString(input_message.body, "sN"), dhx, dhy, current_time);
-    output_message.receivers = {recv_id};
-
-    m_proxy.deliverOutputMessage(output_message);
-
-    auto secret_key_vector = TypeConverter::toSecureVector(
-        m_join_temp_table[recv_id_b64]->shared_secret_key);
-    m_signer_pool->pushSigner(recv_id,
-                              m_join_temp_table[recv_id_b64]->signer_cert,
-                              secret_key_vector, SignerStatus::TEMPORARY);
-    m_join_temp_table[recv_id_b64]->join_lock = false;
+    // the key exchange is the expensive part of a join, so it runs on the
+    // join workers and a reconnecting crowd of signers is served in parallel
+    json message_body = input_message.body;
+    m_join_workers.post([this, recv_id, recv_id_b64, message_body]() mutable {
+      try {
+        handleResponse(recv_id, recv_id_b64, message_body);
+      } catch (std::exception &e) {
+        CLOG(ERROR, "SMGR") << "Join failed (" << recv_id_b64
+                            << ") : " << e.what();
+      }
+    });
   } break;
   case MessageType::MSG_SUCCESS: {
     // OK! This signer has passed HMAC on MesssageHandler.
     // If the merger is ok, it does not need check m_join_temp_table.
 
-    if (isTimeout(recv_id_b64)) {
+    auto join_data = m_join_table.find(recv_id_b64);
+    if (join_data == nullptr || isTimeout(*join_data)) {
       CLOG(ERROR, "SMGR") << "Join timeout (" << recv_id_b64 << ")";
       sendErrorMessage(recv_id, ErrorMsgType::ECDH_TIMEOUT,
                        "too late MSG_SUCCESS");
@@ -124,7 +80,7 @@ void SignerPoolManager::handleMessage(InputMsgEntry &input_message) {
     }
 
     m_signer_pool->updateStatus(recv_id, SignerStatus::GOOD);
-    m_join_temp_table.erase(recv_id_b64);
+    m_join_table.erase(recv_id_b64, join_data);
 
     OutputMsgEntry output_message;
     output_message.type = MessageType::MSG_ACCEPT;
@@ -139,10 +95,7 @@ void SignerPoolManager::handleMessage(InputMsgEntry &input_message) {
 
   } break;
   case MessageType::MSG_LEAVE: {
-    if (m_join_temp_table.find(recv_id_b64) != m_join_temp_table.end()) {
-      if (!m_join_temp_table[recv_id_b64]->join_lock)
-        m_join_temp_table.erase(recv_id_b64);
-    }
+    m_join_table.eraseUnlocked(recv_id_b64);
     if (m_signer_pool->removeSigner(recv_id)) {
       std::string leave_time = Safe::getString(input_message.body, "time");
       std::string leave_msg = Safe::getString(input_message.body, "msg");
@@ -155,17 +108,97 @@ void SignerPoolManager::handleMessage(InputMsgEntry &input_message) {
   }
 }
 
-bool SignerPoolManager::verifySignature(signer_id_type &signer_id,
+// runs on a join worker; only the table lookups take the table lock
+void SignerPoolManager::handleResponse(signer_id_type &recv_id,
+                                       string &recv_id_b64,
+                                       json &message_body) {
+  auto join_data = m_join_table.find(recv_id_b64);
+  if (join_data == nullptr || join_data->responding.exchange(true)) {
+    CLOG(ERROR, "SMGR") << "Illegal Trial";
+    sendErrorMessage(recv_id, ErrorMsgType::ECDH_ILLEGAL_ACCESS);
+    return;
+  }
+
+  if (isTimeout(*join_data)) {
+    CLOG(ERROR, "SMGR") << "Join timeout (" << recv_id_b64 << ")";
+    sendErrorMessage(recv_id, ErrorMsgType::ECDH_TIMEOUT,
+                     "too late MSG_RESPONSE_1");
+    return;
+  }
+
+  if (!verifySignature(*join_data, message_body)) {
+    CLOG(ERROR, "SMGR") << "Invalid Signature";
+    sendErrorMessage(recv_id, ErrorMsgType::ECDH_INVALID_SIG);
+    return;
+  }
+
+  join_data->signer_cert = Safe::getString(message_body, "cert");
+
+  HmacKeyMaker key_maker;
+  key_maker.genRandomSecretKey();
+  auto public_key = key_maker.getPublicKey();
+
+  string dhx = public_key.first;
+  string dhy = public_key.second;
+
+  auto signer_dhx = Safe::getString(message_body, "dhx");
+  auto signer_dhy = Safe::getString(message_body, "dhy");
+
+  auto shared_sk_bytes =
+      key_maker.getSharedSecretKey(signer_dhx, signer_dhy, 32);
+
+  if (shared_sk_bytes.empty()) {
+    CLOG(ERROR, "SMGR") << "Failed to generate SSK (invalid PK)";
+    sendErrorMessage(recv_id, ErrorMsgType::ECDH_INVALID_PK, "");
+    return;
+  }
+
+  join_data->shared_secret_key =
+      vector<uint8_t>(shared_sk_bytes.begin(), shared_sk_bytes.end());
+
+  timestamp_t current_time = static_cast<timestamp_t>(Time::now_int());
+
+  OutputMsgEntry output_message;
+  output_message.type = MessageType::MSG_RESPONSE_2;
+  output_message.body["mID"] = TypeConverter::encodeBase64(m_my_id);
+  output_message.body["time"] = to_string(current_time);
+  output_message.body["cert"] = m_my_cert;
+  output_message.body["dhx"] = dhx;
+  output_message.body["dhy"] = dhy;
+  output_message.body["sig"] =
+      signMessage(join_data->merger_nonce, Safe::getString(message_body, "sN"),
+                  dhx, dhy, current_time);
+  output_message.receivers = {recv_id};
+
+  // the key is in the pool before the signer can answer with an HMAC
+  auto secret_key_vector =
+      TypeConverter::toSecureVector(join_data->shared_secret_key);
+  m_signer_pool->pushSigner(recv_id, join_data->signer_cert, secret_key_vector,
+                            SignerStatus::TEMPORARY);
+  join_data->join_lock = false;
+
+  // the join may have expired while the key exchange ran; expire() then
+  // dropped it without the signer, which nothing else would ever remove
+  if (m_join_table.find(recv_id_b64) != join_data) {
+    m_signer_pool->removeSigner(recv_id);
+    CLOG(ERROR, "SMGR") << "Join timeout (" << recv_id_b64 << ")";
+    sendErrorMessage(recv_id, ErrorMsgType::ECDH_TIMEOUT,
+                     "too late MSG_RESPONSE_1");
+    return;
+  }
+
+  m_proxy.deliverOutputMessage(output_message);
+}
+
+bool SignerPoolManager::verifySignature(JoinTemporaryData &join_data,
                                         json &message_body_json) {
 
   bytes sig_bytes = Safe::getBytesFromB64(message_body_json, "sig");
 
   string cert_in = Safe::getString(message_body_json, "cert");
 
-  string signer_id_b64 = TypeConverter::encodeBase64(signer_id);
-
   BytesBuilder msg_builder;
-  msg_builder.appendB64(m_join_temp_table[signer_id_b64]->merger_nonce);
+  msg_builder.appendB64(join_data.merger_nonce);
   msg_builder.appendB64(Safe::getString(message_body_json, "sN"));
   msg_builder.appendHex(Safe::getString(message_body_json, "dhx"));
   msg_builder.appendHex(Safe::getString(message_body_json, "dhy"));
@@ -197,11 +230,9 @@ bool SignerPoolManager::isJoinable() {
   return (config::MAX_SIGNER_NUM > m_signer_pool->size());
 }
 
-bool SignerPoolManager::isTimeout(std::string &signer_id_b64) {
-  // Dont't call this function unless checking m_join_temp_table
-  return (static_cast<timestamp_t>(Time::now_int()) -
-              m_join_temp_table[signer_id_b64]->start_time >
-          config::JOIN_TIMEOUT_SEC);
+bool SignerPoolManager::isTimeout(JoinTemporaryData &join_data) {
+  return JoinTable::isTimeout(join_data,
+                              static_cast<timestamp_t>(Time::now_int()));
 }
 
 void SignerPoolManager::sendErrorMessage(signer_id_type &recv_id,
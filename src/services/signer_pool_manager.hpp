@@ -9,11 +9,14 @@
 #include "../utils/bytes_builder.hpp"
 #include "../utils/ecdsa.hpp"
 #include "../utils/hmac_key_maker.hpp"
+#include "../utils/periodic_task.hpp"
 #include "../utils/random_number_generator.hpp"
 #include "../utils/sha256.hpp"
 #include "../utils/time.hpp"
 #include "../utils/type_converter.hpp"
+#include "../utils/worker_pool.hpp"
 
+#include "join_table.hpp"
 #include "message_proxy.hpp"
 #include "signer_pool.hpp"
 
@@ -26,41 +29,41 @@
 #include <chrono>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
 using namespace std;
 
 namespace gruut {
-struct JoinTemporaryData {
-  string merger_nonce;
-  string signer_cert;
-  vector<uint8_t> shared_secret_key;
-  timestamp_t start_time;
-  atomic<bool> join_lock;
-};
-
 class SignerPoolManager {
 public:
   SignerPoolManager();
   void handleMessage(InputMsgEntry &input_message);
 
 private:
-  bool verifySignature(signer_id_type &signer_id, json &message_body_json);
+  void handleResponse(signer_id_type &recv_id, string &recv_id_b64,
+                      json &message_body);
+  bool verifySignature(JoinTemporaryData &join_data, json &message_body_json);
   string signMessage(string, string, string, string, uint64_t);
   void sendErrorMessage(signer_id_type &recv_id, ErrorMsgType error_type,
                         const std::string &info = "");
   bool isJoinable();
 
-  bool isTimeout(std::string &signer_id_b64);
+  bool isTimeout(JoinTemporaryData &join_data);
 
   // A temporary table for connection establishment.
-  unordered_map<string, unique_ptr<JoinTemporaryData>> m_join_temp_table;
+  JoinTable m_join_table;
+  PeriodicTask m_join_expiry_scheduler;
 
   SignerPool *m_signer_pool;
   string m_my_cert;
   merger_id_type m_my_id;
   MessageProxy m_proxy;
+
+  // ECDH and ECDSA work of a join; declared last so that in-flight
+  // handshakes finish before the members above go away
+  WorkerPool m_join_workers;
 };
 } // namespace gruut
 #endif
@@ -5,11 +5,12 @@ namespace gruut {
 
 using namespace std;
 
-Storage::Storage() {
+Storage::Storage() : Storage(Setting::getInstance()->getMyDbPath()) {}
+
+Storage::Storage(const std::string &db_path) {
   el::Loggers::getLogger("STRG");
 
-  auto setting = Setting::getInstance();
-  m_db_path = setting->getMyDbPath();
+  m_db_path = db_path;
 
   m_options.block_cache = leveldb::NewLRUCache(100 * 1048576); // 100MB cache
   m_options.create_if_missing = true;
@@ -29,6 +30,9 @@ Storage::Storage() {
 }
 
 Storage::~Storage() {
+  if (m_snapshot_thread.joinable())
+    m_snapshot_thread.join();
+
   delete m_db_block_header;
   delete m_db_block_raw;
   delete m_db_latest_block_header;
@@ -46,7 +50,7 @@ Storage::~Storage() {
   m_db_backup = nullptr;
 }
 
-bool Storage::saveBlock(bytes &block_raw, json &block_header,
+bool Storage::saveBlock(const bytes &block_raw, json &block_header,
                         json &block_transaction) {
   string block_id_b64 = Safe::getString(block_header, "bID");
 
@@ -178,7 +182,8 @@ bool Storage::putBlockHeight(json &block_header_json,
   return addBatch(DBType::BLOCK_HEIGHT, key, block_id_b64);
 }
 
-bool Storage::putBlockRaw(bytes &block_raw, const string &block_id_b64) {
+bool Storage::putBlockRaw(const bytes &block_raw,
+                          const string &block_id_b64) {
 
   std::string key, value;
 
@@ -400,6 +405,8 @@ void Storage::destroyDB() {
   boost::filesystem::remove_all(m_db_path + "/" + config::DB_SUB_DIR_IDHEIGHT);
   boost::filesystem::remove_all(m_db_path + "/" + config::DB_SUB_DIR_LEDGER);
   boost::filesystem::remove_all(m_db_path + "/" + config::DB_SUB_DIR_BACKUP);
+  boost::filesystem::remove_all(m_db_path + "/" + config::DB_SUB_DIR_LEDGER_SNAPSHOT);
+  boost::filesystem::remove_all(m_db_path + "/" + config::DB_SUB_DIR_LEDGER_SNAPSHOT + ".old");
   // clang-format on
 }
 
@@ -426,21 +433,8 @@ storage_block_type Storage::readBlock(block_height_type height) {
     result.block_raw = TypeConverter::stringToBytes(
         getValueByKey(DBType::BLOCK_RAW, block_id_b64));
 
-    json txs_json = json::array();
-    std::string txids_json_str =
-        getValueByKey(DBType::BLOCK_HEADER, block_id_b64 + "_txids");
-    if (!txids_json_str.empty()) {
-      try {
-        json txids_json = Safe::parseJsonAsArray(txids_json_str);
-        for (auto &each_txid : txids_json) {
-          std::string tx_cbor_str = getValueByKey(
-              DBType::TRANSACTION, Safe::getString(each_txid) + "_c");
-          txs_json.push_back(json::from_cbor(tx_cbor_str));
-        }
-      } catch (json::exception &e) {
-        CLOG(FATAL, "STRG") << "FATAL ERROR on LevelDB " << e.what();
-      }
-    }
+    size_t num_tx_bytes = 0;
+    json txs_json = readBlockTxs(block_id_b64, num_tx_bytes);
 
     nth_link_type link_info = getNthBlockLinkInfo(height);
     result.height = height;
@@ -455,6 +449,72 @@ storage_block_type Storage::readBlock(block_height_type height) {
   return result;
 }
 
+// Blocks of [from_height, to_height] in height order, stopping at the first
+// missing height or once max_bytes of raw blocks and transactions have been
+// read (the first block is always returned). Only the raw block and its
+// transactions are filled, which is all a receiver needs to rebuild it;
+// without with_txs, only the raw block (= signed header).
+std::vector<storage_block_type>
+Storage::readBlockRange(block_height_type from_height,
+                        block_height_type to_height, size_t max_bytes,
+                        bool with_txs) {
+  std::vector<storage_block_type> result;
+  size_t num_read_bytes = 0;
+
+  for (block_height_type height = from_height;
+       height > 0 && height <= to_height; ++height) {
+    std::string block_id_b64 = getNthBlockIdB64(height);
+    if (block_id_b64.empty())
+      break;
+
+    storage_block_type each_block;
+    each_block.height = height;
+    each_block.id = TypeConverter::decodeBase64(block_id_b64);
+    each_block.block_raw = TypeConverter::stringToBytes(
+        getValueByKey(DBType::BLOCK_RAW, block_id_b64));
+    if (each_block.block_raw.empty())
+      break;
+
+    size_t num_tx_bytes = 0;
+    each_block.txs = with_txs ? readBlockTxs(block_id_b64, num_tx_bytes)
+                              : json::array();
+
+    size_t num_block_bytes = each_block.block_raw.size() + num_tx_bytes;
+    if (!result.empty() && num_read_bytes + num_block_bytes > max_bytes)
+      break;
+
+    num_read_bytes += num_block_bytes;
+    result.emplace_back(std::move(each_block));
+  }
+
+  return result;
+}
+
+json Storage::readBlockTxs(const std::string &block_id_b64,
+                           size_t &num_bytes) {
+  json txs_json = json::array();
+  num_bytes = 0;
+
+  std::string txids_json_str =
+      getValueByKey(DBType::BLOCK_HEADER, block_id_b64 + "_txids");
+  if (txids_json_str.empty())
+    return txs_json;
+
+  try {
+    json txids_json = Safe::parseJsonAsArray(txids_json_str);
+    for (auto &each_txid : txids_json) {
+      std::string tx_cbor_str = getValueByKey(
+          DBType::TRANSACTION, Safe::getString(each_txid) + "_c");
+      num_bytes += tx_cbor_str.size();
+      txs_json.push_back(json::from_cbor(tx_cbor_str));
+    }
+  } catch (json::exception &e) {
+    CLOG(FATAL, "STRG") << "FATAL ERROR on LevelDB " << e.what();
+  }
+
+  return txs_json;
+}
+
 bool Storage::empty() {
   return getValueByKey(DBType::BLOCK_LATEST, "bID").empty();
 }
@@ -552,6 +612,273 @@ void Storage::flushLedger() {
   clearLedger();
 }
 
+// staged in the ledger batch, so it is committed together with the records
+// of that block by the next flushLedger()
+void Storage::saveLedgerTip(block_height_type height,
+                            const std::string &block_id_b64) {
+  json tip_json = {{"hgt", to_string(height)}, {"bID", block_id_b64}};
+  addBatch(DBType::LEDGER, LEDGER_TIP_KEY, tip_json.dump());
+}
+
+bool Storage::getLedgerTip(ledger_tip_type &ledger_tip) {
+  return readLedgerTip(m_db_ledger, m_read_options, ledger_tip);
+}
+
+// the tip goes last, so an interrupted erase still shows a tip that does not
+// match the saved blocks and is simply done again on the next start
+bool Storage::eraseLedger() {
+  clearLedger();
+
+  std::string tip_key = getPrefix(DBType::LEDGER) + LEDGER_TIP_KEY;
+
+  leveldb::WriteBatch batch;
+  leveldb::WriteOptions write_options; // synced once by the last write
+  bool is_ok = true;
+  size_t num_records = 0;
+
+  std::unique_ptr<leveldb::Iterator> it(
+      m_db_ledger->NewIterator(m_read_options));
+  for (it->SeekToFirst(); it->Valid() && is_ok; it->Next()) {
+    if (it->key() == tip_key)
+      continue;
+    batch.Delete(it->key());
+    if (++num_records % 4096 == 0) {
+      is_ok = errorOn(m_db_ledger->Write(write_options, &batch));
+      batch.Clear();
+    }
+  }
+
+  batch.Delete(tip_key);
+  is_ok = is_ok && errorOn(it->status()) &&
+          errorOn(m_db_ledger->Write(m_write_options, &batch));
+
+  return is_ok;
+}
+
+bool Storage::isLedgerEmpty() {
+  std::unique_ptr<leveldb::Iterator> it(
+      m_db_ledger->NewIterator(m_read_options));
+  it->SeekToFirst();
+  return !it->Valid();
+}
+
+void Storage::saveLedgerSnapshotAsync() {
+  if (m_snapshot_running.exchange(true))
+    return;
+
+  if (m_snapshot_thread.joinable())
+    m_snapshot_thread.join();
+
+  m_snapshot_thread = std::thread([this]() {
+    saveLedgerSnapshot();
+    m_snapshot_running = false;
+  });
+}
+
+// copies a point-in-time view of the ledger DB, so block saves go on
+// while the snapshot is being written
+bool Storage::saveLedgerSnapshot() {
+  std::lock_guard<std::mutex> guard(m_snapshot_mutex);
+
+  auto start_time = std::chrono::steady_clock::now();
+
+  std::string snapshot_path =
+      m_db_path + "/" + config::DB_SUB_DIR_LEDGER_SNAPSHOT;
+  std::string tmp_path = snapshot_path + ".tmp";
+  std::string old_path = snapshot_path + ".old";
+
+  leveldb::ReadOptions read_options;
+  read_options.fill_cache = false;
+  read_options.snapshot = m_db_ledger->GetSnapshot();
+
+  ledger_tip_type ledger_tip;
+  if (!readLedgerTip(m_db_ledger, read_options, ledger_tip)) {
+    m_db_ledger->ReleaseSnapshot(read_options.snapshot);
+    return false;
+  }
+
+  boost::filesystem::remove_all(tmp_path);
+
+  leveldb::DB *db_snapshot = nullptr;
+  if (!errorOn(leveldb::DB::Open(m_options, tmp_path, &db_snapshot))) {
+    m_db_ledger->ReleaseSnapshot(read_options.snapshot);
+    return false;
+  }
+
+  size_t num_records = 0;
+  bool is_ok = true;
+  leveldb::WriteBatch batch;
+  leveldb::WriteOptions write_options; // synced once by the last write
+
+  std::unique_ptr<leveldb::Iterator> it(
+      m_db_ledger->NewIterator(read_options));
+  for (it->SeekToFirst(); it->Valid() && is_ok; it->Next()) {
+    batch.Put(it->key(), it->value());
+    if (++num_records % 4096 == 0) {
+      is_ok = errorOn(db_snapshot->Write(write_options, &batch));
+      batch.Clear();
+    }
+  }
+
+  is_ok = is_ok && errorOn(it->status()) &&
+          errorOn(db_snapshot->Write(m_write_options, &batch));
+
+  it.reset();
+  m_db_ledger->ReleaseSnapshot(read_options.snapshot);
+  delete db_snapshot;
+
+  if (!is_ok) {
+    boost::filesystem::remove_all(tmp_path);
+    return false;
+  }
+
+  // the former snapshot is kept as .old until the new one is in place
+  boost::system::error_code ec;
+  boost::filesystem::remove_all(old_path, ec);
+  if (boost::filesystem::exists(snapshot_path))
+    boost::filesystem::rename(snapshot_path, old_path, ec);
+  if (!ec)
+    boost::filesystem::rename(tmp_path, snapshot_path, ec);
+
+  if (ec) {
+    CLOG(ERROR, "STRG") << "Failed to save ledger snapshot - " << ec.message();
+    return false;
+  }
+
+  boost::filesystem::remove_all(old_path, ec);
+
+  auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start_time);
+
+  CLOG(INFO, "STRG") << "Ledger snapshot saved (height=" << ledger_tip.height
+                     << ",#record=" << num_records
+                     << ",elapsed=" << elapsed_ms.count() << "ms)";
+
+  return true;
+}
+
+bool Storage::restoreLedgerSnapshot(ledger_tip_type &ledger_tip) {
+  std::lock_guard<std::mutex> guard(m_snapshot_mutex);
+
+  leveldb::DB *db_snapshot = openLedgerSnapshot();
+  if (db_snapshot == nullptr)
+    return false;
+
+  if (!readLedgerTip(db_snapshot, m_read_options, ledger_tip)) {
+    delete db_snapshot;
+    return false;
+  }
+
+  clearLedger();
+
+  std::string tip_key = getPrefix(DBType::LEDGER) + LEDGER_TIP_KEY;
+  std::string tip_value;
+  db_snapshot->Get(m_read_options, tip_key, &tip_value);
+
+  // the tip goes first and comes back last, so an interrupted restore is
+  // simply done again on the next start
+  leveldb::WriteBatch batch;
+  leveldb::WriteOptions write_options; // synced once by the last write
+  batch.Delete(tip_key);
+  bool is_ok = errorOn(m_db_ledger->Write(m_write_options, &batch));
+  batch.Clear();
+
+  size_t num_records = 0;
+  std::unique_ptr<leveldb::Iterator> it(
+      m_db_ledger->NewIterator(m_read_options));
+  for (it->SeekToFirst(); it->Valid() && is_ok; it->Next()) {
+    batch.Delete(it->key());
+    if (++num_records % 4096 == 0) {
+      is_ok = errorOn(m_db_ledger->Write(write_options, &batch));
+      batch.Clear();
+    }
+  }
+
+  num_records = 0;
+  it.reset(db_snapshot->NewIterator(m_read_options));
+  for (it->SeekToFirst(); it->Valid() && is_ok; it->Next()) {
+    if (it->key() == tip_key)
+      continue;
+    batch.Put(it->key(), it->value());
+    if (++num_records % 4096 == 0) {
+      is_ok = errorOn(m_db_ledger->Write(write_options, &batch));
+      batch.Clear();
+    }
+  }
+
+  batch.Put(tip_key, tip_value);
+  is_ok = is_ok && errorOn(it->status()) &&
+          errorOn(m_db_ledger->Write(m_write_options, &batch));
+
+  it.reset();
+  delete db_snapshot;
+
+  if (is_ok) {
+    CLOG(INFO, "STRG") << "Ledger snapshot restored (height="
+                       << ledger_tip.height << ",#record=" << num_records
+                       << ")";
+  }
+
+  return is_ok;
+}
+
+bool Storage::readLedgerTip(leveldb::DB *db,
+                            const leveldb::ReadOptions &options,
+                            ledger_tip_type &ledger_tip) {
+  std::string tip_value;
+  if (!db->Get(options, getPrefix(DBType::LEDGER) + LEDGER_TIP_KEY, &tip_value)
+           .ok())
+    return false;
+
+  json tip_json = Safe::parseJson(tip_value);
+  if (tip_json.empty())
+    return false;
+
+  ledger_tip.height = Safe::getSize(tip_json, "hgt");
+  ledger_tip.block_id_b64 = Safe::getString(tip_json, "bID");
+
+  return true;
+}
+
+leveldb::DB *Storage::openLedgerSnapshot() {
+  std::string snapshot_path =
+      m_db_path + "/" + config::DB_SUB_DIR_LEDGER_SNAPSHOT;
+
+  leveldb::Options options = m_options;
+  options.create_if_missing = false;
+
+  leveldb::DB *db_snapshot = nullptr;
+  for (auto &each_path : {snapshot_path, snapshot_path + ".old"}) {
+    if (!boost::filesystem::exists(each_path))
+      continue;
+    if (leveldb::DB::Open(options, each_path, &db_snapshot).ok())
+      return db_snapshot;
+  }
+
+  return nullptr;
+}
+
+// blocks up to this one have passed BlockHealthChecker
+void Storage::saveHealthCheckpoint(block_height_type height,
+                                   const std::string &block_id_b64) {
+  json checkpoint_json = {{"hgt", to_string(height)}, {"bID", block_id_b64}};
+  errorOn(m_db_latest_block_header->Put(
+      m_write_options, getPrefix(DBType::BLOCK_LATEST) + HEALTH_CHECKPOINT_KEY,
+      checkpoint_json.dump()));
+}
+
+bool Storage::getHealthCheckpoint(ledger_tip_type &checkpoint) {
+  json checkpoint_json = Safe::parseJson(
+      getValueByKey(DBType::BLOCK_LATEST, HEALTH_CHECKPOINT_KEY));
+  if (checkpoint_json.empty())
+    return false;
+
+  checkpoint.height = Safe::getSize(checkpoint_json, "hgt");
+  checkpoint.block_id_b64 = Safe::getString(checkpoint_json, "bID");
+
+  return true;
+}
+
 void Storage::saveBackup(const std::string &key, const std::string &value) {
   addBatch(DBType::BLOCK_BACKUP, key, value);
 }
@@ -569,7 +896,7 @@ void Storage::clearBackup() { m_batch_backup.Clear(); }
 
 void Storage::delBackup(const std::string &block_id_b64) {
   if (!block_id_b64.empty())
-    m_batch_backup.Delete(block_id_b64);
+    m_batch_backup.Delete(getPrefix(DBType::BLOCK_BACKUP) + block_id_b64);
 }
 
 } // namespace gruut
@@ -27,11 +27,16 @@
 #include <botan-2/botan/rsa.h>
 #include <botan-2/botan/x509cert.h>
 
+#include <atomic>
 #include <boost/filesystem/operations.hpp>
+#include <chrono>
 #include <cmath>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 namespace gruut {
 using namespace std;
@@ -48,12 +53,19 @@ const std::vector<std::pair<std::string, std::string>> DB_BLOCK_HEADER_SUFFIX =
      {"mID", "_mID"},   {"prevbID", "_prevbID"}, {"prevH", "_prevH"},
      {"txrt", "_txrt"}, {"txids", "_txids"}};
 
+// ledger prefixes are single letters, so this never collides with a record
+const std::string LEDGER_TIP_KEY = "_tip";
+const std::string HEALTH_CHECKPOINT_KEY = "_chk";
+
 class Storage : public TemplateSingleton<Storage> {
 public:
   Storage();
+  // a store of its own under db_path, apart from the node's DB
+  explicit Storage(const std::string &db_path);
   ~Storage();
 
-  bool saveBlock(bytes &block_raw, json &block_header, json &block_transaction);
+  bool saveBlock(const bytes &block_raw, json &block_header,
+                 json &block_transaction);
   bool saveBlock(const std::string &block_raw_b64, json &block_header,
                  json &block_transaction);
   nth_link_type getLatestHashAndHeight();
@@ -61,6 +73,10 @@ public:
   std::vector<std::string> getNthTxIdList(block_height_type t_height = 0);
   void destroyDB();
   storage_block_type readBlock(block_height_type height);
+  std::vector<storage_block_type> readBlockRange(block_height_type from_height,
+                                                 block_height_type to_height,
+                                                 size_t max_bytes,
+                                                 bool with_txs = true);
   proof_type getProof(const std::string &txid_b64);
   bool isDuplicatedTx(const std::string &txid_b64);
 
@@ -68,8 +84,19 @@ public:
   std::string readLedgerByKey(const std::string &key);
   void clearLedger();
   void flushLedger();
+  void saveLedgerTip(block_height_type height, const std::string &block_id_b64);
+  bool getLedgerTip(ledger_tip_type &ledger_tip);
+  bool eraseLedger();
+  bool isLedgerEmpty();
+  void saveLedgerSnapshotAsync();
+  bool saveLedgerSnapshot();
+  bool restoreLedgerSnapshot(ledger_tip_type &ledger_tip);
   bool empty();
 
+  void saveHealthCheckpoint(block_height_type height,
+                            const std::string &block_id_b64);
+  bool getHealthCheckpoint(ledger_tip_type &checkpoint);
+
   void saveBackup(const std::string &key, const std::string &value);
   std::string readBackup(const std::string &key);
   void flushBackup();
@@ -78,12 +105,13 @@ public:
 
 private:
   std::string getNthBlockIdB64(block_height_type height = 0);
+  json readBlockTxs(const std::string &block_id_b64, size_t &num_bytes);
   bool errorOnCritical(const leveldb::Status &status);
   bool errorOn(const leveldb::Status &status);
   bool addBatch(DBType what, const std::string &key, const std::string &value);
   bool putBlockHeader(json &block_header_json, const std::string &block_id_b64);
   bool putBlockHeight(json &block_header_json, const std::string &block_id_b64);
-  bool putBlockRaw(bytes &block_raw, const std::string &block_id_b64);
+  bool putBlockRaw(const bytes &block_raw, const std::string &block_id_b64);
   bool putLatestBlockHeader(json &block_header_json);
   bool putTransaction(json &block_body_json, const std::string &block_id_b64);
   std::string getValueByKey(DBType what,
@@ -92,6 +120,9 @@ private:
   void rollbackBatchAll();
   void commitBatchAll();
   void clearBatchAll();
+  bool readLedgerTip(leveldb::DB *db, const leveldb::ReadOptions &options,
+                     ledger_tip_type &ledger_tip);
+  leveldb::DB *openLedgerSnapshot();
 
 private:
   string m_db_path;
@@ -115,6 +146,10 @@ private:
   leveldb::WriteBatch m_batch_blockid_height;
   leveldb::WriteBatch m_batch_ledger;
   leveldb::WriteBatch m_batch_backup;
+
+  std::thread m_snapshot_thread;
+  std::atomic<bool> m_snapshot_running{false};
+  std::mutex m_snapshot_mutex;
 };
 } // namespace gruut
 #endif
@@ -0,0 +1,83 @@
+#ifndef GRUUT_ENTERPRISE_MERGER_BOUNDED_QUEUE_HPP
+#define GRUUT_ENTERPRISE_MERGER_BOUNDED_QUEUE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Blocking FIFO with a fixed capacity. A full queue blocks (or refuses) the
+// producer, so a slow consumer pushes back on its upstream instead of letting
+// work pile up without limit.
+template <typename T> class BoundedQueue {
+private:
+  std::deque<T> m_items;
+  size_t m_capacity;
+  std::mutex m_queue_mutex;
+  std::condition_variable m_not_empty_cv;
+  std::condition_variable m_not_full_cv;
+  bool m_closed{false};
+
+public:
+  explicit BoundedQueue(size_t capacity)
+      : m_capacity(capacity == 0 ? 1 : capacity) {}
+
+  BoundedQueue(const BoundedQueue &) = delete;
+  BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+  // blocks while full; false if the queue has been closed
+  bool push(T item) {
+    std::unique_lock<std::mutex> lock(m_queue_mutex);
+    m_not_full_cv.wait(lock, [this]() {
+      return m_closed || m_items.size() < m_capacity;
+    });
+    if (m_closed)
+      return false;
+
+    m_items.emplace_back(std::move(item));
+    m_not_empty_cv.notify_one();
+    return true;
+  }
+
+  // never blocks; false if full or closed
+  bool tryPush(T item) {
+    std::lock_guard<std::mutex> lock(m_queue_mutex);
+    if (m_closed || m_items.size() >= m_capacity)
+      return false;
+
+    m_items.emplace_back(std::move(item));
+    m_not_empty_cv.notify_one();
+    return true;
+  }
+
+  // blocks while empty; false once the queue is closed and drained
+  bool pop(T &ret_item) {
+    std::unique_lock<std::mutex> lock(m_queue_mutex);
+    m_not_empty_cv.wait(lock,
+                        [this]() { return m_closed || !m_items.empty(); });
+    if (m_items.empty())
+      return false;
+
+    ret_item = std::move(m_items.front());
+    m_items.pop_front();
+    m_not_full_cv.notify_one();
+    return true;
+  }
+
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(m_queue_mutex);
+      m_closed = true;
+    }
+    m_not_empty_cv.notify_all();
+    m_not_full_cv.notify_all();
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> lock(m_queue_mutex);
+    return m_items.size();
+  }
+
+  size_t capacity() const { return m_capacity; }
+};
+
+#endif // GRUUT_ENTERPRISE_MERGER_BOUNDED_QUEUE_HPP
@@ -28,7 +28,7 @@ public:
 
   ~BytesBuilder() {}
 
-  void append(std::vector<uint8_t> &bytes_val, int len = -1) {
+  void append(const std::vector<uint8_t> &bytes_val, int len = -1) {
 
     if (len < 0 || len > bytes_val.size())
       len = (int)bytes_val.size();
@@ -54,7 +54,7 @@ public:
   }
 
   template <size_t S>
-  void append(std::array<uint8_t, S> &bytes_val, int len = -1) {
+  void append(const std::array<uint8_t, S> &bytes_val, int len = -1) {
     auto vec = TypeConverter::arrayToVector<S>(bytes_val);
     append(vec, len);
   }
@@ -9,14 +9,20 @@ using namespace std;
 class Compressor {
 public:
   static string compressData(const string &src) {
+    string dest;
+    appendCompressed(src, dest);
+    return dest;
+  }
+
+  // compresses src straight onto the end of dest
+  static void appendCompressed(const string &src, string &dest) {
     int src_size = static_cast<int>(src.size());
     int dst_size = LZ4_compressBound(src_size);
-    string dest;
-    dest.resize(dst_size);
-    int dest_length = LZ4_compress_default(src.data(), (char *)dest.data(),
-                                           src_size, dst_size);
-    string dest2(dest.begin(), dest.begin() + dest_length);
-    return dest2;
+    size_t offset = dest.size();
+    dest.resize(offset + dst_size);
+    int dest_length =
+        LZ4_compress_default(src.data(), &dest[offset], src_size, dst_size);
+    dest.resize(offset + dest_length);
   }
 
   static vector<uint8_t> compressData(const vector<uint8_t> &src) {
@@ -30,14 +36,18 @@ public:
   }
 
   static string decompressData(string &src) {
-    int compressed_size = static_cast<int>(src.size());
+    return decompressData(src.data(), src.size());
+  }
+
+  static string decompressData(const char *src, size_t src_size) {
+    int compressed_size = static_cast<int>(src_size);
     int dest_capacity = compressed_size * 3;
     string dest;
     dest.resize(dest_capacity);
-    int dest_length = LZ4_decompress_safe(src.data(), (char *)dest.data(),
+    int dest_length = LZ4_decompress_safe(src, (char *)dest.data(),
                                           compressed_size, dest_capacity);
-    string dest2 = dest.substr(0, dest_length);
-    return dest2;
+    dest.resize(dest_length < 0 ? 0 : dest_length);
+    return dest;
   }
 
   static vector<uint8_t> decompressData(vector<uint8_t> &src) {
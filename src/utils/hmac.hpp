@@ -2,7 +2,10 @@
 #define GRUUT_ENTERPRISE_MERGER_HMAC_HPP
 
 #include "sha256.hpp"
+#include <botan-2/botan/hash.h>
 #include <botan-2/botan/mac.h>
+#include <botan-2/botan/mem_ops.h>
+#include <memory>
 #include <string>
 #include <vector>
 class Hmac {
@@ -24,14 +27,76 @@ public:
 
   static bool verifyHMAC(std::string &msg, std::vector<uint8_t> &hmac,
                          std::vector<uint8_t> &key) {
+    return verifyHMAC(reinterpret_cast<const uint8_t *>(msg.data()),
+                      msg.size(), hmac, key);
+  }
+
+  static bool verifyHMAC(const uint8_t *msg, size_t msg_size,
+                         std::vector<uint8_t> &hmac,
+                         std::vector<uint8_t> &key) {
     std::unique_ptr<Botan::MessageAuthenticationCode> mac =
         Botan::MessageAuthenticationCode::create_or_throw("HMAC(SHA-256)");
     std::vector<uint8_t> sha256_key = Sha256::hash(key);
 
     mac->set_key(sha256_key);
-    mac->update(msg);
+    mac->update(msg, msg_size);
     return mac->verify_mac(hmac);
   }
 };
 
+// HMAC(SHA-256) for one key with the key derivation and both pads done up
+// front: the inner and outer hash states after absorbing key^ipad and
+// key^opad are kept, and every MAC starts from copies of them. The stored
+// states are never changed, so one context serves concurrent callers.
+// Gives the same MAC as Hmac::generateHMAC with the same key.
+class HmacContext {
+private:
+  static constexpr size_t BLOCK_SIZE = 64; // of SHA-256
+
+  std::unique_ptr<Botan::HashFunction> m_inner;
+  std::unique_ptr<Botan::HashFunction> m_outer;
+
+public:
+  explicit HmacContext(const std::vector<uint8_t> &key) {
+    // derived as in Hmac (see the TODO there)
+    std::vector<uint8_t> sha256_key = Sha256::hash(key);
+
+    Botan::secure_vector<uint8_t> inner_pad(BLOCK_SIZE, 0x36);
+    Botan::secure_vector<uint8_t> outer_pad(BLOCK_SIZE, 0x5c);
+    for (size_t i = 0; i < sha256_key.size(); ++i) {
+      inner_pad[i] ^= sha256_key[i];
+      outer_pad[i] ^= sha256_key[i];
+    }
+
+    m_inner = Botan::HashFunction::create_or_throw("SHA-256");
+    m_inner->update(inner_pad);
+    m_outer = Botan::HashFunction::create_or_throw("SHA-256");
+    m_outer->update(outer_pad);
+  }
+
+  std::vector<uint8_t> generate(const uint8_t *msg, size_t msg_size) const {
+    std::unique_ptr<Botan::HashFunction> inner = m_inner->copy_state();
+    inner->update(msg, msg_size);
+    Botan::secure_vector<uint8_t> inner_hash = inner->final();
+
+    std::unique_ptr<Botan::HashFunction> outer = m_outer->copy_state();
+    outer->update(inner_hash);
+    return outer->final_stdvec();
+  }
+
+  std::vector<uint8_t> generate(const std::string &msg) const {
+    return generate(reinterpret_cast<const uint8_t *>(msg.data()),
+                    msg.size());
+  }
+
+  // compares in constant time
+  bool verify(const uint8_t *msg, size_t msg_size,
+              const std::vector<uint8_t> &hmac) const {
+    std::vector<uint8_t> expected = generate(msg, msg_size);
+    return hmac.size() == expected.size() &&
+           Botan::constant_time_compare(hmac.data(), expected.data(),
+                                        expected.size());
+  }
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,104 @@
+#ifndef GRUUT_ENTERPRISE_MERGER_REORDER_BUFFER_HPP
+#define GRUUT_ENTERPRISE_MERGER_REORDER_BUFFER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+// Puts items finished out of order back in the order they were started.
+// A producer takes a seq with acquire() before the work starts, and the
+// consumer gets the items back by popNext() in seq order. At most `window`
+// seqs are in flight (acquired and not yet released), so a slow early item
+// holds back new work instead of letting later items pile up without limit.
+// put() never blocks, so the workers holding the seq the consumer waits for
+// can always hand it over.
+template <typename T> class ReorderBuffer {
+private:
+  std::map<uint64_t, T> m_items;
+  size_t m_window;
+  size_t m_num_in_flight{0};
+  uint64_t m_next_acquire_seq{0};
+  uint64_t m_next_pop_seq{0};
+  std::mutex m_buffer_mutex;
+  std::condition_variable m_slot_cv;
+  std::condition_variable m_next_cv;
+  bool m_closed{false};
+
+public:
+  explicit ReorderBuffer(size_t window) : m_window(window == 0 ? 1 : window) {}
+
+  ReorderBuffer(const ReorderBuffer &) = delete;
+  ReorderBuffer &operator=(const ReorderBuffer &) = delete;
+
+  // blocks while the window is full; false if the buffer has been closed
+  bool acquire(uint64_t &ret_seq) {
+    std::unique_lock<std::mutex> lock(m_buffer_mutex);
+    m_slot_cv.wait(lock, [this]() {
+      return m_closed || m_num_in_flight < m_window;
+    });
+    if (m_closed)
+      return false;
+
+    ++m_num_in_flight;
+    ret_seq = m_next_acquire_seq++;
+    return true;
+  }
+
+  void put(uint64_t seq, T item) {
+    std::lock_guard<std::mutex> lock(m_buffer_mutex);
+    m_items.emplace(seq, std::move(item));
+    if (seq == m_next_pop_seq)
+      m_next_cv.notify_one();
+  }
+
+  // blocks until the next item in seq order is there; false once closed
+  bool popNext(T &ret_item) {
+    std::unique_lock<std::mutex> lock(m_buffer_mutex);
+    m_next_cv.wait(lock, [this]() {
+      return m_closed ||
+             (!m_items.empty() && m_items.begin()->first == m_next_pop_seq);
+    });
+    if (m_closed)
+      return false;
+
+    ret_item = std::move(m_items.begin()->second);
+    m_items.erase(m_items.begin());
+    ++m_next_pop_seq;
+    return true;
+  }
+
+  // frees the slot of an item taken by popNext(), once it is fully handled
+  void release() {
+    {
+      std::lock_guard<std::mutex> lock(m_buffer_mutex);
+      if (m_num_in_flight > 0)
+        --m_num_in_flight;
+    }
+    m_slot_cv.notify_one();
+  }
+
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(m_buffer_mutex);
+      m_closed = true;
+    }
+    m_slot_cv.notify_all();
+    m_next_cv.notify_all();
+  }
+
+  // items finished and waiting for an earlier one
+  size_t size() {
+    std::lock_guard<std::mutex> lock(m_buffer_mutex);
+    return m_items.size();
+  }
+
+  size_t inFlight() {
+    std::lock_guard<std::mutex> lock(m_buffer_mutex);
+    return m_num_in_flight;
+  }
+
+  size_t window() const { return m_window; }
+};
+
+#endif // GRUUT_ENTERPRISE_MERGER_REORDER_BUFFER_HPP
@@ -22,6 +22,20 @@ public:
     return ret_json;
   }
 
+  static nlohmann::json parseJson(const char *json_str, size_t json_size) {
+    nlohmann::json ret_json;
+
+    if (json_size > 0) {
+      try {
+        ret_json = nlohmann::json::parse(json_str, json_str + json_size);
+      } catch (...) {
+        /* do nothing */
+      }
+    }
+
+    return ret_json;
+  }
+
   static nlohmann::json parseJsonAsArray(const std::string &json_str) {
     nlohmann::json ret_json = parseJson(json_str);
 
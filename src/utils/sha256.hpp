@@ -32,7 +32,7 @@ public:
 
   static hash_t hash(std::vector<uint8_t> &&data) { return hash(data); }
 
-  static hash_t hash(std::vector<uint8_t> &data) {
+  static hash_t hash(const std::vector<uint8_t> &data) {
     std::unique_ptr<Botan::HashFunction> hash_function(
         Botan::HashFunction::create("SHA-256"));
     hash_function->update(data);
@@ -0,0 +1,125 @@
+#ifndef GRUUT_ENTERPRISE_MERGER_WORKER_POOL_HPP
+#define GRUUT_ENTERPRISE_MERGER_WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads consuming a FIFO of tasks. A task
+// posted with post() must catch its own exceptions; one that escapes ends
+// the process, as it would on any other thread.
+class WorkerPool {
+private:
+  std::vector<std::thread> m_workers;
+  std::deque<std::function<void()>> m_tasks;
+  std::mutex m_task_mutex;
+  std::condition_variable m_task_cv;
+  bool m_stop{false};
+
+public:
+  explicit WorkerPool(size_t num_workers) {
+    if (num_workers == 0)
+      num_workers = 1;
+
+    m_workers.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+      m_workers.emplace_back([this]() { workerLoop(); });
+    }
+  }
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_task_mutex);
+      m_stop = true;
+    }
+    m_task_cv.notify_all();
+
+    for (auto &each_worker : m_workers) {
+      if (each_worker.joinable())
+        each_worker.join();
+    }
+  }
+
+  size_t size() const { return m_workers.size(); }
+
+  void post(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(m_task_mutex);
+      m_tasks.emplace_back(std::move(task));
+    }
+    m_task_cv.notify_one();
+  }
+
+  // runs the tasks concurrently and returns when all of them are done.
+  // The calling thread takes the first task itself, so this must not be
+  // called from a worker of the same pool. The first exception thrown by a
+  // task is rethrown here.
+  void runAll(std::vector<std::function<void()>> &tasks) {
+    if (tasks.empty())
+      return;
+
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    size_t num_remain = tasks.size() - 1;
+    std::exception_ptr first_error;
+
+    for (size_t i = 1; i < tasks.size(); ++i) {
+      auto &task = tasks[i];
+      post([&task, &done_mutex, &done_cv, &num_remain, &first_error]() {
+        std::exception_ptr error;
+        try {
+          task();
+        } catch (...) {
+          error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(done_mutex);
+        if (error && !first_error)
+          first_error = error;
+        if (--num_remain == 0)
+          done_cv.notify_one();
+      });
+    }
+
+    try {
+      tasks[0]();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(done_mutex);
+      if (!first_error)
+        first_error = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait(lock, [&num_remain]() { return num_remain == 0; });
+
+    if (first_error)
+      std::rethrow_exception(first_error);
+  }
+
+private:
+  void workerLoop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(m_task_mutex);
+        m_task_cv.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+        if (m_stop && m_tasks.empty())
+          return;
+
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+      }
+
+      task();
+    }
+  }
+};
+
+#endif // GRUUT_ENTERPRISE_MERGER_WORKER_POOL_HPP
@@ -0,0 +1,140 @@
+#ifndef GRUUT_ENTERPRISE_MERGER_MODULES_FIXTURE_HPP
+#define GRUUT_ENTERPRISE_MERGER_MODULES_FIXTURE_HPP
+
+#include "../../src/chain/block.hpp"
+#include "../../src/chain/merkle_tree.hpp"
+#include "../../src/chain/transaction.hpp"
+#include "../../src/chain/types.hpp"
+#include "../../src/services/storage.hpp"
+#include "../../src/utils/type_converter.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace gruut;
+
+// A block built straight from its header fields. Neither the merger's
+// signature nor the support signatures are real, which the unresolved pool
+// and the storage never look at.
+struct TestBlock {
+  bytes block_raw;
+  json header; // as Storage::saveBlock() takes them
+  json body;
+  std::shared_ptr<Block> block;
+};
+
+// branch names the chain the block is on, so blocks of competing branches
+// at the same height get different ids
+inline TestBlock makeTestBlock(block_height_type height,
+                               const block_id_type &prev_block_id,
+                               const hash_t &prev_hash,
+                               const std::string &branch,
+                               size_t num_ssigs = 1, size_t num_txs = 1) {
+  std::vector<Transaction> txs(num_txs);
+  json txs_json = json::array();
+  for (size_t i = 0; i < num_txs; ++i) {
+    txs[i].setTime(static_cast<timestamp_t>(height));
+    txs[i].setRequestorId(TypeConverter::integerToBytes(i + 1));
+    txs[i].setTransactionType(TransactionType::DIGESTS);
+    txs[i].setContents(std::vector<content_type>(
+        {branch, std::to_string(height), std::to_string(i)}));
+    txs[i].setSignature(TypeConverter::integerToBytes(i + 1));
+    txs[i].genNewTxId();
+    txs_json.push_back(txs[i].getJson());
+  }
+
+  MerkleTree merkle_tree;
+  merkle_tree.generate(txs);
+
+  json header;
+  header["ver"] = std::to_string(config::DEFAULT_VERSION);
+  header["cID"] = TypeConverter::encodeBase64(bytes(CHAIN_ID_TYPE_SIZE, 1));
+  header["prevH"] = TypeConverter::encodeBase64(prev_hash);
+  header["prevbID"] = TypeConverter::encodeBase64(prev_block_id);
+  header["bID"] = TypeConverter::encodeBase64(
+      TypeConverter::stringToBytes(branch + "_" + std::to_string(height)));
+  header["time"] = std::to_string(height);
+  header["hgt"] = std::to_string(height);
+  header["txrt"] = TypeConverter::encodeBase64(merkle_tree.getMerkleTree().back());
+  header["mID"] = TypeConverter::encodeBase64(bytes(8, 1));
+  header["txids"] = json::array();
+  for (auto &each_tx : txs)
+    header["txids"].push_back(each_tx.getIdB64());
+  header["SSig"] = json::array();
+  for (size_t i = 0; i < num_ssigs; ++i)
+    header["SSig"].push_back(
+        {{"sID", TypeConverter::encodeBase64(TypeConverter::integerToBytes(i + 1))},
+         {"sig", TypeConverter::encodeBase64(bytes(4, 1))}});
+
+  // compression type, header end and the uncompressed header, then a
+  // placeholder for the merger's signature
+  std::string header_str = header.dump();
+  auto header_end = static_cast<uint32_t>(header_str.size() + 5);
+
+  TestBlock test_block;
+  test_block.block_raw.push_back(
+      static_cast<uint8_t>(CompressionAlgorithmType::NONE));
+  for (int shift = 24; shift >= 0; shift -= 8)
+    test_block.block_raw.push_back(static_cast<uint8_t>(header_end >> shift));
+  test_block.block_raw.insert(test_block.block_raw.end(), header_str.begin(),
+                              header_str.end());
+  test_block.block_raw.insert(test_block.block_raw.end(), 4, 0x01);
+
+  test_block.block = std::make_shared<Block>();
+  test_block.block->initialize(test_block.block_raw, txs_json);
+  test_block.header = test_block.block->getBlockHeaderJson();
+  test_block.body = test_block.block->getBlockBodyJson();
+  return test_block;
+}
+
+inline TestBlock makeTestBlock(block_height_type height, const Block &prev_block,
+                               const std::string &branch, size_t num_ssigs = 1,
+                               size_t num_txs = 1) {
+  return makeTestBlock(height, prev_block.getBlockId(), prev_block.getHash(),
+                       branch, num_ssigs, num_txs);
+}
+
+// the first block, on top of the genesis link
+inline TestBlock makeFirstTestBlock(const std::string &branch,
+                                    size_t num_ssigs = 1, size_t num_txs = 1) {
+  return makeTestBlock(
+      1, TypeConverter::decodeBase64(config::GENESIS_BLOCK_PREV_ID_B64),
+      TypeConverter::decodeBase64(config::GENESIS_BLOCK_PREV_HASH_B64), branch,
+      num_ssigs, num_txs);
+}
+
+// a throwaway DB, so the node's blocks and backups never see these
+struct TempStorageFixture {
+  boost::filesystem::path db_path;
+  std::unique_ptr<Storage> storage;
+
+  TempStorageFixture() {
+    db_path = boost::filesystem::temp_directory_path() /
+              boost::filesystem::unique_path("modules_test_%%%%%%%%");
+    storage.reset(new Storage(db_path.string()));
+  }
+
+  ~TempStorageFixture() {
+    storage.reset();
+    boost::filesystem::remove_all(db_path);
+  }
+
+  // writes one record of a sub DB behind the storage's back, as a damaged
+  // disk would; storage is reopened, so pointers to the old one are stale
+  void overwriteRecord(const std::string &sub_dir, const std::string &key,
+                       const std::string &value) {
+    storage.reset();
+
+    leveldb::DB *db = nullptr;
+    leveldb::DB::Open(leveldb::Options(), (db_path / sub_dir).string(), &db);
+    db->Put(leveldb::WriteOptions(), key, value);
+    delete db;
+
+    storage.reset(new Storage(db_path.string()));
+  }
+};
+
+#endif // GRUUT_ENTERPRISE_MERGER_MODULES_FIXTURE_HPP
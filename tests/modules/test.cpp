@@ -1,17 +1,26 @@
 #define BOOST_TEST_MODULE
 
 #include <boost/test/unit_test.hpp>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <thread>
 #include <typeinfo>
 
 #include "../../src/modules/module.hpp"
 #include "../../src/application.hpp"
 #include "../../src/modules/communication/grpc_util.hpp"
 #include "../../src/modules/communication/http_client.hpp"
+#include "../../src/modules/communication/message_handler.hpp"
+#include "../../src/modules/communication/protos/protobuf_merger.pb.h"
 #include "../../src/chain/transaction.hpp"
 #include "../../src/modules/message_fetcher/message_fetcher.hpp"
 #include "../../src/config/config.hpp"
 
 #include "../../src/modules/block_processor/unresolved_block_pool.hpp"
+#include "../../src/modules/bootstraper/block_range_scheduler.hpp"
+#include "../../src/modules/health_checker/block_scrubber.hpp"
+
+#include "fixture.hpp"
 
 using namespace std;
 using namespace gruut;
@@ -66,6 +75,134 @@ BOOST_AUTO_TEST_CASE(parseHeader) {
 //        BOOST_TEST(is_equal_sender_id);
 //        BOOST_TEST(memcmp(origin_hdr.reserved_space, compare_hdr.reserved_space, 6) == 0);
 }
+
+BOOST_AUTO_TEST_CASE(writeHeader) {
+        string packed_msg(HEADER_LENGTH, '\0');
+        packed_msg += R"({"sender":"gruut"})";
+
+        HeaderController::writeHeader(packed_msg, MessageType::MSG_PING, CompressionAlgorithmType::NONE);
+        MessageHeader hdr = HeaderController::parseHeader(packed_msg);
+
+        BOOST_TEST(hdr.identifier == G);
+        BOOST_TEST(hdr.version == VERSION);
+        BOOST_TEST(static_cast<uint8_t>(hdr.message_type) == static_cast<uint8_t>(MessageType::MSG_PING));
+        BOOST_TEST(static_cast<uint8_t>(hdr.compression_algo_type) ==
+            static_cast<uint8_t>(CompressionAlgorithmType::NONE));
+        BOOST_TEST(HeaderController::convertU8ToU32BE(hdr.total_length) == static_cast<int>(packed_msg.size()));
+}
+
+BOOST_AUTO_TEST_CASE(setIdField) {
+        localchain_id_type chain_id;
+        chain_id.fill(0x11);
+        id_type sender_id(SENDER_ID_LENGTH, 0x22);
+        HeaderController::setIdField(chain_id, sender_id);
+
+        string packed_msg(HEADER_LENGTH, '\0');
+        HeaderController::writeHeader(packed_msg, MessageType::MSG_PING, CompressionAlgorithmType::NONE);
+        MessageHeader hdr = HeaderController::parseHeader(packed_msg);
+
+        BOOST_TEST((hdr.local_chain_id == chain_id));
+        BOOST_TEST((hdr.sender_id == sender_id));
+}
+
+// a frame built in place by writeHeader is what unpackMsg reads, and a frame
+// whose total_length does not match the bytes received is turned away
+BOOST_AUTO_TEST_CASE(framingRoundTrip) {
+        json body;
+        body["sender"] = "gruut";
+        body["time"] = "2018-11-16";
+        body["type"] = "0";
+        body["info"] = string(256, 'a');
+
+        string packed_msg(HEADER_LENGTH, '\0');
+        packed_msg.append(body.dump());
+        HeaderController::writeHeader(packed_msg, MessageType::MSG_ERROR, CompressionAlgorithmType::NONE);
+
+        auto input_queue = InputQueueAlt::getInstance();
+        input_queue->fetchBulk(input_queue->size());
+        MessageHandler message_handler;
+        grpc::Status rpc_status;
+        id_type recv_id;
+
+        message_handler.unpackMsg(packed_msg.data(), packed_msg.size(), rpc_status, recv_id);
+        BOOST_REQUIRE(rpc_status.ok());
+        InputMsgEntry input_msg = input_queue->fetch();
+        BOOST_TEST(static_cast<uint8_t>(input_msg.type) == static_cast<uint8_t>(MessageType::MSG_ERROR));
+        BOOST_TEST(input_msg.body == body);
+
+        auto isRejected = [&message_handler](const string &msg, size_t msg_size) {
+          grpc::Status rpc_status;
+          id_type recv_id;
+          message_handler.unpackMsg(msg.data(), msg_size, rpc_status, recv_id);
+          return rpc_status.error_code() == grpc::StatusCode::INVALID_ARGUMENT;
+        };
+        // total_length sits behind the identifier, version and 4 type bytes
+        auto withTotalLength = [&packed_msg](uint32_t total_length) {
+          string msg = packed_msg;
+          for (int i = 0; i < MSG_LENGTH_SIZE; ++i)
+            msg[6 + i] = static_cast<char>(total_length >> (8 * (MSG_LENGTH_SIZE - 1 - i)));
+          return msg;
+        };
+
+        // truncated: part of the body, or not even the header
+        BOOST_TEST(isRejected(packed_msg, packed_msg.size() - 1));
+        BOOST_TEST(isRejected(packed_msg, HEADER_LENGTH - 1));
+        // total_length past the bytes received, or short of the header
+        BOOST_TEST(isRejected(withTotalLength(packed_msg.size() + 1), packed_msg.size()));
+        BOOST_TEST(isRejected(withTotalLength(0xFFFFFFFF), packed_msg.size()));
+        BOOST_TEST(isRejected(withTotalLength(HEADER_LENGTH - 1), packed_msg.size()));
+        BOOST_TEST(input_queue->size() == 0);
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(Test_MergerFrame)
+
+// the prefix is the tag and length protobuf writes for MergerDataRequest.data
+// (which leaves out empty data altogether)
+BOOST_AUTO_TEST_CASE(makePrefix) {
+        for (size_t data_size : {1, 127, 128, 300, 16384, 70000}) {
+          string data(data_size, 'm');
+          grpc_merger::MergerDataRequest request;
+          request.set_data(data);
+
+          string prefix = MergerFrame::makePrefix(data_size);
+          BOOST_TEST(prefix + data == request.SerializeAsString());
+        }
+
+        // a length of 128 and up takes more than one varint byte
+        BOOST_TEST(MergerFrame::makePrefix(127) == string("\x0A\x7F"));
+        BOOST_TEST(MergerFrame::makePrefix(300) == string("\x0A\xAC\x02"));
+        BOOST_TEST(MergerFrame::makePrefix(70000) == string("\x0A\xF0\xA2\x04"));
+}
+
+BOOST_AUTO_TEST_CASE(readPrefix) {
+        for (size_t data_size : {0, 1, 300, 70000}) {
+          string frame = MergerFrame::makePrefix(data_size) + string(data_size, 'm');
+          BOOST_TEST(MergerFrame::readPrefix(frame.data(), frame.size()) ==
+                     MergerFrame::makePrefix(data_size).size());
+        }
+}
+
+BOOST_AUTO_TEST_CASE(readMalformedPrefix) {
+        string frame = MergerFrame::makePrefix(300) + string(300, 'm');
+
+        // a field other than data
+        string bad_tag = frame;
+        bad_tag[0] = '\x12';
+        BOOST_TEST(MergerFrame::readPrefix(bad_tag.data(), bad_tag.size()) == 0);
+
+        // a length that is not the size of the data behind it
+        BOOST_TEST(MergerFrame::readPrefix(frame.data(), frame.size() - 1) == 0);
+        string longer = frame + "m";
+        BOOST_TEST(MergerFrame::readPrefix(longer.data(), longer.size()) == 0);
+
+        // the varint ends with the frame, or never ends
+        BOOST_TEST(MergerFrame::readPrefix(frame.data(), 2) == 0);
+        string endless("\x0A");
+        endless.append(11, '\xFF');
+        BOOST_TEST(MergerFrame::readPrefix(endless.data(), endless.size()) == 0);
+        BOOST_TEST(MergerFrame::readPrefix(frame.data(), 0) == 0);
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(Test_JsonValidator)
@@ -94,9 +231,690 @@ BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(Test_HttpClient)
   BOOST_AUTO_TEST_CASE(post) {
-    HttpClient client("10.10.10.108:3000/api/blocks");
+    // a local endpoint that is only read from, never answers
+    boost::asio::io_service io_service;
+    boost::asio::ip::tcp::acceptor acceptor(
+        io_service, boost::asio::ip::tcp::endpoint(
+                        boost::asio::ip::address_v4::loopback(), 0));
+    acceptor.non_blocking(true);
+    HttpClient client("127.0.0.1:" + to_string(acceptor.local_endpoint().port()) +
+                      "/api/blocks");
+
+    // post() only queues the request, which goes out within HTTP_POST_TIMEOUT
+    BOOST_REQUIRE(client.post("Hello world"));
+
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::seconds(config::HTTP_POST_TIMEOUT);
+    boost::asio::ip::tcp::socket socket(io_service);
+    boost::system::error_code error;
+    string request;
+    while (request.find("message=Hello%20world") == string::npos &&
+           std::chrono::steady_clock::now() < deadline) {
+      char buf[1024];
+      size_t num_read = 0;
+      if (!socket.is_open()) {
+        if (!acceptor.accept(socket, error))
+          socket.non_blocking(true);
+      } else {
+        num_read = socket.read_some(boost::asio::buffer(buf), error);
+      }
+
+      if (error) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        continue;
+      }
+      request.append(buf, num_read);
+    }
+
+    BOOST_TEST(request.find("POST /api/blocks ") == 0);
+    BOOST_TEST(request.find("message=Hello%20world") != string::npos);
+  }
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE(Test_BlockRangeScheduler)
+  string peerId(uint8_t n) {
+    return TypeConverter::encodeBase64(merger_id_type(8, n));
+  }
+
+  // a MSG_BLOCK_RANGE reply with one placeholder per block
+  InputMsgEntry makeReply(block_height_type from_height, block_height_type to_height,
+                          const string &peer_id_b64, size_t num_blocks) {
+    InputMsgEntry entry;
+    entry.type = MessageType::MSG_BLOCK_RANGE;
+    entry.body["from"] = to_string(from_height);
+    entry.body["to"] = to_string(to_height);
+    entry.body["mID"] = peer_id_b64;
+    entry.body["hdr"] = "0";
+    entry.body["blocks"] = json::array();
+    for (size_t i = 0; i < num_blocks; ++i)
+      entry.body["blocks"].push_back({{"hgt", to_string(from_height + i)}});
+    return entry;
+  }
+
+  BOOST_AUTO_TEST_CASE(planRanges) {
+    BlockRangeScheduler scheduler;
+    scheduler.planRanges(1, 600, 256);
+    auto pending_ranges = scheduler.getPendingRanges();
+
+    BOOST_REQUIRE(pending_ranges.size() == 3);
+    BOOST_TEST(pending_ranges[0].first == 1);
+    BOOST_TEST(pending_ranges[0].second == 256);
+    BOOST_TEST(pending_ranges[1].first == 257);
+    BOOST_TEST(pending_ranges[1].second == 512);
+    BOOST_TEST(pending_ranges[2].first == 513);
+    BOOST_TEST(pending_ranges[2].second == 600);
+  }
+
+  BOOST_AUTO_TEST_CASE(pickPeer) {
+    BlockRangeScheduler scheduler;
+    BOOST_TEST((scheduler.pickPeer() == nullptr));
+
+    scheduler.addPeer(peerId(1));
+    scheduler.addPeer(peerId(2));
+    scheduler.addPeer(peerId(3));
+
+    // unhealthy, slower, faster
+    scheduler.getPeer(peerId(1))->num_fail = config::MAX_SYNC_PEER_FAIL;
+    scheduler.getPeer(peerId(2))->num_blocks = 100;
+    scheduler.getPeer(peerId(2))->total_response_us = 1000000;
+    scheduler.getPeer(peerId(3))->num_blocks = 1000;
+    scheduler.getPeer(peerId(3))->total_response_us = 1000000;
+    BOOST_TEST((scheduler.pickPeer() == scheduler.getPeer(peerId(3))));
+
+    // a full peer is passed over
+    scheduler.getPeer(peerId(3))->num_outstanding = config::MAX_OUTSTANDING_BLOCK_RANGE;
+    BOOST_TEST((scheduler.pickPeer() == scheduler.getPeer(peerId(2))));
+
+    // of two unheard peers, the less busy one
+    scheduler.addPeer(peerId(4));
+    scheduler.addPeer(peerId(5));
+    scheduler.getPeer(peerId(4))->num_outstanding = 2;
+    scheduler.getPeer(peerId(5))->num_outstanding = 1;
+    BOOST_TEST((scheduler.pickPeer() == scheduler.getPeer(peerId(5))));
+  }
+
+  BOOST_AUTO_TEST_CASE(assignRanges) {
+    BlockRangeScheduler scheduler;
+    scheduler.addPeer(peerId(1));
+    scheduler.addPeer(peerId(2));
+    scheduler.planRanges(1, 100 * config::MAX_BLOCK_RANGE_SIZE, config::MAX_BLOCK_RANGE_SIZE);
+
+    auto requests = scheduler.assignRanges(false, 1000);
+    BOOST_TEST(requests.size() == 2 * config::MAX_OUTSTANDING_BLOCK_RANGE);
+    BOOST_TEST(requests[0].from_height == 1);
+    BOOST_TEST(scheduler.numOutstanding() == requests.size());
+    BOOST_TEST(scheduler.getPeer(peerId(1))->num_outstanding == config::MAX_OUTSTANDING_BLOCK_RANGE);
+    BOOST_TEST(scheduler.getPeer(peerId(2))->num_outstanding == config::MAX_OUTSTANDING_BLOCK_RANGE);
+    BOOST_TEST(scheduler.assignRanges(false, 1000).empty());
+  }
+
+  // a peer answering past the range it was asked for must not move the feed
+  // past the next range
+  BOOST_AUTO_TEST_CASE(receiveRangeClampsTo) {
+    BlockRangeScheduler scheduler;
+    scheduler.addPeer(peerId(1));
+    scheduler.setNextFeedHeight(1);
+    scheduler.planRanges(1, 20, 10);
+    auto requests = scheduler.assignRanges(false, 1000);
+    BOOST_REQUIRE(requests.size() == 2);
+
+    InputMsgEntry reply = makeReply(1, 15, requests[0].peer_id_b64, 15);
+    BOOST_TEST(scheduler.receiveRange(reply));
+
+    block_height_type from_height = 0;
+    InputMsgEntry range_entry;
+    BOOST_REQUIRE(scheduler.takeNextRange(from_height, range_entry));
+    BOOST_TEST(from_height == 1);
+    BOOST_TEST(Safe::getInt(range_entry.body, "to") == 10);
+    BOOST_TEST(range_entry.body["blocks"].size() == 10);
+    BOOST_TEST(scheduler.getPendingRanges().empty());
+
+    scheduler.setNextFeedHeight(11);
+    reply = makeReply(11, 20, requests[1].peer_id_b64, 10);
+    BOOST_TEST(scheduler.receiveRange(reply));
+    BOOST_TEST(scheduler.takeNextRange(from_height, range_entry));
+    BOOST_TEST(from_height == 11);
+    BOOST_TEST(scheduler.getPeer(peerId(1))->num_blocks == 20);
+  }
+
+  BOOST_AUTO_TEST_CASE(receiveRangeEarlyStop) {
+    BlockRangeScheduler scheduler;
+    scheduler.addPeer(peerId(1));
+    scheduler.planRanges(1, 10, 10);
+    auto requests = scheduler.assignRanges(false, 1000);
+
+    // stopped at its byte budget
+    InputMsgEntry reply = makeReply(1, 4, requests[0].peer_id_b64, 4);
+    BOOST_TEST(scheduler.receiveRange(reply));
+    auto pending_ranges = scheduler.getPendingRanges();
+    BOOST_REQUIRE(pending_ranges.size() == 1);
+    BOOST_TEST(pending_ranges[0].first == 5);
+    BOOST_TEST(pending_ranges[0].second == 10);
+
+    // a reply to nothing in flight
+    reply = makeReply(1, 4, requests[0].peer_id_b64, 4);
+    BOOST_TEST(!scheduler.receiveRange(reply));
+    BOOST_TEST(scheduler.numReceived() == 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(abandonFrom) {
+    BlockRangeScheduler scheduler;
+    scheduler.addPeer(peerId(1));
+    scheduler.addPeer(peerId(2));
+    scheduler.setNextFeedHeight(1);
+    scheduler.planRanges(1, 40, 10);
+    auto requests = scheduler.assignRanges(false, 1000);
+    BOOST_REQUIRE(requests.size() == 4);
+
+    // the bad peer serves 1-10 and 21-30: the first is being fed, the other
+    // waits for it
+    string bad_peer = requests[0].peer_id_b64;
+    BOOST_REQUIRE(requests[2].peer_id_b64 == bad_peer);
+    InputMsgEntry reply = makeReply(1, 10, bad_peer, 10);
+    BOOST_TEST(scheduler.receiveRange(reply));
+    reply = makeReply(21, 30, bad_peer, 10);
+    BOOST_TEST(scheduler.receiveRange(reply));
+
+    block_height_type from_height = 0;
+    InputMsgEntry range_entry;
+    BOOST_REQUIRE(scheduler.takeNextRange(from_height, range_entry));
+    BOOST_TEST(from_height == 1);
+
+    scheduler.abandonFrom(5, 10, bad_peer);
+
+    BOOST_TEST(!scheduler.getPeer(bad_peer)->isHealthy());
+    BOOST_TEST(scheduler.getPeer(bad_peer)->num_outstanding == 0);
+    BOOST_TEST(scheduler.numReceived() == 0);
+    BOOST_TEST(scheduler.numOutstanding() == 2); // the other peer's
+
+    auto pending_ranges = scheduler.getPendingRanges();
+    BOOST_REQUIRE(pending_ranges.size() == 2);
+    BOOST_TEST(pending_ranges[0].first == 5); // the bad block first
+    BOOST_TEST(pending_ranges[0].second == 10);
+    BOOST_TEST(pending_ranges[1].first == 21);
+
+    // a late reply from the bad peer is ignored, and nothing is fed until
+    // height 5 is fetched again
+    reply = makeReply(21, 30, bad_peer, 10);
+    BOOST_TEST(!scheduler.receiveRange(reply));
+    BOOST_TEST(!scheduler.takeNextRange(from_height, range_entry));
+
+    // given out again only to the healthy peer
+    for (auto &each_request : scheduler.assignRanges(false, 1000))
+      BOOST_TEST(each_request.peer_id_b64 != bad_peer);
+  }
+
+  BOOST_AUTO_TEST_CASE(retryTimedOut) {
+    BlockRangeScheduler scheduler;
+    scheduler.addPeer(peerId(1));
+    scheduler.planRanges(1, 10, 10);
+
+    timestamp_t current_time = 1000;
+    for (size_t i = 0; i < config::MAX_SYNC_PEER_FAIL; ++i) {
+      BOOST_REQUIRE(scheduler.assignRanges(false, current_time).size() == 1);
+
+      // not yet due
+      BOOST_TEST(scheduler.retryTimedOut(current_time + config::BLOCK_RANGE_REQ_TIMEOUT));
+      BOOST_TEST(scheduler.numOutstanding() == 1);
+
+      current_time += config::BLOCK_RANGE_REQ_TIMEOUT + 1;
+      bool has_healthy_peer = scheduler.retryTimedOut(current_time);
+      BOOST_TEST(scheduler.numOutstanding() == 0);
+      BOOST_TEST(scheduler.getPendingRanges().size() == 1);
+      BOOST_TEST(scheduler.getPeer(peerId(1))->num_fail == i + 1);
+      BOOST_TEST(has_healthy_peer == (i + 1 < config::MAX_SYNC_PEER_FAIL));
+    }
+
+    BOOST_TEST(scheduler.assignRanges(false, current_time).empty());
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+struct UnresolvedPoolFixture : TempStorageFixture {
+  std::vector<string> forwarded_ids;
+  UnresolvedBlockPool pool;
+
+  UnresolvedPoolFixture()
+      : pool(storage.get(), [this](const Block &block, const block_layer_t &) {
+          forwarded_ids.emplace_back(block.getBlockIdB64());
+        }) {
+    pool.setPool(TypeConverter::decodeBase64(config::GENESIS_BLOCK_PREV_ID_B64), {},
+                 TypeConverter::decodeBase64(config::GENESIS_BLOCK_PREV_HASH_B64), {},
+                 0, 0);
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE(Test_UnresolvedBlockPool, UnresolvedPoolFixture)
+  BOOST_AUTO_TEST_CASE(competingBranches) {
+    auto a1 = makeFirstTestBlock("a");
+    auto b1 = makeFirstTestBlock("b");
+    auto a2 = makeTestBlock(2, *a1.block, "a", 3);
+    auto b2 = makeTestBlock(2, *b1.block, "b", 1);
+    for (auto each_block : {a1, b1, a2, b2})
+      BOOST_TEST(pool.push(each_block.block).linked);
+
+    // both tips at height 2; a came first
+    BOOST_TEST(pool.getMostPossibleLink().id == a2.block->getBlockId());
+
+    std::vector<UnresolvedBlock> resolved_blocks;
+    std::vector<string> drop_blocks;
+    pool.getResolvedBlocks(resolved_blocks, drop_blocks);
+
+    BOOST_REQUIRE(resolved_blocks.size() == 1);
+    BOOST_TEST(resolved_blocks[0].block->getBlockId() == a1.block->getBlockId());
+    BOOST_TEST(resolved_blocks[0].confirm_level == 4);
+    BOOST_REQUIRE(drop_blocks.size() == 1);
+    BOOST_TEST(drop_blocks[0] == b1.block->getBlockIdB64());
+
+    auto tip = pool.getMostPossibleLink();
+    BOOST_TEST(tip.height == 2);
+    BOOST_TEST(tip.id == a2.block->getBlockId());
+  }
+
+  BOOST_AUTO_TEST_CASE(parentAfterChild) {
+    auto c1 = makeFirstTestBlock("c");
+    auto c2 = makeTestBlock(2, *c1.block, "c");
+    auto c3 = makeTestBlock(3, *c2.block, "c");
+
+    auto push_result = pool.push(c2.block);
+    BOOST_TEST(push_result.height == 2);
+    BOOST_TEST(!push_result.linked);
+    BOOST_TEST(forwarded_ids.empty());
+    BOOST_TEST(pool.getMostPossibleLink().height == 0);
+
+    // the parent links the waiting child, and both go to the ledgers
+    BOOST_TEST(pool.push(c1.block).linked);
+    BOOST_REQUIRE(forwarded_ids.size() == 2);
+    BOOST_TEST(forwarded_ids[0] == c1.block->getBlockIdB64());
+    BOOST_TEST(forwarded_ids[1] == c2.block->getBlockIdB64());
+    BOOST_TEST(pool.getMostPossibleLink().id == c2.block->getBlockId());
+
+    std::vector<UnresolvedBlock> resolved_blocks;
+    std::vector<string> drop_blocks;
+    pool.getResolvedBlocks(resolved_blocks, drop_blocks);
+    BOOST_TEST(resolved_blocks.empty()); // 2 < BLOCK_CONFIRM_LEVEL
 
-    CURLcode status = client.post("Hello world");
-    BOOST_TEST(true);
+    BOOST_TEST(pool.push(c3.block).linked);
+    pool.getResolvedBlocks(resolved_blocks, drop_blocks);
+    BOOST_REQUIRE(resolved_blocks.size() == 1);
+    BOOST_TEST(resolved_blocks[0].block->getBlockId() == c1.block->getBlockId());
+    BOOST_TEST(resolved_blocks[0].confirm_level == 3);
+    BOOST_TEST(drop_blocks.empty());
+    BOOST_TEST(pool.getMostPossibleLink().id == c3.block->getBlockId());
   }
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+
+  BOOST_AUTO_TEST_CASE(equalHeightTieBreak) {
+    auto a1 = makeFirstTestBlock("a");
+    auto b1 = makeFirstTestBlock("b");
+    auto a2 = makeTestBlock(2, *a1.block, "a");
+    auto b2 = makeTestBlock(2, *b1.block, "b");
+    for (auto each_block : {a1, b1, b2, a2})
+      pool.push(each_block.block);
+
+    // b2 came first, but a is met first walking the bins from the root
+    BOOST_TEST(pool.getMostPossibleLink().id == a2.block->getBlockId());
+    auto block_layer = pool.getMostPossibleBlockLayer();
+    BOOST_REQUIRE(block_layer.size() == 2);
+    BOOST_TEST(block_layer[0] == a2.block->getBlockIdB64());
+    BOOST_TEST(block_layer[1] == a1.block->getBlockIdB64());
+  }
+
+  BOOST_AUTO_TEST_CASE(tipCutOffByResolution) {
+    auto a1 = makeFirstTestBlock("a");
+    auto a2 = makeTestBlock(2, *a1.block, "a");
+    auto a3 = makeTestBlock(3, *a2.block, "a");
+    auto b1 = makeFirstTestBlock("b");
+    auto b2 = makeTestBlock(2, *b1.block, "b", 3);
+    for (auto each_block : {a1, b1, a2, a3, b2})
+      pool.push(each_block.block);
+
+    BOOST_TEST(pool.getMostPossibleLink().id == a3.block->getBlockId());
+
+    // the longer branch has fewer support signatures
+    std::vector<UnresolvedBlock> resolved_blocks;
+    std::vector<string> drop_blocks;
+    pool.getResolvedBlocks(resolved_blocks, drop_blocks);
+
+    BOOST_REQUIRE(resolved_blocks.size() == 1);
+    BOOST_TEST(resolved_blocks[0].block->getBlockId() == b1.block->getBlockId());
+    BOOST_TEST(resolved_blocks[0].confirm_level == 4);
+    BOOST_REQUIRE(drop_blocks.size() == 1);
+    BOOST_TEST(drop_blocks[0] == a1.block->getBlockIdB64());
+
+    auto tip = pool.getMostPossibleLink();
+    BOOST_TEST(tip.height == 2);
+    BOOST_TEST(tip.id == b2.block->getBlockId());
+    BOOST_TEST(pool.getBlockLayer(a3.block->getBlockIdB64()).empty());
+  }
+
+  BOOST_AUTO_TEST_CASE(restoreFromBackupLog) {
+    auto a1 = makeFirstTestBlock("a");
+    auto b1 = makeFirstTestBlock("b");
+    auto a2 = makeTestBlock(2, *a1.block, "a", 3);
+    auto a3 = makeTestBlock(3, *a2.block, "a");
+    auto a4 = makeTestBlock(4, *a3.block, "a");
+
+    // log: A a1, A b1, A a2, D a1 b1, A a3, A a4
+    for (auto each_block : {a1, b1, a2})
+      pool.push(each_block.block);
+    std::vector<UnresolvedBlock> resolved_blocks;
+    std::vector<string> drop_blocks;
+    pool.getResolvedBlocks(resolved_blocks, drop_blocks);
+    BOOST_REQUIRE(resolved_blocks.size() == 1);
+    pool.push(a3.block);
+    pool.push(a4.block);
+
+    // a torn write of the last entry
+    string tail_key = UNRESOLVED_LOG_ENTRY_KEY + to_string(5);
+    string tail_entry = storage->readBackup(tail_key);
+    BOOST_REQUIRE(!tail_entry.empty());
+    tail_entry.back() ^= 0x01;
+    storage->saveBackup(tail_key, tail_entry);
+    storage->flushBackup();
+
+    // a restart: a1 has gone to storage in the meantime
+    std::vector<string> restored_ids;
+    UnresolvedBlockPool restored_pool(
+        storage.get(), [&restored_ids](const Block &block, const block_layer_t &) {
+          restored_ids.emplace_back(block.getBlockIdB64());
+        });
+    restored_pool.setPool(a1.block->getBlockId(), {}, a1.block->getHash(), {}, 1, 0);
+    restored_pool.restorePool();
+
+    BOOST_REQUIRE(restored_ids.size() == 2);
+    BOOST_TEST(restored_ids[0] == a2.block->getBlockIdB64());
+    BOOST_TEST(restored_ids[1] == a3.block->getBlockIdB64());
+
+    std::shared_ptr<const Block> ret_block;
+    BOOST_TEST(!restored_pool.getBlock(4, ret_block));
+    BOOST_TEST(restored_pool.getMostPossibleLink().id == a3.block->getBlockId());
+    auto block_layer = restored_pool.getMostPossibleBlockLayer();
+    BOOST_REQUIRE(block_layer.size() == 2);
+    BOOST_TEST(block_layer[0] == a3.block->getBlockIdB64());
+    BOOST_TEST(block_layer[1] == a2.block->getBlockIdB64());
+
+    // restored into a fresh image, which a second restart reads back
+    std::vector<string> reread_ids;
+    UnresolvedBlockPool reread_pool(
+        storage.get(), [&reread_ids](const Block &block, const block_layer_t &) {
+          reread_ids.emplace_back(block.getBlockIdB64());
+        });
+    reread_pool.setPool(a1.block->getBlockId(), {}, a1.block->getHash(), {}, 1, 0);
+    reread_pool.restorePool();
+    BOOST_TEST(reread_ids == restored_ids);
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+// a stored chain a1 .. a4; the scrubber stops below the latest block, so a3
+// is the last block it checks
+struct ScrubberFixture : TempStorageFixture {
+  std::vector<TestBlock> chain;
+
+  ScrubberFixture() {
+    chain.emplace_back(makeFirstTestBlock("a"));
+    for (block_height_type height = 2; height <= 4; ++height)
+      chain.emplace_back(makeTestBlock(height, *chain.back().block, "a"));
+  }
+
+  void saveChain() {
+    for (auto &each_block : chain)
+      BOOST_REQUIRE(storage->saveBlock(each_block.block_raw, each_block.header,
+                                       each_block.body));
+  }
+
+  BlockScrubStat scrubOnePass() {
+    BlockScrubber scrubber(storage.get());
+    for (int i = 0; i < 100 && scrubber.getScrubStat().num_passes == 0; ++i)
+      scrubber.scrubNext();
+    return scrubber.getScrubStat();
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE(Test_BlockScrubber, ScrubberFixture)
+  BOOST_AUTO_TEST_CASE(cleanChain) {
+    saveChain();
+
+    auto stat = scrubOnePass();
+    BOOST_TEST(stat.num_passes == 1);
+    BOOST_TEST(stat.num_blocks == 3);
+    BOOST_TEST(stat.num_bad_blocks == 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(hashMismatch) {
+    saveChain();
+    overwriteRecord(config::DB_SUB_DIR_RAW,
+                    "R" + chain[2].block->getBlockIdB64() + "_hash",
+                    string(32, '\x01'));
+
+    auto stat = scrubOnePass();
+    BOOST_TEST(stat.num_blocks == 3);
+    BOOST_TEST(stat.num_bad_blocks == 1);
+    BOOST_TEST(stat.last_bad_height == 3);
+  }
+
+  BOOST_AUTO_TEST_CASE(wrongHeightIndex) {
+    saveChain();
+    overwriteRecord(config::DB_SUB_DIR_IDHEIGHT, "H3",
+                    chain[3].block->getBlockIdB64());
+
+    auto stat = scrubOnePass();
+    BOOST_TEST(stat.num_blocks == 3);
+    BOOST_TEST(stat.num_bad_blocks == 1);
+    BOOST_TEST(stat.last_bad_height == 3);
+  }
+
+  BOOST_AUTO_TEST_CASE(badTxRoot) {
+    chain[2].body["tx"][0]["content"][0] = "tampered";
+    saveChain();
+
+    auto stat = scrubOnePass();
+    BOOST_TEST(stat.num_blocks == 3);
+    BOOST_TEST(stat.num_bad_blocks == 1);
+    BOOST_TEST(stat.last_bad_height == 3);
+  }
+
+  BOOST_AUTO_TEST_CASE(brokenLink) {
+    auto b2 = makeTestBlock(2, *chain[0].block, "b");
+    chain[2] = makeTestBlock(3, *b2.block, "a");
+    chain[3] = makeTestBlock(4, *chain[2].block, "a");
+    saveChain();
+
+    auto stat = scrubOnePass();
+    BOOST_TEST(stat.num_blocks == 3);
+    BOOST_TEST(stat.num_bad_blocks == 1);
+    BOOST_TEST(stat.last_bad_height == 3);
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+// a stored chain a1 .. a5 of two transactions each
+struct BlockRangeFixture : TempStorageFixture {
+  std::vector<TestBlock> chain;
+
+  BlockRangeFixture() {
+    OutputQueueAlt::getInstance()->clearOutputQueue();
+    chain.emplace_back(makeFirstTestBlock("a", 1, 2));
+    for (block_height_type height = 2; height <= 5; ++height)
+      chain.emplace_back(makeTestBlock(height, *chain.back().block, "a", 1, 2));
+    for (auto &each_block : chain)
+      BOOST_REQUIRE(storage->saveBlock(each_block.block_raw, each_block.header,
+                                       each_block.body));
+  }
+
+  // what readBlockRange() counts for the block at height
+  size_t numBlockBytes(block_height_type height, bool with_txs = true) {
+    auto &test_block = chain[height - 1];
+    size_t num_bytes = test_block.block_raw.size();
+    if (with_txs) {
+      for (auto &tx_json : test_block.body["tx"])
+        num_bytes += json::to_cbor(tx_json).size();
+    }
+    return num_bytes;
+  }
+
+  InputMsgEntry makeRangeRequest(block_height_type from_height,
+                                 block_height_type to_height,
+                                 size_t max_bytes = 0,
+                                 bool header_only = false) {
+    InputMsgEntry msg_req_range;
+    msg_req_range.type = MessageType::MSG_REQ_BLOCK_RANGE;
+    msg_req_range.body["mID"] = TypeConverter::encodeBase64(bytes(8, 2));
+    msg_req_range.body["time"] = Time::now();
+    msg_req_range.body["from"] = to_string(from_height);
+    msg_req_range.body["to"] = to_string(to_height);
+    msg_req_range.body["hdr"] = header_only ? "1" : "0";
+    msg_req_range.body["maxBytes"] = to_string(max_bytes);
+    return msg_req_range;
+  }
+
+  // the one reply the request left in the output queue
+  OutputMsgEntry fetchReply() {
+    auto output_queue = OutputQueueAlt::getInstance();
+    BOOST_REQUIRE(output_queue->size() == 1);
+    return output_queue->fetch();
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE(Test_BlockRange, BlockRangeFixture)
+  BOOST_AUTO_TEST_CASE(readRange) {
+    auto blocks = storage->readBlockRange(2, 4, config::MAX_BLOCK_RANGE_BYTES);
+
+    BOOST_REQUIRE(blocks.size() == 3);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      auto &test_block = chain[i + 1];
+      BOOST_TEST(blocks[i].height == i + 2);
+      BOOST_TEST(blocks[i].id == test_block.block->getBlockId());
+      BOOST_TEST(blocks[i].block_raw == test_block.block_raw);
+      BOOST_TEST(blocks[i].txs == test_block.body["tx"]);
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(rangeClampedToStoredBlocks) {
+    auto blocks = storage->readBlockRange(4, 100, config::MAX_BLOCK_RANGE_BYTES);
+    BOOST_REQUIRE(blocks.size() == 2);
+    BOOST_TEST(blocks.back().height == 5);
+
+    BOOST_TEST(storage->readBlockRange(0, 3, config::MAX_BLOCK_RANGE_BYTES).empty());
+    BOOST_TEST(storage->readBlockRange(6, 8, config::MAX_BLOCK_RANGE_BYTES).empty());
+    BOOST_TEST(storage->readBlockRange(3, 2, config::MAX_BLOCK_RANGE_BYTES).empty());
+  }
+
+  BOOST_AUTO_TEST_CASE(maxBytesCutoff) {
+    size_t two_blocks_bytes = numBlockBytes(1) + numBlockBytes(2);
+
+    BOOST_TEST(storage->readBlockRange(1, 5, two_blocks_bytes).size() == 2);
+    BOOST_TEST(storage->readBlockRange(1, 5, two_blocks_bytes - 1).size() == 1);
+
+    // the first block even if it alone is over the limit
+    auto blocks = storage->readBlockRange(3, 5, 1);
+    BOOST_REQUIRE(blocks.size() == 1);
+    BOOST_TEST(blocks[0].height == 3);
+  }
+
+  BOOST_AUTO_TEST_CASE(headerOnly) {
+    size_t two_headers_bytes = numBlockBytes(1, false) + numBlockBytes(2, false);
+
+    auto headers = storage->readBlockRange(1, 5, two_headers_bytes, false);
+    BOOST_REQUIRE(headers.size() == 2);
+    for (size_t i = 0; i < headers.size(); ++i) {
+      BOOST_TEST(headers[i].block_raw == chain[i].block_raw);
+      BOOST_TEST(headers[i].txs.empty());
+    }
+
+    // the transactions count against the same limit
+    BOOST_TEST(storage->readBlockRange(1, 5, two_headers_bytes).size() == 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(replyToRangeRequest) {
+    BlockProcessor block_processor(storage.get());
+    auto msg_req_range = makeRangeRequest(2, 100);
+    block_processor.handleMessage(msg_req_range);
+
+    auto msg_block_range = fetchReply();
+    BOOST_REQUIRE(msg_block_range.type == MessageType::MSG_BLOCK_RANGE);
+    BOOST_TEST(msg_block_range.receivers[0] == bytes(8, 2));
+    BOOST_TEST(Safe::getString(msg_block_range.body, "from") == "2");
+    BOOST_TEST(Safe::getString(msg_block_range.body, "to") == "5");
+    BOOST_TEST(msg_block_range.body["blocks"].size() == 4);
+
+    // what the requester gets out of it is the blocks themselves
+    InputMsgEntry recv_block_range;
+    recv_block_range.type = MessageType::MSG_BLOCK_RANGE;
+    recv_block_range.body = msg_block_range.body;
+    auto block_entries = BlockProcessor::unpackBlockRange(recv_block_range);
+    BOOST_REQUIRE(block_entries.size() == 4);
+    for (size_t i = 0; i < block_entries.size(); ++i) {
+      BOOST_TEST((block_entries[i].type == MessageType::MSG_BLOCK));
+      BOOST_TEST(Safe::getString(block_entries[i].body, "mID") ==
+                 Safe::getString(msg_block_range.body, "mID"));
+
+      Block recv_block;
+      BOOST_REQUIRE(recv_block.initialize(block_entries[i].body));
+      BOOST_TEST(recv_block.getBlockId() == chain[i + 1].block->getBlockId());
+      BOOST_TEST(recv_block.getHash() == chain[i + 1].block->getHash());
+      BOOST_TEST(recv_block.hasValidTxRoot());
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(replyWithinMaxBytes) {
+    BlockProcessor block_processor(storage.get());
+    auto msg_req_range =
+        makeRangeRequest(1, 5, numBlockBytes(1) + numBlockBytes(2));
+    block_processor.handleMessage(msg_req_range);
+
+    auto msg_block_range = fetchReply();
+    BOOST_TEST(Safe::getString(msg_block_range.body, "to") == "2");
+    BOOST_TEST(msg_block_range.body["blocks"].size() == 2);
+
+    msg_req_range = makeRangeRequest(3, 5, 1);
+    block_processor.handleMessage(msg_req_range);
+
+    msg_block_range = fetchReply();
+    BOOST_TEST(Safe::getString(msg_block_range.body, "from") == "3");
+    BOOST_TEST(Safe::getString(msg_block_range.body, "to") == "3");
+  }
+
+  BOOST_AUTO_TEST_CASE(replyHeaderOnly) {
+    BlockProcessor block_processor(storage.get());
+    auto msg_req_range = makeRangeRequest(1, 5, 0, true);
+    block_processor.handleMessage(msg_req_range);
+
+    auto msg_block_range = fetchReply();
+    BOOST_TEST(Safe::getString(msg_block_range.body, "hdr") == "1");
+    BOOST_REQUIRE(msg_block_range.body["blocks"].size() == 5);
+    for (auto &each_block : msg_block_range.body["blocks"])
+      BOOST_TEST(each_block["tx"].empty());
+
+    // left to the block synchronizer
+    InputMsgEntry recv_block_range;
+    recv_block_range.type = MessageType::MSG_BLOCK_RANGE;
+    recv_block_range.body = msg_block_range.body;
+    BOOST_TEST(BlockProcessor::unpackBlockRange(recv_block_range).empty());
+  }
+
+  BOOST_AUTO_TEST_CASE(rejectBadRange) {
+    BlockProcessor block_processor(storage.get());
+    for (auto each_range : std::vector<std::pair<block_height_type, block_height_type>>{
+             {0, 3}, {4, 3}, {6, 8}}) {
+      auto msg_req_range = makeRangeRequest(each_range.first, each_range.second);
+      block_processor.handleMessage(msg_req_range);
+      BOOST_TEST((fetchReply().type == MessageType::MSG_ERROR));
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(replyClampedToMaxRangeSize) {
+    auto last_block = chain.back();
+    for (block_height_type height = 6; height <= config::MAX_BLOCK_RANGE_SIZE + 1;
+         ++height) {
+      last_block = makeTestBlock(height, *last_block.block, "a");
+      BOOST_REQUIRE(storage->saveBlock(last_block.block_raw, last_block.header,
+                                       last_block.body));
+    }
+
+    BlockProcessor block_processor(storage.get());
+    auto msg_req_range = makeRangeRequest(1, config::MAX_BLOCK_RANGE_SIZE + 1);
+    block_processor.handleMessage(msg_req_range);
+
+    auto msg_block_range = fetchReply();
+    BOOST_TEST(Safe::getString(msg_block_range.body, "to") ==
+               to_string(config::MAX_BLOCK_RANGE_SIZE));
+    BOOST_TEST(msg_block_range.body["blocks"].size() == config::MAX_BLOCK_RANGE_SIZE);
+  }
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,7 +2,7 @@
 #define GRUUT_ENTERPRISE_MERGER_FIXTURE_HPP
 
 #include "../../src/chain/types.hpp"
-//#include "../../src/services/signer_pool.hpp"
+#include "../../src/services/signer_pool.hpp"
 #include "block_json.hpp"
 using namespace gruut;
 
@@ -15,15 +15,15 @@ struct SignerPoolFixture {
     secret_key_vector = TypeConverter::toSecureVector(secret_key);
   }
 
-  void push() {
-    /*
-    signer_pool.pushSigner(id, test_cert, secret_key_vector, SignerStatus::GOOD);
+  signer_id_type push(SignerStatus status = SignerStatus::GOOD) {
+    signer_id_type pushed_id = id;
+    signer_pool.pushSigner(id, test_cert, secret_key_vector, status);
     ++id_int;
     id = TypeConverter::integerToBytes(id_int);
-    */
+    return pushed_id;
   }
 
-  //SignerPool signer_pool;
+  SignerPool signer_pool;
 
   signer_id_type id;
   uint64_t id_int;
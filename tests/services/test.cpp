@@ -1,6 +1,7 @@
 #define BOOST_TEST_MODULE
 
 #include <boost/test/unit_test.hpp>
+#include <set>
 #include <vector>
 
 #include "../../src/chain/transaction.hpp"
@@ -18,7 +19,9 @@
 #include "../../src/utils/compressor.hpp"
 #include "../../src/utils/type_converter.hpp"
 
+#include "../../src/services/join_table.hpp"
 #include "../../src/services/storage.hpp"
+#include "../../src/ledger/certificate_index.hpp"
 #include "block_json.hpp"
 
 #include "fixture.hpp"
@@ -70,31 +73,108 @@ BOOST_AUTO_TEST_SUITE_END()
 BOOST_FIXTURE_TEST_SUITE(Test_SignerPool, SignerPoolFixture)
 
     BOOST_AUTO_TEST_CASE(pushSigner) {
-//      SignerPoolFixture signer_pool_fixture;
-//      signer_pool_fixture.push();
-//      BOOST_CHECK_EQUAL(signer_pool_fixture.signer_pool.size(), 1);
+      push();
+      push(SignerStatus::TEMPORARY);
+      push();
+
+      BOOST_CHECK_EQUAL(signer_pool.size(), 3);
+      BOOST_CHECK_EQUAL(signer_pool.getNumSignerBy(SignerStatus::GOOD), 2);
+      BOOST_CHECK_EQUAL(signer_pool.getNumSignerBy(SignerStatus::TEMPORARY), 1);
     }
 
     BOOST_AUTO_TEST_CASE(updateStatus) {
-//      SignerPoolFixture signer_pool_fixture;
-//      signer_pool_fixture.push();
-//      signer_id_type prev_signer_id = TypeConverter::integerToBytes(signer_pool_fixture.id_int - 1);
-//      signer_pool_fixture.signer_pool.updateStatus(prev_signer_id, SignerStatus::TEMPORARY);
-//
-//      auto signer = signer_pool_fixture.signer_pool.getSigner(0);
-//      bool result = signer.status == SignerStatus::TEMPORARY;
-//      BOOST_TEST(result);
+      signer_id_type first_id = push();
+      signer_id_type second_id = push();
+
+      // a handle is a snapshot; the update swaps in a new copy
+      SignerHandle before = signer_pool.getSigner(first_id);
+      BOOST_TEST(signer_pool.updateStatus(first_id, SignerStatus::TEMPORARY));
+      BOOST_TEST((before->status == SignerStatus::GOOD));
+      BOOST_TEST((signer_pool.getSigner(first_id)->status == SignerStatus::TEMPORARY));
+
+      BOOST_CHECK_EQUAL(signer_pool.getNumSignerBy(SignerStatus::GOOD), 1);
+      BOOST_CHECK_EQUAL(signer_pool.getNumSignerBy(SignerStatus::TEMPORARY), 1);
+
+      BOOST_TEST(signer_pool.removeSigner(second_id));
+      BOOST_CHECK_EQUAL(signer_pool.getNumSignerBy(SignerStatus::GOOD), 0);
+      BOOST_CHECK_EQUAL(signer_pool.size(), 1);
+
+      BOOST_TEST(!signer_pool.updateStatus(second_id, SignerStatus::GOOD));
+      BOOST_TEST(!signer_pool.removeSigner(second_id));
+      BOOST_CHECK_EQUAL(signer_pool.getNumSignerBy(SignerStatus::GOOD), 0);
     }
 
-  BOOST_AUTO_TEST_CASE(getNumSignerBy) {
-//    SignerPoolFixture signer_pool_fixture;
-//    signer_pool_fixture.push();
-//    signer_pool_fixture.push();
-//    signer_pool_fixture.push();
-//    signer_pool_fixture.push();
-//
-//    auto signers = signer_pool_fixture.signer_pool.getRandomSigners(2);
-//    BOOST_CHECK_EQUAL(signers.size(), 2);
+  BOOST_AUTO_TEST_CASE(getRandomSigners) {
+    const size_t num_good = 6;
+    for (size_t i = 0; i < num_good; ++i) {
+      push();
+      push(SignerStatus::TEMPORARY);
+    }
+
+    for (size_t number : {0, 1, 3, 6, 10}) {
+      auto signers = signer_pool.getRandomSigners(number);
+      BOOST_CHECK_EQUAL(signers.size(), std::min(number, num_good));
+
+      std::set<signer_id_type> distinct_ids;
+      for (auto &signer : signers) {
+        BOOST_TEST((signer->status == SignerStatus::GOOD));
+        distinct_ids.insert(signer->user_id);
+      }
+      BOOST_CHECK_EQUAL(distinct_ids.size(), signers.size());
+    }
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE(Test_JoinTable, SignerPoolFixture)
+  // join_lock is set until the signer has been handed its key
+  std::shared_ptr<JoinTemporaryData> makeJoin(timestamp_t start_time, bool join_lock) {
+    auto join_data = std::make_shared<JoinTemporaryData>();
+    join_data->start_time = start_time;
+    join_data->join_lock = join_lock;
+    return join_data;
+  }
+
+  BOOST_AUTO_TEST_CASE(expire) {
+    const timestamp_t start_time = 1000;
+    JoinTable join_table(start_time);
+
+    // got its key but never sent MSG_SUCCESS
+    signer_id_type temporary_id = push(SignerStatus::TEMPORARY);
+    string temporary_b64 = TypeConverter::encodeBase64(temporary_id);
+    join_table.insert(temporary_b64, makeJoin(start_time, false));
+
+    // already GOOD, e.g. joined before and came back
+    signer_id_type good_id = push(SignerStatus::GOOD);
+    string good_b64 = TypeConverter::encodeBase64(good_id);
+    join_table.insert(good_b64, makeJoin(start_time, false));
+
+    // still in its key exchange
+    string locked_b64 = TypeConverter::encodeBase64(id);
+    join_table.insert(locked_b64, makeJoin(start_time, true));
+
+    // joined again later; only the old join is due
+    signer_id_type rejoin_id = push(SignerStatus::TEMPORARY);
+    string rejoin_b64 = TypeConverter::encodeBase64(rejoin_id);
+    join_table.insert(rejoin_b64, makeJoin(start_time, false));
+    join_table.insert(rejoin_b64, makeJoin(start_time + 3, false));
+
+    BOOST_CHECK_EQUAL(join_table.expire(start_time + config::JOIN_TIMEOUT_SEC, signer_pool), 0);
+    BOOST_TEST((join_table.find(temporary_b64) != nullptr));
+
+    BOOST_CHECK_EQUAL(join_table.expire(start_time + config::JOIN_TIMEOUT_SEC + 1, signer_pool), 1);
+    BOOST_TEST((join_table.find(temporary_b64) == nullptr));
+    BOOST_TEST((join_table.find(good_b64) == nullptr));
+    BOOST_TEST((join_table.find(locked_b64) == nullptr));
+    BOOST_TEST((join_table.find(rejoin_b64) != nullptr));
+    BOOST_TEST((signer_pool.getSigner(temporary_id) == nullptr));
+    BOOST_TEST((signer_pool.getSigner(good_id) != nullptr));
+    BOOST_TEST((signer_pool.getSigner(rejoin_id) != nullptr));
+
+    // a check that comes more than a turn of the wheel late sees every slot
+    BOOST_CHECK_EQUAL(join_table.expire(start_time + 100, signer_pool), 1);
+    BOOST_TEST((join_table.find(rejoin_b64) == nullptr));
+    BOOST_TEST((signer_pool.getSigner(rejoin_id) == nullptr));
+    BOOST_CHECK_EQUAL(signer_pool.size(), 1);
   }
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -239,6 +319,123 @@ BOOST_AUTO_TEST_SUITE(Test_Storage_Service)
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE(Test_CertificateIndex)
+  BOOST_AUTO_TEST_CASE(find_cert_at_time) {
+    std::vector<CertificateRecord> cert_records;
+    cert_records.emplace_back(100, 200, "a1_0");
+    cert_records.emplace_back(150, 300, "a1_1");
+    cert_records.emplace_back(150, 250, "a1_2");
+
+    CertificateHistory cert_history;
+    cert_history.build(std::move(cert_records), "a1_2");
+
+    BOOST_TEST(cert_history.find(0) == "a1_2");
+    BOOST_TEST(cert_history.find(100) == "");
+    BOOST_TEST(cert_history.find(150) == "a1_0");
+    BOOST_TEST(cert_history.find(151) == "a1_1");
+    BOOST_TEST(cert_history.find(299) == "a1_1");
+    BOOST_TEST(cert_history.find(300) == "");
+  }
+
+  BOOST_AUTO_TEST_CASE(discard_stale_history) {
+    auto cert_index = CertificateIndex::getInstance();
+    std::string cert;
+
+    uint64_t version = cert_index->getVersion();
+    cert_index->invalidate("a1");
+    cert_index->insert("a1", CertificateHistory(), version);
+    BOOST_TEST(!cert_index->find("a1", 0, cert));
+
+    version = cert_index->getVersion();
+    cert_index->insert("a1", CertificateHistory(), version);
+    BOOST_TEST(cert_index->find("a1", 0, cert));
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(Test_LedgerSnapshot)
+  BOOST_AUTO_TEST_CASE(restore_ledger) {
+    // a throwaway DB, so the node's ledger never sees these records
+    auto db_path = boost::filesystem::temp_directory_path() /
+                   boost::filesystem::unique_path("ledger_test_%%%%%%%%");
+    std::unique_ptr<Storage> storage(new Storage(db_path.string()));
+    const size_t num_records = 300;
+
+    for (size_t i = 0; i < num_records; ++i)
+      storage->saveLedger("Ctest_" + to_string(i), to_string(i));
+    storage->saveLedgerTip(7, "test_block_7");
+    storage->flushLedger();
+
+    BOOST_TEST(storage->saveLedgerSnapshot());
+
+    storage->saveLedger("Ctest_0", "changed");
+    storage->saveLedger("Ctest_new", "new");
+    storage->saveLedgerTip(8, "test_block_8");
+    storage->flushLedger();
+
+    ledger_tip_type ledger_tip;
+    BOOST_TEST(storage->restoreLedgerSnapshot(ledger_tip));
+
+    BOOST_TEST(ledger_tip.height == 7);
+    BOOST_TEST(ledger_tip.block_id_b64 == "test_block_7");
+    BOOST_TEST(storage->readLedgerByKey("Ctest_0") == "0");
+    BOOST_TEST(storage->readLedgerByKey("Ctest_" + to_string(num_records - 1)) ==
+               to_string(num_records - 1));
+    BOOST_TEST(storage->readLedgerByKey("Ctest_new").empty());
+
+    storage.reset();
+    boost::filesystem::remove_all(db_path);
+  }
+
+  BOOST_AUTO_TEST_CASE(erase_ledger) {
+    auto db_path = boost::filesystem::temp_directory_path() /
+                   boost::filesystem::unique_path("ledger_test_%%%%%%%%");
+    std::unique_ptr<Storage> storage(new Storage(db_path.string()));
+
+    for (size_t i = 0; i < 5000; ++i)
+      storage->saveLedger("Ctest_" + to_string(i), to_string(i));
+    storage->saveLedgerTip(7, "test_block_7");
+    storage->flushLedger();
+
+    BOOST_TEST(storage->eraseLedger());
+    ledger_tip_type ledger_tip;
+    BOOST_TEST(!storage->getLedgerTip(ledger_tip));
+    BOOST_TEST(storage->isLedgerEmpty());
+
+    storage.reset();
+    boost::filesystem::remove_all(db_path);
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(Test_CustomLedgerManager)
+  BOOST_AUTO_TEST_CASE(partition_4096_txs) {
+    const std::vector<TransactionType> tx_types = {
+        TransactionType::CERTIFICATES, TransactionType::DIGESTS,
+        TransactionType::IMMORTALSMS, TransactionType::UNKNOWN};
+
+    std::vector<Transaction> txs(config::MAX_COLLECT_TRANSACTION_SIZE);
+    for (size_t i = 0; i < txs.size(); ++i) {
+      txs[i].setTransactionType(tx_types[i % tx_types.size()]);
+      txs[i].setContents(std::vector<content_type>({"a1", "pem"}));
+      txs[i].genNewTxId();
+    }
+
+    json txs_json = json::array();
+    for (auto &each_tx : txs)
+      txs_json.push_back(each_tx.getJson());
+
+    std::vector<Transaction> parsed_txs =
+        CustomLedgerManager::parseTxs(txs_json);
+    tx_partition_t json_partition =
+        CustomLedgerManager::partitionTxs(parsed_txs);
+    tx_partition_t view_partition = CustomLedgerManager::partitionTxs(txs);
+
+    BOOST_TEST(view_partition.size() == 4);
+    BOOST_TEST(view_partition[TransactionType::CERTIFICATES].size() == 1024);
+    BOOST_TEST(view_partition[TransactionType::UNKNOWN].size() == 1024);
+    BOOST_TEST(json_partition[TransactionType::DIGESTS].size() == 1024);
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE(Test_BlockGenerator_for_storage)
   BOOST_AUTO_TEST_CASE(save_block_by_block_object) {
     BasicBlockInfo p_block;
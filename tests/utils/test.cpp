@@ -14,6 +14,15 @@
 #include "../../src/utils/type_converter.hpp"
 #include "../../src/utils/time.hpp"
 #include "../../src/utils/crypto.hpp"
+#include "../../src/utils/bounded_queue.hpp"
+#include "../../src/utils/reorder_buffer.hpp"
+#include "../../src/utils/worker_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
@@ -137,6 +146,22 @@ BOOST_AUTO_TEST_CASE(verifyHMAC) {
   BOOST_TEST(Hmac::verifyHMAC(msg, hmac, key));
 }
 
+BOOST_AUTO_TEST_CASE(precomputedHMAC) {
+  std::vector<uint8_t> key(32, 0xFF);
+  HmacContext hmac_context(key);
+
+  std::string msg = "gruut";
+  std::vector<uint8_t> hmac = hmac_context.generate(msg);
+
+  BOOST_TEST(hmac == Hmac::generateHMAC(msg, key));
+  BOOST_TEST(hmac_context.verify(
+      reinterpret_cast<const uint8_t *>(msg.data()), msg.size(), hmac));
+
+  hmac[0] ^= 0x01;
+  BOOST_TEST(!hmac_context.verify(
+      reinterpret_cast<const uint8_t *>(msg.data()), msg.size(), hmac));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(Test_ECDH)
@@ -262,4 +287,148 @@ v1cI3SKQHAm1uJ+42+1M/MSd7Qr1g8e2O8BWXWnhF61ZdkhfM+OyolTd
     BOOST_TEST(GemCrypto::isValidPass(raw_pem,"12345678"));
   }
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(Test_BoundedQueue)
+  BOOST_AUTO_TEST_CASE(pushPopAndClose) {
+    BoundedQueue<int> queue(2);
+
+    BOOST_TEST(queue.push(1));
+    BOOST_TEST(queue.tryPush(2));
+    BOOST_TEST(!queue.tryPush(3)); // full
+
+    int item = 0;
+    BOOST_TEST(queue.pop(item));
+    BOOST_TEST(item == 1);
+    BOOST_TEST(queue.size() == 1);
+
+    queue.close();
+    BOOST_TEST(!queue.push(4));
+    BOOST_TEST(queue.pop(item)); // drains what is left
+    BOOST_TEST(item == 2);
+    BOOST_TEST(!queue.pop(item));
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(Test_ReorderBuffer)
+  // the block pipeline's shape: seqs taken at ingestion, verifiers finishing
+  // out of order (every fifth block is slow), one linker taking them back
+  BOOST_AUTO_TEST_CASE(linkInArrivalOrder) {
+    const size_t num_blocks = 200;
+    const size_t num_verifiers = 3;
+    BoundedQueue<uint64_t> verify_queue(4);
+    ReorderBuffer<uint64_t> link_buffer(16);
+
+    std::vector<std::thread> verifiers;
+    for (size_t i = 0; i < num_verifiers; ++i) {
+      verifiers.emplace_back([&verify_queue, &link_buffer]() {
+        uint64_t seq;
+        while (verify_queue.pop(seq)) {
+          if (seq % 5 == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+          link_buffer.put(seq, seq);
+        }
+      });
+    }
+
+    std::vector<uint64_t> linked;
+    size_t max_in_flight = 0;
+    std::thread linker([&]() {
+      uint64_t seq;
+      while (linked.size() < num_blocks && link_buffer.popNext(seq)) {
+        linked.push_back(seq);
+        max_in_flight = std::max(max_in_flight, link_buffer.inFlight());
+        link_buffer.release();
+      }
+    });
+
+    for (size_t i = 0; i < num_blocks; ++i) {
+      uint64_t seq;
+      BOOST_REQUIRE(link_buffer.acquire(seq));
+      BOOST_REQUIRE(verify_queue.push(seq));
+    }
+
+    linker.join();
+    verify_queue.close();
+    for (auto &verifier : verifiers)
+      verifier.join();
+
+    BOOST_TEST(linked.size() == num_blocks);
+    for (size_t i = 0; i < linked.size(); ++i)
+      BOOST_TEST(linked[i] == i);
+    BOOST_TEST(max_in_flight <= link_buffer.window());
+  }
+
+  BOOST_AUTO_TEST_CASE(windowBlocksAcquire) {
+    ReorderBuffer<int> link_buffer(2);
+    uint64_t seq;
+    BOOST_TEST(link_buffer.acquire(seq));
+    BOOST_TEST(link_buffer.acquire(seq));
+
+    std::atomic<bool> is_acquired{false};
+    std::thread producer([&link_buffer, &is_acquired]() {
+      uint64_t third_seq;
+      if (link_buffer.acquire(third_seq) && third_seq == 2)
+        is_acquired = true;
+    });
+
+    // a later item finished first does not free a slot
+    link_buffer.put(1, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    BOOST_TEST(!is_acquired);
+    BOOST_TEST(link_buffer.size() == 1);
+
+    int item = 0;
+    link_buffer.put(0, 0);
+    BOOST_TEST(link_buffer.popNext(item));
+    BOOST_TEST(item == 0);
+    link_buffer.release();
+    producer.join();
+    BOOST_TEST(is_acquired);
+
+    BOOST_TEST(link_buffer.popNext(item));
+    BOOST_TEST(item == 1);
+
+    link_buffer.close();
+    BOOST_TEST(!link_buffer.popNext(item));
+    BOOST_TEST(!link_buffer.acquire(seq));
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(Test_WorkerPool)
+  // a fixed set of clients posting in a loop, as the RPC handlers get them:
+  // every request runs, and never more at once than the pool has workers.
+  // The load run against a live MergerServer is benchmarks/merger_server_load
+  BOOST_AUTO_TEST_CASE(postUnderLoad) {
+    const size_t num_clients = 8;
+    const size_t num_requests = 500; // per client
+    std::atomic<size_t> num_done{0};
+    std::atomic<size_t> num_running{0};
+    std::atomic<size_t> max_running{0};
+    auto request = [&]() {
+      size_t running = ++num_running;
+      size_t seen = max_running;
+      while (running > seen && !max_running.compare_exchange_weak(seen, running))
+        ;
+      Sha256::hash("request body");
+      --num_running;
+      ++num_done;
+    };
+
+    WorkerPool workers(4);
+    std::vector<std::thread> clients;
+    for (size_t i = 0; i < num_clients; ++i) {
+      clients.emplace_back([&workers, &request, num_requests]() {
+        for (size_t j = 0; j < num_requests; ++j)
+          workers.post(request);
+      });
+    }
+    for (auto &client : clients)
+      client.join();
+    while (num_done < num_clients * num_requests)
+      std::this_thread::yield();
+
+    BOOST_TEST(num_done == num_clients * num_requests);
+    BOOST_TEST(max_running <= workers.size());
+  }
+BOOST_AUTO_TEST_SUITE_END()